@@ -0,0 +1,223 @@
+// AdrixCH - Adaptive-contrast colors: background statistics behind the crosshair and a palette picker.
+
+#include "AdaptiveContrast.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ADRIXCH_HAS_SSE2 1
+#endif
+
+namespace {
+
+// Rec. 709 weights in 1/256 units; they add up to 256 so white stays 255
+constexpr uint32_t kLumaRed = 54, kLumaGreen = 183, kLumaBlue = 19;
+
+// Absolute score gain a challenger needs on top of the relative margin, so near-ties on flat backgrounds never switch
+constexpr float kMinScoreGain = 4.0f;
+
+inline uint32_t Luma(uint32_t red, uint32_t green, uint32_t blue) {
+    return (kLumaRed * red + kLumaGreen * green + kLumaBlue * blue + 128) >> 8;
+}
+
+void SumRow(const uint32_t* row, int begin, int end, BackgroundSums& sums) {
+    for (int x = begin; x < end; x++) {
+        const uint32_t pixel = row[x];
+        const uint32_t blue = pixel & 0xFF, green = (pixel >> 8) & 0xFF, red = (pixel >> 16) & 0xFF;
+        const uint32_t luma = Luma(red, green, blue);
+        sums.red += red;
+        sums.green += green;
+        sums.blue += blue;
+        sums.luma += luma;
+        sums.lumaSquared += luma * luma;
+    }
+}
+
+#ifdef ADRIXCH_HAS_SSE2
+inline uint64_t HorizontalSum(__m128i v) {
+    alignas(16) uint32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+    return (uint64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+#endif
+
+// Opponent color axes of a COLORREF-style or BGRA color: red-green and yellow-blue
+struct Opponent {
+    float luma, redGreen, yellowBlue;
+};
+
+Opponent ToOpponent(float red, float green, float blue) {
+    return { ((float)kLumaRed * red + (float)kLumaGreen * green + (float)kLumaBlue * blue) / 256.0f,
+        red - green, (red + green) * 0.5f - blue };
+}
+
+Opponent ColorRefToOpponent(uint32_t color) {
+    return ToOpponent((float)(color & 0xFF), (float)((color >> 8) & 0xFF), (float)((color >> 16) & 0xFF));
+}
+
+// Distance of a color from the background: luma difference (minus what the texture eats up) and, weighted
+// lower because it reads less well at small sizes, chroma difference
+float ColorDistance(const Opponent& color, const Opponent& background, float lumaDeviation) {
+    const float luma = std::max(std::fabs(color.luma - background.luma) - 0.5f * lumaDeviation, 0.0f);
+    const float redGreen = color.redGreen - background.redGreen, yellowBlue = color.yellowBlue - background.yellowBlue;
+    return std::sqrt(luma * luma + 0.1f * (redGreen * redGreen + yellowBlue * yellowBlue));
+}
+
+} // namespace
+
+void SumBackgroundReference(const uint32_t* pixels, int width, int height, size_t stride, BackgroundSums& sums) {
+    sums = {};
+    if (!pixels || width <= 0 || height <= 0) return;
+    for (int y = 0; y < height; y++) SumRow(pixels + (size_t)y * stride, 0, width, sums);
+    sums.pixels = (uint64_t)width * (uint64_t)height;
+}
+
+void SumBackground(const uint32_t* pixels, int width, int height, size_t stride, BackgroundSums& sums) {
+#ifdef ADRIXCH_HAS_SSE2
+    sums = {};
+    if (!pixels || width <= 0 || height <= 0) return;
+    width = std::min(width, kMaxBackgroundSampleSize);
+
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+    const __m128i redMask = _mm_set1_epi32(0x00FF0000);
+    const __m128i redGreenWeights = _mm_set1_epi32((int)((kLumaRed << 16) | kLumaGreen)); // Pairs with (green, red)
+    const __m128i blueWeight = _mm_set1_epi32((int)kLumaBlue);
+    const __m128i rounding = _mm_set1_epi32(128);
+
+    // Sums stay in 32-bit lanes for up to 64 rows (at most 4096 pixels per lane), then widen
+    __m128i red = _mm_setzero_si128(), green = red, blue = red, luma = red, lumaSquared = red;
+    auto flush = [&] {
+        sums.red += HorizontalSum(red);
+        sums.green += HorizontalSum(green);
+        sums.blue += HorizontalSum(blue);
+        sums.luma += HorizontalSum(luma);
+        sums.lumaSquared += HorizontalSum(lumaSquared);
+        red = green = blue = luma = lumaSquared = _mm_setzero_si128();
+    };
+    for (int y = 0; y < height; y++) {
+        const uint32_t* row = pixels + (size_t)y * stride;
+        int x = 0;
+        for (; x + 4 <= width; x += 4) {
+            const __m128i pixel = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+            const __m128i b = _mm_and_si128(pixel, byteMask);
+            const __m128i g = _mm_and_si128(_mm_srli_epi32(pixel, 8), byteMask);
+            const __m128i redHigh = _mm_and_si128(pixel, redMask);
+            const __m128i greenRed = _mm_or_si128(g, redHigh); // Low half green, high half red
+            const __m128i r = _mm_srli_epi32(redHigh, 16);
+            const __m128i weighted = _mm_add_epi32(_mm_madd_epi16(greenRed, redGreenWeights), _mm_madd_epi16(b, blueWeight));
+            const __m128i l = _mm_srli_epi32(_mm_add_epi32(weighted, rounding), 8);
+            red = _mm_add_epi32(red, r);
+            green = _mm_add_epi32(green, g);
+            blue = _mm_add_epi32(blue, b);
+            luma = _mm_add_epi32(luma, l);
+            lumaSquared = _mm_add_epi32(lumaSquared, _mm_madd_epi16(l, l));
+        }
+        SumRow(row, x, width, sums);
+        if ((y & 63) == 63) flush();
+    }
+    flush();
+    sums.pixels = (uint64_t)width * (uint64_t)height;
+#else
+    SumBackgroundReference(pixels, std::min(width, kMaxBackgroundSampleSize), height, stride, sums);
+#endif
+}
+
+BackgroundStats ComputeBackgroundStats(const BackgroundSums& sums) {
+    BackgroundStats stats;
+    stats.pixels = sums.pixels;
+    if (sums.pixels == 0) return stats;
+
+    const double count = (double)sums.pixels;
+    const double meanLuma = (double)sums.luma / count;
+    stats.meanLuma = (float)meanLuma;
+    stats.lumaDeviation = (float)std::sqrt(std::max((double)sums.lumaSquared / count - meanLuma * meanLuma, 0.0));
+    stats.meanRed = (float)((double)sums.red / count);
+    stats.meanGreen = (float)((double)sums.green / count);
+    stats.meanBlue = (float)((double)sums.blue / count);
+
+    // Hexagonal hue of the mean color
+    const float r = stats.meanRed, g = stats.meanGreen, b = stats.meanBlue;
+    const float high = std::max({ r, g, b }), low = std::min({ r, g, b });
+    stats.chroma = high - low;
+    if (stats.chroma > 0) {
+        float hue;
+        if (high == r) hue = (g - b) / stats.chroma;
+        else if (high == g) hue = (b - r) / stats.chroma + 2.0f;
+        else hue = (r - g) / stats.chroma + 4.0f;
+        hue *= 60.0f;
+        stats.hue = hue < 0 ? hue + 360.0f : hue;
+    }
+    return stats;
+}
+
+const std::vector<ContrastPair>& DefaultContrastPalette() {
+    static const std::vector<ContrastPair> palette = {
+        { 0x00FFFF, 0x010000 }, // Yellow
+        { 0xFFFF00, 0x010000 }, // Cyan
+        { 0xFF00FF, 0x010000 }, // Magenta
+        { 0x00FF00, 0x010000 }, // Green
+        { 0xFFFFFF, 0x010000 }, // White
+        { 0x0000FF, 0xFFFFFF }, // Red
+        { 0x010000, 0xFFFFFF }, // Near-black
+    };
+    return palette;
+}
+
+float ScoreContrastPair(const ContrastPair& pair, const BackgroundStats& background) {
+    const Opponent bg = ToOpponent(background.meanRed, background.meanGreen, background.meanBlue);
+    const Opponent fill = ColorRefToOpponent(pair.fill), outline = ColorRefToOpponent(pair.outline);
+
+    // The fill carries the shape; the outline helps, and on textured backgrounds a fill/outline luma
+    // step keeps the edges readable wherever the background happens to match one of them
+    const float texture = std::min(background.lumaDeviation, 64.0f) / 64.0f;
+    return ColorDistance(fill, bg, background.lumaDeviation) + 0.25f * ColorDistance(outline, bg, background.lumaDeviation) +
+        0.25f * texture * std::fabs(fill.luma - outline.luma);
+}
+
+AdaptiveContrast::AdaptiveContrast(std::vector<ContrastPair> palette, float margin, int holdSamples)
+    : palette_(std::move(palette)), margin_(margin), holdSamples_(std::max(holdSamples, 1)) {
+    if (palette_.empty()) palette_ = DefaultContrastPalette();
+}
+
+void AdaptiveContrast::Reset() {
+    current_ = 0;
+    challengerSamples_ = 0;
+    started_ = false;
+}
+
+bool AdaptiveContrast::Update(const BackgroundStats& background) {
+    if (background.pixels == 0) return false;
+
+    size_t best = current_;
+    float bestScore = ScoreContrastPair(palette_[current_], background);
+    const float currentScore = bestScore;
+    for (size_t i = 0; i < palette_.size(); i++) {
+        const float score = ScoreContrastPair(palette_[i], background);
+        if (score > bestScore) { best = i; bestScore = score; }
+    }
+
+    // The first sample picks straight away; after that only a clear, lasting winner takes over
+    if (!started_) {
+        started_ = true;
+        current_ = best;
+        challengerSamples_ = 0;
+        return true;
+    }
+    if (best == current_ || bestScore < currentScore * (1.0f + margin_) + kMinScoreGain) {
+        challengerSamples_ = 0;
+        return false;
+    }
+    if (best != challenger_ || challengerSamples_ == 0) {
+        challenger_ = best;
+        challengerSamples_ = 0;
+    }
+    if (++challengerSamples_ < holdSamples_) return false;
+
+    current_ = best;
+    challengerSamples_ = 0;
+    switches_++;
+    return true;
+}
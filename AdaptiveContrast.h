@@ -0,0 +1,89 @@
+// AdrixCH - Adaptive-contrast colors: background statistics behind the crosshair and a palette picker.
+//
+// A small square of the screen behind the crosshair is sampled a few times per second. One pass over
+// its pixels (SSE2 where available) sums the channels, the luma and the squared luma; from those come
+// the background's mean luma, its spread and the hue and chroma of its mean color. Each fill/outline
+// pair of a palette is scored against that, and the crosshair switches pairs only when another one has
+// been clearly better for several samples in a row, so a busy background does not make it flicker.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Raw sums over the sampled pixels; the kernels produce exactly the same sums
+struct BackgroundSums {
+    uint64_t red = 0, green = 0, blue = 0;
+    uint64_t luma = 0, lumaSquared = 0;
+    uint64_t pixels = 0;
+};
+
+struct BackgroundStats {
+    uint64_t pixels = 0;
+    float meanLuma = 0;      // 0-255, Rec. 709 weights on the stored (gamma-encoded) values
+    float lumaDeviation = 0; // Standard deviation of the luma; high for textured backgrounds
+    float meanRed = 0, meanGreen = 0, meanBlue = 0;
+    float hue = 0;    // Degrees (0 = red, 120 = green, 240 = blue) of the mean color
+    float chroma = 0; // 0-255; how far the mean color is from grey, 0 leaves hue meaningless
+};
+
+// Largest square side the kernels accept; keeps the SSE2 lane sums within 32 bits
+constexpr int kMaxBackgroundSampleSize = 256;
+
+// Sum the pixels of a top-down BGRA image whose rows are stride pixels apart (width <= kMaxBackgroundSampleSize)
+void SumBackground(const uint32_t* pixels, int width, int height, size_t stride, BackgroundSums& sums);
+// Same result one pixel at a time; slow, for verifying the kernel
+void SumBackgroundReference(const uint32_t* pixels, int width, int height, size_t stride, BackgroundSums& sums);
+
+BackgroundStats ComputeBackgroundStats(const BackgroundSums& sums);
+
+// Colors in the COLORREF layout (0x00BBGGRR), like CrosshairSettings
+struct ContrastPair {
+    uint32_t fill;
+    uint32_t outline;
+};
+
+// Yellow, cyan, magenta, green and white over near-black, red and near-black over white.
+// Near-black is 0x010000, the default outline color, so existing looks and the palette agree.
+const std::vector<ContrastPair>& DefaultContrastPalette();
+
+// How well a pair stands out against the background; larger is better
+float ScoreContrastPair(const ContrastPair& pair, const BackgroundStats& background);
+
+class AdaptiveContrast {
+public:
+    static constexpr float kDefaultMargin = 0.15f;   // A challenger must score this much (relatively) higher...
+    static constexpr int kDefaultHoldSamples = 3;    // ...for this many samples in a row before it is used
+
+    explicit AdaptiveContrast(std::vector<ContrastPair> palette = DefaultContrastPalette(),
+        float margin = kDefaultMargin, int holdSamples = kDefaultHoldSamples);
+
+    // Feed one sample; returns true when the chosen pair changed
+    bool Update(const BackgroundStats& background);
+
+    const ContrastPair& Current() const { return palette_[current_]; }
+    size_t CurrentIndex() const { return current_; }
+    uint64_t Switches() const { return switches_; }
+    // Start over from the first pair, e.g. after the mode was switched off and on again
+    void Reset();
+
+private:
+    std::vector<ContrastPair> palette_;
+    float margin_;
+    int holdSamples_;
+    size_t current_ = 0;
+    size_t challenger_ = 0;
+    int challengerSamples_ = 0;
+    bool started_ = false;
+    uint64_t switches_ = 0;
+};
+
+// Captures the screen behind the crosshair; implemented per platform
+class BackgroundSource {
+public:
+    virtual ~BackgroundSource() = default;
+    // Top-down BGRA pixels of the size x size square centered on (centerX, centerY), valid until the next
+    // call; null if the capture failed
+    virtual const uint32_t* Capture(int centerX, int centerY, int size) = 0;
+};
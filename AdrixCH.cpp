@@ -2,167 +2,660 @@
 // By Adrix12team, 2025 | License under "LICENSE" file in repository root.
 
 #include <windows.h>
-#include <thread>
 #include <commctrl.h>
+#include <atomic>
+#include <cstring>
 #include <string>
 #include <shlobj.h>
 
+#include "AdaptiveContrast.h"
+#include "AdrixCH.h"
+#include "AllocationTracking.h"
+#include "CodeLibrary.h"
+#include "ControlChannel.h"
+#include "CrosshairAnimation.h"
+#include "CrosshairCode.h"
+#include "CrosshairGeometry.h"
+#include "CrosshairRaster.h"
+#include "DisplayLayout.h"
+#include "GdiResourceCache.h"
+#include "ProfileLibrary.h"
+#include "RepaintScheduler.h"
+#include "Seqlock.h"
+#include "SettingsPanel.h"
+#include "SettingsStore.h"
+#include "SpriteCache.h"
+#include "Trace.h"
+#include "Win32DisplaySource.h"
+#include "Win32FileWatcher.h"
+#include "Win32GdiAllocator.h"
+#include "Win32InputSource.h"
+#include "Win32ScreenSource.h"
+
 std::wstring iniPath;
+SettingsStore g_settingsStore; // crosshair_settings.ini, read once at startup and written back on close
+std::wstring profilesPath;
+ProfileLibrary g_profiles;     // profiles.axpl, memory-mapped; cycling is a slot change plus a repaint
+size_t g_profileSlot = 0;
+CrosshairCodeLibrary g_codeLibrary; // The last shared code list imported, searched by similarity
+std::wstring tracePath;        // trace.txt, written by the DumpTrace hotkey when [Diagnostics] Trace=1
 #pragma comment(lib, "comctl32.lib")
-constexpr auto IDI_ICON1 = 101;
 
 // Initialize variables
-int g_len, g_gap, g_thickness, g_outlineThickness;
-bool g_centerDot;
-COLORREF g_fillColor, g_outlineColor;
+CrosshairSettings g_crosshair;                 // Edited by the settings window, hotkeys and profiles
+Seqlock<CrosshairSettings> g_crosshairSnapshot; // What the overlay draws: g_crosshair as of the last update
+bool g_compactOverlay = true; // Size the overlay to the crosshair instead of the whole screen
+uint32_t g_monitorSelection = kPrimaryMonitorOnly; // [Crosshair] Monitors: primary, all, or indices like 0,2
+bool g_dpiScaling = true; // Scale crosshair sizes with each monitor's DPI
 
 HWND hBtnClose = NULL;
 HWND hBtnCenter = NULL;
+HWND hBtnTStyle = NULL;
 HWND hBtnFill = NULL;
 HWND hBtnOutline = NULL;
 HWND hBtnLoadCode = NULL;
-
-HFONT g_hFont = NULL;
+HWND hBtnImportCodes = NULL;
+HWND hBtnUseClosest = NULL;
+HWND hLabelImport = NULL;
+
+// Settings window brushes and font come from one shared cache: reopening the window or repainting its
+// controls reuses the same GDI objects instead of creating new ones
+Win32GdiAllocator g_gdiAllocator;
+GdiResourceCache g_gdiCache(g_gdiAllocator);
+GdiResource g_settingsBackground; // Window class and label background; held for as long as the class exists
+GdiResource g_buttonBrush;        // Held while the settings window is open
+GdiResource g_settingsFont;
 
 HWND hLabelLen = NULL;
 HWND hLabelGap = NULL;
+HWND hLabelRotation = NULL;
+HWND hLabelCircle = NULL;
 HWND hLabelThickness = NULL;
 HWND hLabelOutline = NULL;
 
 HWND hCrosshairCodeInput = NULL;
 
+// What the labels, toggle buttons and code box show; only controls whose text changes are sent new text
+SettingsPanelText g_settingsPanel;
+
+// Hotkeys arrive from the keyboard hook thread and are handled on the overlay thread
+constexpr UINT WM_APP_HOTKEY = WM_APP + 1;
+
+// The INI file is watched for changes made by other programs; a burst of notifications for one write is
+// reloaded once, after the file has been quiet for SETTINGS_RELOAD_DELAY_MS
+constexpr UINT WM_APP_SETTINGS_CHANGED = WM_APP + 2;
+constexpr UINT_PTR SETTINGS_RELOAD_TIMER_ID = 3;
+constexpr UINT SETTINGS_RELOAD_DELAY_MS = 100;
+Win32FileWatcher g_settingsWatcher;
+std::atomic<bool> g_settingsChangePosted{ false };
+HotkeyDispatcher g_hotkeys;
+Win32InputSource g_inputSource;
+
+// Code lists chosen in the settings window are read on the import job's thread, which posts this once the
+// list is indexed; the closest crosshair in it is offered, and only applied when the user asks for it
+constexpr UINT WM_APP_CODES_IMPORTED = WM_APP + 3;
+CrosshairCodeImportJob g_codeImport;
+size_t g_codeSuggestion = CrosshairCodeLibrary::npos; // Entry of g_codeLibrary offered by "Use Closest"
+
+// Start of the slider-to-frame and hotkey-to-frame spans waiting for the next overlay paint (0: none)
+uint64_t g_sliderTraceStart = 0;
+uint64_t g_hotkeyTraceStart = 0;
+
+// Settings changes are merged and pushed to the overlay and settings window at most once per refresh
+SteadyClock g_clock;
+RepaintScheduler g_repaints(g_clock);
+constexpr UINT_PTR REPAINT_TIMER_ID = 1; // Only armed while changes are pending
+
+// Adaptive contrast ([Adaptive] Enabled, RateHz, SampleSize): the background behind the first crosshair picks
+// the colors from a palette; the colors chosen in the settings window are kept and saved as they are
+bool g_adaptiveEnabled = false;
+int g_adaptiveRateHz = 10;
+int g_adaptiveSampleSize = 64;
+Win32ScreenSource g_screenSource;
+AdaptiveContrast g_adaptive;
+constexpr UINT_PTR ADAPTIVE_TIMER_ID = 2;
+
+// External tools send commands through shared memory ([Control] Enabled=1, off by default); the message loop also
+// wakes up for them
+ControlChannelServer g_control;
+bool g_overlayVisible = true; // Hidden and shown by control commands only
+
+// Animation ([Animation] Mode, FrameRateHz, PeriodMs, Amount): every frame is rasterized into an atlas per overlay
+// when the settings change, and a high-resolution waitable timer drives the fixed-step clock, so a frame is one blit
+AnimationSettings g_animation;
+uint32_t g_animationGeneration = 0; // Bumped whenever g_animation changes
+uint32_t g_timelineGeneration = 0;
+AnimationTimeline g_timeline;
+std::vector<CrosshairSettings> g_animationFrames; // At 96 DPI, from the drawn settings
+std::vector<CrosshairSettings> g_scaledFrames;    // The same, at one overlay's DPI
+HANDLE g_animationTimer = NULL;
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
 // Forward declarations
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 LRESULT CALLBACK SettingsProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+void CreateSettingsWindow(HINSTANCE hInstance);
 void OpenSettingsWindow(HINSTANCE hInstance);
-void DrawCrosshair(HDC hdc, int cx, int cy, int len, int gap, int thickness, COLORREF fillColor, COLORREF outlineColor, bool centerDot, int outlineThickness);
+void SyncSettingsWindow(uint32_t fields = kAllCrosshairFields);
+void ArmAnimationTimer();
 
 HWND hwndMain = NULL;
-
-// Save and load helpers for INI file
-void SaveSetting(const std::wstring& path, const std::wstring& section, const std::wstring& key, const std::wstring& value) {
-    WritePrivateProfileStringW(section.c_str(), key.c_str(), value.c_str(), path.c_str());
+SpriteCache g_spriteCache; // Rendered looks, so switching back to a previous configuration is a single blit
+HWND hwndSettings = NULL;
+HINSTANCE g_hInstance = NULL;
+HICON g_appIcon = NULL; // Embedded IDI_ICON1, loaded once for both window classes
+
+// Monitor topology, enumerated once and re-read only when the display configuration or DPI changes
+Win32DisplaySource g_displaySource;
+DisplayLayout g_displayLayout(g_displaySource);
+std::vector<CrosshairPlacement> g_placements;
+
+// One overlay window per placed crosshair; the first is hwndMain, which owns the message loop
+struct OverlayInstance {
+    HWND hwnd = NULL;
+    CrosshairRect window = {}; // Screen rect the window covers
+    CrosshairPlacement placement; // Screen-space box last painted, plus the scaled settings it was painted with
+    AnimationAtlas atlas;         // Every animation frame at this overlay's scale; empty without an animation
+    CrosshairSettings atlasSettings;
+    uint32_t atlasGeneration = 0;
+
+    // Premultiplied BGRA image of the whole window, handed to UpdateLayeredWindow; recreated only on resize
+    HDC surfaceDc = NULL;
+    HBITMAP surface = NULL;
+    HGDIOBJ previousBitmap = NULL;
+    uint32_t* surfacePixels = nullptr;
+    int surfaceWidth = 0, surfaceHeight = 0;
+    CrosshairRect drawn = {}; // Part of the surface holding the last image, in window coordinates
+};
+std::vector<OverlayInstance> g_overlays;
+const wchar_t OVERLAY_CLASS_NAME[] = L"AdrixCH";
+
+// The settings the overlay should draw: the edited ones, with the adaptive colors while that mode is on
+CrosshairSettings DrawnCrosshairSettings() {
+    CrosshairSettings drawn = g_crosshair;
+    if (g_adaptiveEnabled) {
+        drawn.fillColor = g_adaptive.Current().fill;
+        drawn.outlineColor = g_adaptive.Current().outline;
+    }
+    return drawn;
 }
-std::wstring LoadSetting(const std::wstring& path, const std::wstring& section, const std::wstring& key, const std::wstring& defaultValue = L"") {
-    wchar_t buffer[256];
-    GetPrivateProfileStringW(section.c_str(), key.c_str(), defaultValue.c_str(), buffer, 256, path.c_str());
-    return buffer;
+
+// Take the options outside the crosshair fields from the store; returns true if one the overlay placement
+// depends on changed
+bool ApplySettingsOptions() {
+    const bool compactOverlay = g_settingsStore.GetFlag(SettingsStore::kCrosshairSection, "CompactOverlay", true);
+    const bool dpiScaling = g_settingsStore.GetFlag(SettingsStore::kCrosshairSection, "DpiScaling", true);
+    uint32_t monitorSelection = kPrimaryMonitorOnly;
+    if (!ParseMonitorSelection(g_settingsStore.Get(SettingsStore::kCrosshairSection, "Monitors", "primary"), monitorSelection)) {
+        monitorSelection = kPrimaryMonitorOnly;
+    }
+    const bool placementChanged = compactOverlay != g_compactOverlay || dpiScaling != g_dpiScaling || monitorSelection != g_monitorSelection;
+    g_compactOverlay = compactOverlay;
+    g_dpiScaling = dpiScaling;
+    g_monitorSelection = monitorSelection;
+
+    SetTraceEnabled(g_settingsStore.GetFlag("Diagnostics", "Trace", false));
+    g_adaptiveEnabled = g_settingsStore.GetFlag("Adaptive", "Enabled", false);
+    g_adaptiveRateHz = g_settingsStore.GetInt("Adaptive", "RateHz", 10, 1, 60);
+    g_adaptiveSampleSize = g_settingsStore.GetInt("Adaptive", "SampleSize", 64, 8, kMaxBackgroundSampleSize);
+
+    // A new animation changes the overlay size as much as a new placement does
+    AnimationSettings animation;
+    if (!ParseAnimationMode(g_settingsStore.Get("Animation", "Mode", "none"), animation.mode)) animation.mode = AnimationMode::None;
+    animation.frameRateHz = g_settingsStore.GetInt("Animation", "FrameRateHz", 60, 1, 240);
+    animation.periodMs = g_settingsStore.GetInt("Animation", "PeriodMs", 600, 50, 10000);
+    animation.amount = g_settingsStore.GetInt("Animation", "Amount", 8, 1, kMaxAnimationAmount);
+    const bool animationChanged = !(animation == g_animation);
+    if (animationChanged) {
+        g_animation = animation;
+        g_animationGeneration++;
+    }
+    return placementChanged || animationChanged;
 }
 
 void LoadCrosshairSettings() {
-    // Load settings from INI file or use defaults
-    g_len = std::stoi(LoadSetting(iniPath, L"Crosshair", L"Length", L"7"));
-    g_gap = std::stoi(LoadSetting(iniPath, L"Crosshair", L"GapSize", L"1"));
-    g_thickness = std::stoi(LoadSetting(iniPath, L"Crosshair", L"Thickness", L"2"));
-    g_outlineThickness = std::stoi(LoadSetting(iniPath, L"Crosshair", L"OutlineThickness", L"1"));
-    g_centerDot = (LoadSetting(iniPath, L"Crosshair", L"CenterDot", L"0") == L"1");
-    g_fillColor = std::stoi(LoadSetting(iniPath, L"Crosshair", L"FillColor", L"65535"));
-    g_outlineColor = std::stoi(LoadSetting(iniPath, L"Crosshair", L"OutlineColor", L"65536"));
+    // Read the INI file; missing or malformed values keep their defaults
+    g_settingsStore.Load(iniPath);
+    g_crosshair = g_settingsStore.Crosshair();
+    ApplySettingsOptions();
+    g_crosshairSnapshot.Publish(DrawnCrosshairSettings());
+}
+
+void ReleaseOverlaySurface(OverlayInstance& overlay) {
+    if (overlay.surfaceDc) {
+        SelectObject(overlay.surfaceDc, overlay.previousBitmap);
+        DeleteDC(overlay.surfaceDc);
+    }
+    if (overlay.surface) DeleteObject(overlay.surface);
+    overlay.surfaceDc = NULL;
+    overlay.surface = NULL;
+    overlay.surfacePixels = nullptr;
+    overlay.surfaceWidth = overlay.surfaceHeight = 0;
+    overlay.drawn = {};
+}
+
+// Give the overlay a surface of the window's size. A new surface starts out fully transparent (DIB sections
+// are zero-filled); returns false if it could not be created.
+bool EnsureOverlaySurface(OverlayInstance& overlay, int width, int height, bool& created) {
+    created = false;
+    if (overlay.surface && overlay.surfaceWidth == width && overlay.surfaceHeight == height) return true;
+    ReleaseOverlaySurface(overlay);
+    if (width <= 0 || height <= 0) return false;
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height; // Top-down rows, like the sprites
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+    void* bits = nullptr;
+    overlay.surfaceDc = CreateCompatibleDC(NULL);
+    overlay.surface = overlay.surfaceDc ? CreateDIBSection(overlay.surfaceDc, &bmi, DIB_RGB_COLORS, &bits, NULL, 0) : NULL;
+    if (!overlay.surface) { ReleaseOverlaySurface(overlay); return false; }
+    overlay.previousBitmap = SelectObject(overlay.surfaceDc, overlay.surface);
+    overlay.surfacePixels = static_cast<uint32_t*>(bits);
+    overlay.surfaceWidth = width;
+    overlay.surfaceHeight = height;
+    created = true;
+    return true;
 }
 
-// Encode and decode crosshair settings into a compact string
-std::wstring GetCrosshairCode() {
-    wchar_t buf[32];
-    swprintf(buf, 32, L"%02d%02d%02d%02d%d-%06X-%06X",
-        g_len, g_gap, g_thickness, g_outlineThickness,
-        g_centerDot ? 1 : 0,
-        g_fillColor & 0xFFFFFF,
-        g_outlineColor & 0xFFFFFF
+// Copy a top-down premultiplied BGRA image into the surface with its origin at (cx, cy), clipped to the surface.
+// Returns the part of the surface written.
+CrosshairRect CopyToSurface(OverlayInstance& overlay, const uint32_t* pixels, int width, int height, int originX, int originY, int cx, int cy) {
+    CrosshairRect target = { cx - originX, cy - originY, cx - originX + width, cy - originY + height };
+    if (target.left < 0) target.left = 0;
+    if (target.top < 0) target.top = 0;
+    if (target.right > overlay.surfaceWidth) target.right = overlay.surfaceWidth;
+    if (target.bottom > overlay.surfaceHeight) target.bottom = overlay.surfaceHeight;
+    if (!pixels || IsEmptyCrosshairRect(target)) return {};
+
+    const int sourceX = target.left - (cx - originX), sourceY = target.top - (cy - originY);
+    const size_t rowBytes = (size_t)(target.right - target.left) * sizeof(uint32_t);
+    for (int y = target.top; y < target.bottom; y++) {
+        memcpy(overlay.surfacePixels + (size_t)y * overlay.surfaceWidth + target.left,
+            pixels + (size_t)(sourceY + y - target.top) * width + sourceX, rowBytes);
+    }
+    return target;
+}
+
+// Draw the overlay's crosshair (or the given animation frame) into its surface and present it with per-pixel
+// alpha, so anti-aliased edges blend with whatever is behind them. Only the union of the old and new image is
+// cleared and handed to the compositor; UpdateLayeredWindow also moves and sizes the window to overlay.window.
+void PresentOverlay(OverlayInstance& overlay, size_t frame) {
+    ScopedTrace trace(TraceSpan::DrawCrosshair);
+    const int width = overlay.window.right - overlay.window.left, height = overlay.window.bottom - overlay.window.top;
+    bool created = false;
+    if (!EnsureOverlaySurface(overlay, width, height, created)) return;
+
+    const CrosshairRect previous = overlay.drawn;
+    for (int y = previous.top; y < previous.bottom; y++) {
+        memset(overlay.surfacePixels + (size_t)y * overlay.surfaceWidth + previous.left, 0, (size_t)(previous.right - previous.left) * sizeof(uint32_t));
+    }
+
+    const int cx = overlay.placement.centerX - overlay.window.left, cy = overlay.placement.centerY - overlay.window.top;
+    const AnimationAtlas& atlas = overlay.atlas;
+    if (atlas.FrameCount()) {
+        if (frame >= atlas.FrameCount()) frame = atlas.FrameCount() - 1;
+        overlay.drawn = CopyToSurface(overlay, atlas.FramePixels(frame), atlas.CellWidth(), atlas.CellHeight(), atlas.OriginX(), atlas.OriginY(), cx, cy);
+    }
+    else {
+        const CrosshairSprite& sprite = g_spriteCache.Get(overlay.placement.settings);
+        overlay.drawn = CopyToSurface(overlay, sprite.pixels.empty() ? nullptr : sprite.pixels.data(), sprite.width, sprite.height, sprite.originX, sprite.originY, cx, cy);
+    }
+
+    const CrosshairRect dirty = UnionCrosshairRects(previous, overlay.drawn);
+    RECT dirtyRect = { dirty.left, dirty.top, dirty.right, dirty.bottom };
+    POINT position = { overlay.window.left, overlay.window.top };
+    POINT source = { 0, 0 };
+    SIZE size = { width, height };
+    BLENDFUNCTION blend = { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA };
+    UPDATELAYEREDWINDOWINFO info = {};
+    info.cbSize = sizeof(info);
+    info.hdcSrc = overlay.surfaceDc;
+    info.pptDst = &position;
+    info.psize = &size;
+    info.pptSrc = &source;
+    info.pblend = &blend;
+    info.dwFlags = ULW_ALPHA;
+    info.prcDirty = created || IsEmptyCrosshairRect(dirty) ? NULL : &dirtyRect; // A new surface goes out whole
+    UpdateLayeredWindowIndirect(overlay.hwnd, &info);
+}
+
+// Create an always-on-top, layered, click-through overlay window; UpdateOverlay positions, presents and shows it
+HWND CreateOverlayWindow() {
+    return CreateWindowEx(
+        WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOPMOST | WS_EX_TOOLWINDOW,
+        OVERLAY_CLASS_NAME, L"AdrixCH", WS_POPUP,
+        0, 0, 0, 0, NULL, NULL, g_hInstance, NULL
     );
-    return std::wstring(buf);
 }
-void LoadCrosshairCode(const std::wstring& code) {
-    int len, gap, thick, outline, dot;
-    unsigned int fill, outlineCol;
-
-    swscanf_s(code.c_str(), L"%2d%2d%2d%2d%d-%6X-%6X",
-        &len, &gap, &thick, &outline, &dot, &fill, &outlineCol);
-
-    g_len = len;
-    g_gap = gap;
-    g_thickness = thick;
-    g_outlineThickness = outline;
-    g_centerDot = dot != 0;
-    g_fillColor = fill;
-    g_outlineColor = outlineCol;
+
+// Apply changed settings to every overlay and present them, each updating only the union of its old and new
+// crosshair boxes. Placement works on the cached monitor topology, so this makes no display queries.
+void UpdateOverlay() {
+    if (!hwndMain) return;
+    const CrosshairSettings drawn = g_crosshairSnapshot.Read();
+    g_displayLayout.Place(drawn, g_monitorSelection, g_dpiScaling, g_placements);
+    if (g_placements.empty()) return;
+
+    BuildAnimationFrames(drawn, g_animation, g_animationFrames);
+    if (g_timelineGeneration != g_animationGeneration) {
+        g_timeline.Configure(g_animation, g_animationFrames.size(), g_clock.NowUs());
+        g_timelineGeneration = g_animationGeneration;
+    }
+
+    // One window per placement; hwndMain is always kept as the first
+    while (g_overlays.size() > g_placements.size()) {
+        ReleaseOverlaySurface(g_overlays.back());
+        DestroyWindow(g_overlays.back().hwnd);
+        g_overlays.pop_back();
+    }
+    while (g_overlays.size() < g_placements.size()) {
+        OverlayInstance overlay;
+        overlay.hwnd = CreateOverlayWindow();
+        if (!overlay.hwnd) { g_placements.resize(g_overlays.size()); break; }
+        g_overlays.push_back(overlay);
+    }
+
+    const std::vector<MonitorInfo>& monitors = g_displayLayout.Monitors();
+    for (size_t i = 0; i < g_overlays.size(); i++) {
+        OverlayInstance& overlay = g_overlays[i];
+        CrosshairPlacement placement = g_placements[i];
+
+        // An animated overlay covers every frame: rasterize them all now, at this monitor's scale
+        if (g_animationFrames.empty()) {
+            overlay.atlas.Clear();
+        }
+        else {
+            if (overlay.atlas.FrameCount() == 0 || overlay.atlasGeneration != g_animationGeneration || !(overlay.atlasSettings == placement.settings)) {
+                g_scaledFrames.clear();
+                const int dpi = monitors[placement.monitor].dpi;
+                for (const CrosshairSettings& frame : g_animationFrames) g_scaledFrames.push_back(g_dpiScaling ? ScaleCrosshairSettings(frame, dpi) : frame);
+                overlay.atlas.Build(g_scaledFrames);
+                overlay.atlasSettings = placement.settings;
+                overlay.atlasGeneration = g_animationGeneration;
+            }
+            placement.box = OffsetCrosshairRect(overlay.atlas.Bounds(), placement.centerX, placement.centerY);
+        }
+
+        overlay.placement = placement;
+
+        // The compact window only covers the crosshair; whatever it leaves behind is uncovered by the compositor.
+        // Presenting moves and resizes the window; a layered window only becomes visible once it has an image.
+        const CrosshairRect window = g_compactOverlay ? placement.box : monitors[placement.monitor].bounds;
+        const bool moved = !(window == overlay.window);
+        overlay.window = window;
+        PresentOverlay(overlay, g_timeline.Frame());
+        if (moved && g_overlayVisible) ShowWindow(overlay.hwnd, SW_SHOWNOACTIVATE);
+    }
+
+    // The frame is out: close any latency spans that were waiting for it
+    if (g_sliderTraceStart) { TraceEnd(TraceSpan::SliderToFrame, g_sliderTraceStart); g_sliderTraceStart = 0; }
+    if (g_hotkeyTraceStart) { TraceEnd(TraceSpan::HotkeyToFrame, g_hotkeyTraceStart); g_hotkeyTraceStart = 0; }
+    ArmAnimationTimer();
+}
+
+// Wake the message loop when the next animation step is due, or stop it while nothing would move
+void ArmAnimationTimer() {
+    if (!g_animationTimer) return;
+    if (!g_overlayVisible || !g_timeline.Running()) {
+        CancelWaitableTimer(g_animationTimer);
+        return;
+    }
+    const uint64_t delayUs = g_timeline.DelayUs(g_clock.NowUs());
+    LARGE_INTEGER due;
+    due.QuadPart = -(LONGLONG)(delayUs ? delayUs : 1) * 10; // Relative, in 100 ns units
+    SetWaitableTimer(g_animationTimer, &due, 0, NULL, NULL, FALSE);
 }
 
-bool IsValidCrosshairCode(const std::wstring& code) {
-    if (code.length() != 23) return false; // 9 digits + '-' + 6 Hex + '-' + 6 Hex = 23 chars
-    if (code[9] != '-' || code[16] != '-') return false;
+// An animation step came due: copy its frame into every overlay's surface and present it straight away
+void StepAnimation() {
+    const uint64_t nowUs = g_clock.NowUs();
+    const size_t before = g_timeline.Frame();
+    const size_t frame = g_timeline.Advance(nowUs);
+    if (frame != before && g_overlayVisible) {
+        for (OverlayInstance& overlay : g_overlays) {
+            if (overlay.atlas.FrameCount() == 0) continue;
+            PresentOverlay(overlay, frame);
+        }
+        TraceEnd(TraceSpan::AnimationFrame, TraceEnabled() ? (nowUs - g_timeline.LastLatenessUs()) * 1000 : 0);
+    }
+    ArmAnimationTimer();
+}
 
-	// Check if the first 9 characters are digits
-    for (int i = 0; i < 9; i++) {
-        if (!iswdigit(code[i])) return false;
+// Push pending changes out if they are due, otherwise (re)arm the timer for when they will be
+void PumpRepaints() {
+    if (!hwndMain || !g_repaints.Pending()) return;
+    const uint64_t delayUs = g_repaints.DelayUs();
+    if (delayUs) {
+        SetTimer(hwndMain, REPAINT_TIMER_ID, (UINT)((delayUs + 999) / 1000), NULL);
+        return;
     }
+    KillTimer(hwndMain, REPAINT_TIMER_ID);
+
+    // One consistent update: every field is already final, so the overlay and the code box agree.
+    // The overlay only ever reads whole published snapshots, never the settings being edited.
+    const uint32_t fields = g_repaints.TakeDue();
+    g_crosshairSnapshot.Publish(DrawnCrosshairSettings());
+    UpdateOverlay();
+    SyncSettingsWindow(fields);
+}
 
-	// Center dot should be '0' or '1'
-    if (code[8] != L'0' && code[8] != L'1') return false;
+// Record changed settings fields; the overlay and settings window follow at the next refresh boundary
+void ScheduleRepaint(uint32_t fields) {
+    if (g_repaints.MarkChanged(fields)) PumpRepaints();
+}
 
-	// Check if the hex parts are valid hexadecimal digits
-    for (int i = 10; i < 16; i++) {
-        if (!iswxdigit(code[i])) return false;
+// Use the fastest monitor's refresh interval for merging settings changes
+void UpdateRepaintInterval() {
+    int refreshHz = 0;
+    for (const MonitorInfo& monitor : g_displayLayout.Monitors()) if (monitor.refreshHz > refreshHz) refreshHz = monitor.refreshHz;
+    g_repaints.SetIntervalUs(refreshHz > 0 ? 1000000u / refreshHz : RepaintScheduler::kDefaultIntervalUs);
+}
+
+// Analyze the screen behind the first crosshair; a new color pair goes out like any other settings change
+void SampleBackground() {
+    if (!g_adaptiveEnabled || g_placements.empty()) return;
+    ScopedTrace trace(TraceSpan::BackgroundSample);
+    const CrosshairPlacement& placement = g_placements.front();
+    const uint32_t* pixels = g_screenSource.Capture(placement.centerX, placement.centerY, g_adaptiveSampleSize);
+    if (!pixels) return;
+
+    BackgroundSums sums;
+    SumBackground(pixels, g_adaptiveSampleSize, g_adaptiveSampleSize, (size_t)g_adaptiveSampleSize, sums);
+    if (g_adaptive.Update(ComputeBackgroundStats(sums))) {
+        ScheduleRepaint(CrosshairFieldBit(CrosshairField::FillColor) | CrosshairFieldBit(CrosshairField::OutlineColor));
     }
-    for (int i = 17; i < 23; i++) {
-        if (!iswxdigit(code[i])) return false;
+}
+
+// Sample the background at the configured rate while adaptive contrast is on
+void UpdateAdaptiveTimer() {
+    if (!hwndMain) return;
+    if (!g_adaptiveEnabled) { KillTimer(hwndMain, ADAPTIVE_TIMER_ID); return; }
+    SampleBackground();
+    SetTimer(hwndMain, ADAPTIVE_TIMER_ID, 1000 / g_adaptiveRateHz, NULL);
+}
+
+// The INI file changed on disk. Only the crosshair fields the file itself changed are applied, so edits made
+// in the settings window to other fields survive; the overlay repaints only if what it draws changed.
+// Our own saves have the bytes the store last wrote and are skipped without being parsed.
+void ReloadCrosshairSettings() {
+    uint32_t fileFields = 0;
+    if (!g_settingsStore.Reload(iniPath, fileFields)) return;
+
+    const CrosshairSettings before = g_crosshair;
+    const CrosshairSettings drawnBefore = DrawnCrosshairSettings();
+    const bool adaptiveBefore = g_adaptiveEnabled;
+    const int rateBefore = g_adaptiveRateHz;
+    CopyCrosshairFields(g_crosshair, g_settingsStore.Crosshair(), fileFields);
+    const bool placementChanged = ApplySettingsOptions();
+    if (g_adaptiveEnabled != adaptiveBefore || g_adaptiveRateHz != rateBefore) {
+        if (g_adaptiveEnabled && !adaptiveBefore) g_adaptive.Reset();
+        UpdateAdaptiveTimer();
+    }
+
+    const uint32_t fields = DiffCrosshairSettings(before, g_crosshair) | DiffCrosshairSettings(drawnBefore, DrawnCrosshairSettings());
+    if (fields) {
+        ScheduleRepaint(fields);
     }
+    else if (placementChanged) {
+        UpdateOverlay();
+    }
+}
 
+// Apply the profile in the given library slot: no parsing, just a record read and a repaint
+bool ApplyProfile(size_t slot) {
+    const ProfileRecord* record = g_profiles.At(slot);
+    CrosshairSettings settings = g_crosshair;
+    if (!record || !ProfileLibrary::ToSettings(*record, settings)) return false;
+
+    g_profileSlot = slot;
+    g_crosshair = settings;
+    ScheduleRepaint(kAllCrosshairFields);
     return true;
 }
 
-void DrawCrosshair(HDC hdc, int cx, int cy, int len, int gap, int thickness, COLORREF fillColor, COLORREF outlineColor, bool centerDot, int outlineThickness) {
-    auto DrawRectWithOutline = [&](RECT r) {
-        // Fill color
-        HBRUSH hBrush = CreateSolidBrush(fillColor);
-        FillRect(hdc, &r, hBrush);
-        DeleteObject(hBrush);
-
-        // Draw outline only if outlineThickness > 0
-        if (outlineThickness > 0) {
-            HPEN hPen = CreatePen(PS_SOLID, outlineThickness, outlineColor);
-            HGDIOBJ oldPen = SelectObject(hdc, hPen);
-            HBRUSH hOldBrush = (HBRUSH)SelectObject(hdc, GetStockObject(NULL_BRUSH));
-            Rectangle(hdc, r.left, r.top, r.right, r.bottom);
-            SelectObject(hdc, oldPen);
-            SelectObject(hdc, hOldBrush);
-            DeleteObject(hPen);
-        }
-    };
+// Step forwards or backwards through the profile library, wrapping around
+void SwitchProfile(int step) {
+    const size_t count = g_profiles.Count();
+    if (count == 0) return;
+    ApplyProfile((g_profileSlot + count + (step % (int)count)) % count);
+}
 
-	// Compute rectangles for each arm of the crosshair, this is where the magic happens
-    RECT left   = { cx - len - gap, cy - thickness / 2, cx - gap, cy + thickness / 2 };
-    RECT right  = { cx + gap, cy - thickness / 2, cx + len + gap, cy + thickness / 2 };
-    RECT top    = { cx - thickness / 2, cy - len - gap, cx + thickness / 2, cy - gap };
-    RECT bottom = { cx - thickness / 2, cy + gap, cx + thickness / 2, cy + len + gap };
+// Show or hide every overlay window; placement updates keep hidden windows hidden
+void SetOverlayVisible(bool visible) {
+    if (visible && !g_overlayVisible) g_timeline.Resync(g_clock.NowUs()); // Time spent hidden drops no frames
+    g_overlayVisible = visible;
+    for (const OverlayInstance& overlay : g_overlays) ShowWindow(overlay.hwnd, visible ? SW_SHOWNOACTIVATE : SW_HIDE);
+    ArmAnimationTimer();
+}
 
-    DrawRectWithOutline(left); DrawRectWithOutline(right); DrawRectWithOutline(top); DrawRectWithOutline(bottom);
+// Apply every command waiting in the control channel. Each is acknowledged as soon as the crosshair holds it;
+// the overlay follows at the next refresh boundary, merged with any other changes.
+void DrainControlChannel() {
+    ControlCommand command;
+    while (g_control.Poll(command)) {
+        ControlStatus status = ControlStatus::Applied;
+        switch (command.type) {
+        case ControlCommandType::SelectProfile:
+            if (command.value < 0 || !ApplyProfile((size_t)command.value)) status = ControlStatus::Rejected;
+            break;
+        case ControlCommandType::StepProfile:
+            if (g_profiles.Count() == 0) status = ControlStatus::Rejected;
+            else SwitchProfile(command.value);
+            break;
+        case ControlCommandType::SetVisible:
+            SetOverlayVisible(command.value != 0);
+            break;
+        case ControlCommandType::ToggleVisible:
+            SetOverlayVisible(!g_overlayVisible);
+            break;
+        default: {
+            const CrosshairSettings before = g_crosshair;
+            status = ApplyControlCommand(command, g_crosshair);
+            const uint32_t fields = DiffCrosshairSettings(before, g_crosshair);
+            if (fields) ScheduleRepaint(fields);
+            break;
+        }
+        }
+        g_control.Acknowledge(command.sequence, status);
+    }
+}
 
-    // Optional center dot drawn as a filled rectangle with outline
-    if (centerDot) { RECT dot = { cx - thickness / 2, cy - thickness / 2, cx + thickness / 2, cy + thickness / 2 }; DrawRectWithOutline(dot); }
+// Append the current crosshair to the library, named after its code
+void SaveCurrentProfile() {
+    char name[kCrosshairCodeBufferSize];
+    const CrosshairSettings settings = g_crosshair;
+    const size_t length = EncodeCrosshairCode(settings, name, sizeof(name));
+    if (g_profiles.Append(profilesPath, std::string_view(name, length), settings)) g_profileSlot = g_profiles.Count() - 1;
 }
 
-// Main overlay window procedure: paints transparent fullscreen and draws the crosshair
+// Main overlay window procedure. The overlays are layered windows presented with UpdateLayeredWindow, so they
+// get no WM_PAINT; this handles hotkeys, timers and the other application messages.
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam) {
     switch (msg) {
-    case WM_PAINT: {
-        PAINTSTRUCT ps;
-        HDC hdc = BeginPaint(hwnd, &ps);
-
-        // Fill background with the color key (this will be treated as transparent due to SetLayeredWindowAttributes)
-        RECT fullScreen = { 0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN) };
-        HBRUSH hBrush = CreateSolidBrush(RGB(0, 0, 0));
-        FillRect(hdc, &fullScreen, hBrush);
-        DeleteObject(hBrush);
-
-        // Draw the crosshair centered on the primary monitor
-        int cx = GetSystemMetrics(SM_CXSCREEN) / 2;
-        int cy = GetSystemMetrics(SM_CYSCREEN) / 2;
-        DrawCrosshair(hdc, cx, cy, g_len, g_gap, g_thickness * 2, g_fillColor, g_outlineColor, g_centerDot, g_outlineThickness);
-
-        EndPaint(hwnd, &ps);
+    case WM_APP_HOTKEY: {
+        HotkeyEvent event;
+        while (g_hotkeys.Poll(event)) {
+            if (event.action == HotkeyAction::AnimationHold) {
+                g_timeline.SetHeld(event.pressed, g_clock.NowUs());
+                ArmAnimationTimer();
+                continue;
+            }
+            if (!event.pressed) continue;
+            // Key timestamps come from the trace clock, so the span starts at the physical key press
+            const uint64_t pressedNs = TraceEnabled() ? event.timeUs * 1000 : 0;
+            switch (event.action) {
+            case HotkeyAction::OpenSettings:
+                OpenSettingsWindow(g_hInstance); // Painted synchronously, so its frame is done on return
+                TraceEnd(TraceSpan::HotkeyToFrame, pressedNs);
+                TraceEnd(TraceSpan::SettingsShow, pressedNs);
+                break;
+            case HotkeyAction::NextProfile:
+            case HotkeyAction::PreviousProfile:
+                if (!g_hotkeyTraceStart && g_profiles.Count()) g_hotkeyTraceStart = pressedNs; // No profiles, no frame
+                SwitchProfile(event.action == HotkeyAction::NextProfile ? 1 : -1);
+                break;
+            case HotkeyAction::SaveProfile: SaveCurrentProfile(); break;
+            case HotkeyAction::DumpTrace: {
+                const AnimationStats& stats = g_timeline.Stats();
+                char animation[256];
+                snprintf(animation, sizeof(animation), "\n# animation, lateness in microseconds\nsteps,frames,dropped,late,max-lateness\n%llu,%llu,%llu,%llu,%llu\n"
+                    "\n# heap allocations since start\nall-threads,overlay-thread\n%llu,%llu\n",
+                    (unsigned long long)stats.steps, (unsigned long long)stats.frames, (unsigned long long)stats.dropped,
+                    (unsigned long long)stats.late, (unsigned long long)stats.maxLatenessUs,
+                    (unsigned long long)HeapAllocationCount(), (unsigned long long)ThreadHeapAllocationCount());
+                TraceDump(tracePath, animation);
+                break;
+            }
+            default: break;
+            }
+        }
+        break;
+    }
+    case WM_DISPLAYCHANGE:
+    case WM_DPICHANGED:
+        // Monitors were added, removed, moved or rescaled: re-enumerate once and re-place every instance
+        g_displayLayout.Invalidate();
+        UpdateRepaintInterval();
+        UpdateOverlay();
+        break;
+    case WM_APP_CODES_IMPORTED: {
+        CodeImportStats stats;
+        const bool complete = g_codeImport.Finish(g_codeLibrary, stats);
+        float distance = 0;
+        g_codeSuggestion = g_codeLibrary.Nearest(g_crosshair, &distance);
+        wchar_t status[192];
+        int length = swprintf(status, 192, L"%ls%llu crosshairs (%llu repeats, %llu invalid lines).",
+            complete ? L"" : L"Read error after ", (unsigned long long)g_codeLibrary.Size(),
+            (unsigned long long)stats.duplicates, (unsigned long long)stats.rejected);
+        if (g_codeSuggestion != CrosshairCodeLibrary::npos && length > 0) {
+            wchar_t code[kCrosshairCodeBufferSize];
+            EncodeCrosshairCode(g_codeLibrary.At(g_codeSuggestion), code, kCrosshairCodeBufferSize);
+            swprintf(status + length, 192 - length, distance == 0 ? L" Yours is in the list: %ls" : L" Closest: %ls", code);
+        }
+        if (hLabelImport) SetWindowText(hLabelImport, status);
+        if (hBtnImportCodes) EnableWindow(hBtnImportCodes, TRUE);
+        if (hBtnUseClosest) EnableWindow(hBtnUseClosest, g_codeSuggestion != CrosshairCodeLibrary::npos && distance > 0);
         break;
     }
-    case WM_DESTROY: PostQuitMessage(0); break;
+    case WM_APP_SETTINGS_CHANGED:
+        // (Re)start the quiet period; the reload happens when it runs out
+        g_settingsChangePosted.store(false);
+        SetTimer(hwnd, SETTINGS_RELOAD_TIMER_ID, SETTINGS_RELOAD_DELAY_MS, NULL);
+        break;
+    case WM_TIMER:
+        if (wParam == REPAINT_TIMER_ID) PumpRepaints();
+        else if (wParam == ADAPTIVE_TIMER_ID) SampleBackground();
+        else if (wParam == SETTINGS_RELOAD_TIMER_ID) { KillTimer(hwnd, SETTINGS_RELOAD_TIMER_ID); ReloadCrosshairSettings(); }
+        break;
+    case WM_DESTROY:
+        if (hwnd == hwndMain) PostQuitMessage(0);
+        break;
     default: return DefWindowProc(hwnd, msg, wParam, lParam);
     }
     return 0;
@@ -174,22 +667,20 @@ LRESULT CALLBACK SettingsProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     case WM_COMMAND:
         switch (LOWORD(wParam)) {
         case 1: { // Close button: persist settings and close both settings and main overlay
-            SaveSetting(iniPath, L"Crosshair", L"Length", std::to_wstring(g_len));
-            SaveSetting(iniPath, L"Crosshair", L"GapSize", std::to_wstring(g_gap));
-            SaveSetting(iniPath, L"Crosshair", L"Thickness", std::to_wstring(g_thickness));
-            SaveSetting(iniPath, L"Crosshair", L"OutlineThickness", std::to_wstring(g_outlineThickness));
-            SaveSetting(iniPath, L"Crosshair", L"CenterDot", g_centerDot ? L"1" : L"0");
-            SaveSetting(iniPath, L"Crosshair", L"FillColor", std::to_wstring(static_cast<unsigned long>(g_fillColor)));
-            SaveSetting(iniPath, L"Crosshair", L"OutlineColor", std::to_wstring(static_cast<unsigned long>(g_outlineColor)));
+            // Single atomic rewrite, skipped entirely if nothing changed
+            g_settingsStore.SetCrosshair(g_crosshair);
+            g_settingsStore.Save(iniPath);
             if (hwndMain && IsWindow(hwndMain)) { SendMessage(hwndMain, WM_CLOSE, 0, 0); } DestroyWindow(hwnd);
             break;
         }
         case 2: { // Toggle the center dot setting and request repaint
-            g_centerDot = !g_centerDot;
-            // Update code string shown to user
-            SetWindowText(hCrosshairCodeInput, GetCrosshairCode().c_str());
-            InvalidateRect(hwndMain, NULL, TRUE);
-            InvalidateRect(hwnd, NULL, TRUE); // refresh button text
+            g_crosshair.centerDot = !g_crosshair.centerDot;
+            ScheduleRepaint(CrosshairFieldBit(CrosshairField::CenterDot));
+            break;
+        }
+        case 6: { // Toggle the T-style shape (no top arm)
+            g_crosshair.tStyle = !g_crosshair.tStyle;
+            ScheduleRepaint(CrosshairFieldBit(CrosshairField::TStyle));
             break;
         }
         case 3: { // Open color chooser for fill color
@@ -197,15 +688,13 @@ LRESULT CALLBACK SettingsProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
             COLORREF custom[16] = { 0 };
             cc.lStructSize = sizeof(cc);
             cc.hwndOwner = hwnd;
-            cc.rgbResult = g_fillColor;
+            cc.rgbResult = g_crosshair.fillColor;
             cc.lpCustColors = custom;
             cc.Flags = CC_FULLOPEN | CC_RGBINIT;
             if (ChooseColor(&cc)) {
                 if (cc.rgbResult == RGB(0, 0, 0)) { cc.rgbResult = RGB(0, 0, 1); /* Lightly adjust black to avoid invisibility */ }
-                g_fillColor = cc.rgbResult;
-                // Update code string shown to user
-                SetWindowText(hCrosshairCodeInput, GetCrosshairCode().c_str());
-                InvalidateRect(hwndMain, NULL, TRUE);
+                g_crosshair.fillColor = cc.rgbResult;
+                ScheduleRepaint(CrosshairFieldBit(CrosshairField::FillColor));
             }
             break;
         }
@@ -214,65 +703,82 @@ LRESULT CALLBACK SettingsProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
             COLORREF custom[16] = { 0 };
             cc.lStructSize = sizeof(cc);
             cc.hwndOwner = hwnd;
-            cc.rgbResult = g_outlineColor;
+            cc.rgbResult = g_crosshair.outlineColor;
             cc.lpCustColors = custom;
             cc.Flags = CC_FULLOPEN | CC_RGBINIT;
             if (ChooseColor(&cc)) {
                 if (cc.rgbResult == RGB(0, 0, 0)) { cc.rgbResult = RGB(0, 0, 1); /* Same here */ }
-                g_outlineColor = cc.rgbResult;
-                // Update code string shown to user
-                SetWindowText(hCrosshairCodeInput, GetCrosshairCode().c_str());
-                InvalidateRect(hwndMain, NULL, TRUE);
+                g_crosshair.outlineColor = cc.rgbResult;
+                ScheduleRepaint(CrosshairFieldBit(CrosshairField::OutlineColor));
             }
             break;
         }
         case 5: { // Load crosshair from code input
             wchar_t buf[256];
-            GetWindowText(hCrosshairCodeInput, buf, 256);
-            std::wstring code(buf);
+            const int codeLength = GetWindowText(hCrosshairCodeInput, buf, 256);
+
+            // Validate and decode in one pass, straight from the edit buffer; settings stay untouched if the code is rejected
+            CrosshairSettings settings = g_crosshair;
+            if (!LoadCrosshairCode(std::wstring_view(buf, codeLength > 0 ? codeLength : 0), settings)) {
+                // Not a code: it may be the name of a saved profile
+                char name[ProfileLibrary::kMaxNameLength * 3 + 1];
+                const int length = WideCharToMultiByte(CP_UTF8, 0, buf, -1, name, sizeof(name), NULL, NULL);
+                const ProfileRecord* record = length > 0 ? g_profiles.Find(name) : nullptr;
+                if (record) { ApplyProfile(g_profiles.SlotOf(record)); break; }
 
-            if (!IsValidCrosshairCode(code)) {
                 MessageBox(hwnd, L"Invalid Crosshair Code!", L"Error", MB_OK | MB_ICONERROR);
 				break; // Break if crosshair code is invalid
             }
 
 			// Working code, load settings
-            LoadCrosshairCode(code);
-
-            // Update Slider & Labels
-            SendMessage(GetDlgItem(hwnd, 101), TBM_SETPOS, TRUE, g_len);
-            SendMessage(GetDlgItem(hwnd, 102), TBM_SETPOS, TRUE, g_thickness);
-            SendMessage(GetDlgItem(hwnd, 103), TBM_SETPOS, TRUE, g_outlineThickness);
-            SendMessage(GetDlgItem(hwnd, 104), TBM_SETPOS, TRUE, g_gap);
-
-			// Update code string shown to user
-            SetWindowText(hCrosshairCodeInput, GetCrosshairCode().c_str());
-
-            wchar_t labelBuf[32];
-            swprintf(labelBuf, 32, L"Length: %d", g_len); SetWindowText(hLabelLen, labelBuf);
-            swprintf(labelBuf, 32, L"Thickness: %d", g_thickness); SetWindowText(hLabelThickness, labelBuf);
-            swprintf(labelBuf, 32, L"Outline: %d", g_outlineThickness); SetWindowText(hLabelOutline, labelBuf);
-            swprintf(labelBuf, 32, L"Gap: %d", g_gap); SetWindowText(hLabelGap, labelBuf);
-
-            InvalidateRect(hwndMain, NULL, TRUE);
-            InvalidateRect(hwnd, NULL, TRUE); // refresh toggle button text
+            g_crosshair = settings;
+            ScheduleRepaint(kAllCrosshairFields);
+            break;
+        }
+        case 7: { // Pick a shared code list and import it in the background
+            wchar_t file[MAX_PATH] = L"";
+            OPENFILENAME ofn = {};
+            ofn.lStructSize = sizeof(ofn);
+            ofn.hwndOwner = hwnd;
+            ofn.lpstrFilter = L"Crosshair code lists (*.txt)\0*.txt\0All files (*.*)\0*.*\0";
+            ofn.lpstrFile = file;
+            ofn.nMaxFile = MAX_PATH;
+            ofn.Flags = OFN_FILEMUSTEXIST | OFN_PATHMUSTEXIST | OFN_NOCHANGEDIR;
+            if (!GetOpenFileName(&ofn)) break;
+            if (!g_codeImport.Start(file, [](void*) { PostMessage(hwndMain, WM_APP_CODES_IMPORTED, 0, 0); }, nullptr)) break;
+            EnableWindow(hBtnImportCodes, FALSE); // Until the result is in
+            EnableWindow(hBtnUseClosest, FALSE);
+            SetWindowText(hLabelImport, L"Importing...");
+            break;
+        }
+        case 8: { // Switch to the closest crosshair in the last imported list
+            if (g_codeSuggestion == CrosshairCodeLibrary::npos) break;
+            g_crosshair = g_codeLibrary.At(g_codeSuggestion);
+            ScheduleRepaint(kAllCrosshairFields);
+            EnableWindow(hBtnUseClosest, FALSE);
             break;
         }
         }
         break;
 
     case WM_HSCROLL: {
-        int pos = (int)SendMessage((HWND)lParam, TBM_GETPOS, 0, 0);
-        wchar_t buf[32];
-        // Update crosshair code when sliders change
-        SetWindowText(hCrosshairCodeInput, GetCrosshairCode().c_str());
+        // Only record the new value here; labels, code box and overlay are updated together by the scheduler
+        const int pos = (int)SendMessage((HWND)lParam, TBM_GETPOS, 0, 0);
+        int* value = nullptr;
+        CrosshairField field = CrosshairField::Length;
         switch (GetDlgCtrlID((HWND)lParam)) {
-        case 101: g_len = pos; swprintf(buf, 32, L"Length: %d", g_len); SetWindowText(hLabelLen, buf); break;
-        case 102: g_thickness = pos; swprintf(buf, 32, L"Thickness: %d", g_thickness); SetWindowText(hLabelThickness, buf); break;
-        case 103: g_outlineThickness = pos; swprintf(buf, 32, L"Outline: %d", g_outlineThickness); SetWindowText(hLabelOutline, buf); break;
-        case 104: g_gap = pos; swprintf(buf, 32, L"Gap: %d", g_gap); SetWindowText(hLabelGap, buf); break;
+        case 101: value = &g_crosshair.len; field = CrosshairField::Length; break;
+        case 102: value = &g_crosshair.thickness; field = CrosshairField::Thickness; break;
+        case 103: value = &g_crosshair.outlineThickness; field = CrosshairField::OutlineThickness; break;
+        case 104: value = &g_crosshair.gap; field = CrosshairField::GapSize; break;
+        case 105: value = &g_crosshair.rotation; field = CrosshairField::Rotation; break;
+        case 106: value = &g_crosshair.circleRadius; field = CrosshairField::CircleRadius; break;
         }
-        InvalidateRect(hwndMain, NULL, TRUE);
+        if (!value || *value == pos) break; // Thumb notifications that did not change the value
+
+        if (!g_sliderTraceStart) g_sliderTraceStart = TraceBegin(); // Moves merged into one frame share one span
+        *value = pos;
+        ScheduleRepaint(CrosshairFieldBit(field));
         break;
     }
 
@@ -281,8 +787,8 @@ LRESULT CALLBACK SettingsProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         HDC hdcStatic = (HDC)wParam;
         SetTextColor(hdcStatic, RGB(255, 255, 255));
         SetBkColor(hdcStatic, RGB(0, 0, 0));
-        // Return a brush matching background (created here, but system will free on WM_DESTROY of control)
-        return (INT_PTR)CreateSolidBrush(RGB(0, 0, 0));
+        // Return the shared brush matching the background; the caller does not free it
+        return (INT_PTR)ToBrush(g_settingsBackground.Get());
     }
 
     case WM_CTLCOLORBTN: {
@@ -298,27 +804,27 @@ LRESULT CALLBACK SettingsProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         LPDRAWITEMSTRUCT lpDIS = (LPDRAWITEMSTRUCT)lParam;
         if (!lpDIS) break;
 
-        // Background fill
-        HBRUSH hBrush = CreateSolidBrush(RGB(30, 30, 30));
+        // Background fill, with the shared button brush
+        HBRUSH hBrush = ToBrush(g_buttonBrush.Get());
         FillRect(lpDIS->hDC, &lpDIS->rcItem, hBrush);
-        DeleteObject(hBrush);
 
         // Draw rounded rectangle borderless (we use NULL_PEN)
         HPEN hPen = (HPEN)GetStockObject(NULL_PEN);
         HGDIOBJ oldPen = SelectObject(lpDIS->hDC, hPen);
-        HBRUSH hOldBrush = (HBRUSH)SelectObject(lpDIS->hDC, CreateSolidBrush(RGB(30, 30, 30)));
+        HBRUSH hOldBrush = (HBRUSH)SelectObject(lpDIS->hDC, hBrush);
         RoundRect(lpDIS->hDC, lpDIS->rcItem.left, lpDIS->rcItem.top, lpDIS->rcItem.right, lpDIS->rcItem.bottom, 10, 10);
         SelectObject(lpDIS->hDC, oldPen);
         SelectObject(lpDIS->hDC, hOldBrush);
 
         // Text: center and vertical align
         SetBkMode(lpDIS->hDC, TRANSPARENT);
-        SetTextColor(lpDIS->hDC, RGB(255, 255, 255));
+        SetTextColor(lpDIS->hDC, (lpDIS->itemState & ODS_DISABLED) ? RGB(110, 110, 110) : RGB(255, 255, 255));
 
-        if (lpDIS->CtlID == 2) { // Toggle Button Text
-            wchar_t buf[64];
-            swprintf(buf, 64, L"Toggle Center Dot: %s", g_centerDot ? L"ON" : L"OFF");
-            DrawText(lpDIS->hDC, buf, -1, &lpDIS->rcItem, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+        if (lpDIS->CtlID == 2) { // Toggle Button Text, as formatted by the last sync
+            DrawText(lpDIS->hDC, g_settingsPanel.Text(SettingsControl::CenterDotButton), -1, &lpDIS->rcItem, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+        }
+        else if (lpDIS->CtlID == 6) {
+            DrawText(lpDIS->hDC, g_settingsPanel.Text(SettingsControl::TStyleButton), -1, &lpDIS->rcItem, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
         }
         else {
             wchar_t buf[64];
@@ -329,28 +835,50 @@ LRESULT CALLBACK SettingsProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
         return TRUE;
     }
 
+    case WM_CLOSE:
+        // Built once at startup: closing only hides it, so the hotkey never has to build it again
+        ShowWindow(hwnd, SW_HIDE);
+        break;
+
+    case WM_DESTROY:
+        // Back to the cache, where the next settings window picks them up again
+        g_buttonBrush.Reset();
+        g_settingsFont.Reset();
+        hwndSettings = NULL;
+        break;
+
     default: return DefWindowProc(hwnd, msg, wParam, lParam);
     }
     return 0;
 }
 
-// Create and run the settings window modally (blocks until closed)
-void OpenSettingsWindow(HINSTANCE hInstance) {
+// Build the settings window and all its controls, hidden; OpenSettingsWindow shows it.
+// It lives on the overlay thread, so the main message loop drives it.
+void CreateSettingsWindow(HINSTANCE hInstance) {
+    if (hwndSettings && IsWindow(hwndSettings)) return;
+
     INITCOMMONCONTROLSEX icc = { sizeof(icc), ICC_STANDARD_CLASSES | ICC_BAR_CLASSES };
     InitCommonControlsEx(&icc);
 
+    // The controls use fixed pixel positions, so let Windows scale this window instead of the per-monitor-aware overlay
+    const DPI_AWARENESS_CONTEXT previousDpiContext = SetThreadDpiAwarenessContext(DPI_AWARENESS_CONTEXT_SYSTEM_AWARE);
+
+    // The class (and its background brush) is registered once and kept for later windows
     const wchar_t CLASS_NAME[] = L"SettingsWin";
-    WNDCLASS wc = {};
-    wc.lpfnWndProc = SettingsProc;
-    wc.hInstance = hInstance;
-    wc.lpszClassName = CLASS_NAME;
-    wc.hbrBackground = CreateSolidBrush(RGB(0, 0, 0));
-    wc.hIcon = (HICON)LoadImage(hInstance, L"AdrixCH.ico", IMAGE_ICON, 0, 0, LR_LOADFROMFILE | LR_DEFAULTSIZE | LR_SHARED);
-    RegisterClass(&wc);
+    if (!g_settingsBackground) {
+        g_settingsBackground = GdiResource(g_gdiCache, GdiResourceKey::Brush(RGB(0, 0, 0)));
+        WNDCLASS wc = {};
+        wc.lpfnWndProc = SettingsProc;
+        wc.hInstance = hInstance;
+        wc.lpszClassName = CLASS_NAME;
+        wc.hbrBackground = ToBrush(g_settingsBackground.Get());
+        wc.hIcon = g_appIcon;
+        RegisterClass(&wc);
+    }
 
 	// Client window size
     int clientWidth = 325;
-    int clientHeight = 340;
+    int clientHeight = 580;
 
     RECT rc = { 0, 0, clientWidth, clientHeight };
     AdjustWindowRect(&rc, WS_OVERLAPPEDWINDOW & ~WS_MAXIMIZEBOX & ~WS_SIZEBOX, FALSE);
@@ -359,118 +887,250 @@ void OpenSettingsWindow(HINSTANCE hInstance) {
     int winWidth = rc.right - rc.left;
     int winHeight = rc.bottom - rc.top;
 
-    HWND hwndSettings = CreateWindowEx(
+    hwndSettings = CreateWindowEx(
         WS_EX_TOPMOST, CLASS_NAME, L"AdrixCH - Settings",
         WS_OVERLAPPEDWINDOW & ~WS_MAXIMIZEBOX & ~WS_SIZEBOX,
         200, 200, winWidth, winHeight,
         NULL, NULL, hInstance, NULL
     );
 
-    // Create a readable font for controls
-    g_hFont = CreateFont(18, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
-        ANSI_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
-        CLEARTYPE_QUALITY, VARIABLE_PITCH, L"Segoe UI");
+    // A readable font for controls and the owner-drawn button background, shared with earlier windows
+    g_settingsFont = GdiResource(g_gdiCache, GdiResourceKey::Font("Segoe UI", 18, FW_NORMAL));
+    g_buttonBrush = GdiResource(g_gdiCache, GdiResourceKey::Brush(RGB(30, 30, 30)));
 
     // Buttons (owner-drawn)
     hBtnClose = CreateWindow(L"BUTTON", L"Close", WS_VISIBLE | WS_CHILD | BS_OWNERDRAW, 10, 10, 147, 30, hwndSettings, (HMENU)1, hInstance, NULL);
     hBtnCenter = CreateWindow(L"BUTTON", L"Toggle Center Dot", WS_VISIBLE | WS_CHILD | BS_OWNERDRAW, 167, 10, 147, 30, hwndSettings, (HMENU)2, hInstance, NULL);
     hBtnFill = CreateWindow(L"BUTTON", L"Fill Color", WS_VISIBLE | WS_CHILD | BS_OWNERDRAW, 10, 50, 147, 30, hwndSettings, (HMENU)3, hInstance, NULL);
     hBtnOutline = CreateWindow(L"BUTTON", L"Outline Color", WS_VISIBLE | WS_CHILD | BS_OWNERDRAW, 167, 50, 147, 30, hwndSettings, (HMENU)4, hInstance, NULL);
-    hBtnLoadCode = CreateWindow(L"BUTTON", L"Load Crosshair", WS_VISIBLE | WS_CHILD | BS_OWNERDRAW, 220, 300, 95, 30, hwndSettings, (HMENU)5, hInstance, NULL);
+    hBtnLoadCode = CreateWindow(L"BUTTON", L"Load Crosshair", WS_VISIBLE | WS_CHILD | BS_OWNERDRAW, 220, 450, 95, 30, hwndSettings, (HMENU)5, hInstance, NULL);
 
     // Trackbars
     HWND hLen = CreateWindowEx(0, TRACKBAR_CLASS, L"", WS_CHILD | WS_VISIBLE | TBS_AUTOTICKS, 10, 100, 200, 30, hwndSettings, (HMENU)101, hInstance, NULL);
-    SendMessage(hLen, TBM_SETRANGE, TRUE, MAKELONG(2, 50));
-    SendMessage(hLen, TBM_SETPOS, TRUE, g_len);
+    SendMessage(hLen, TBM_SETRANGE, TRUE, MAKELONG(kLengthMin, kLengthMax));
+    SendMessage(hLen, TBM_SETPOS, TRUE, g_crosshair.len);
     hLabelLen = CreateWindow(L"STATIC", L"", WS_CHILD | WS_VISIBLE, 220, 100, 105, 30, hwndSettings, NULL, hInstance, NULL);
 
     HWND hThick = CreateWindowEx(0, TRACKBAR_CLASS, L"", WS_CHILD | WS_VISIBLE | TBS_AUTOTICKS, 10, 150, 200, 30, hwndSettings, (HMENU)102, hInstance, NULL);
-    SendMessage(hThick, TBM_SETRANGE, TRUE, MAKELONG(1, 20));
-    SendMessage(hThick, TBM_SETPOS, TRUE, g_thickness);
+    SendMessage(hThick, TBM_SETRANGE, TRUE, MAKELONG(kThicknessMin, kThicknessMax));
+    SendMessage(hThick, TBM_SETPOS, TRUE, g_crosshair.thickness);
     hLabelThickness = CreateWindow(L"STATIC", L"", WS_CHILD | WS_VISIBLE, 220, 150, 105, 30, hwndSettings, NULL, hInstance, NULL);
 
     HWND hOutline = CreateWindowEx(0, TRACKBAR_CLASS, L"", WS_CHILD | WS_VISIBLE | TBS_AUTOTICKS, 10, 200, 200, 30, hwndSettings, (HMENU)103, hInstance, NULL);
-    SendMessage(hOutline, TBM_SETRANGE, TRUE, MAKELONG(0, 10));
-    SendMessage(hOutline, TBM_SETPOS, TRUE, g_outlineThickness);
+    SendMessage(hOutline, TBM_SETRANGE, TRUE, MAKELONG(kOutlineMin, kOutlineMax));
+    SendMessage(hOutline, TBM_SETPOS, TRUE, g_crosshair.outlineThickness);
     hLabelOutline = CreateWindow(L"STATIC", L"", WS_CHILD | WS_VISIBLE, 220, 200, 105, 30, hwndSettings, NULL, hInstance, NULL);
 
     HWND hGap = CreateWindowEx(0, TRACKBAR_CLASS, L"", WS_CHILD | WS_VISIBLE | TBS_AUTOTICKS, 10, 250, 200, 30, hwndSettings, (HMENU)104, hInstance, NULL);
-    SendMessage(hGap, TBM_SETRANGE, TRUE, MAKELONG(0, 50));
-    SendMessage(hGap, TBM_SETPOS, TRUE, g_gap);
+    SendMessage(hGap, TBM_SETRANGE, TRUE, MAKELONG(kGapMin, kGapMax));
+    SendMessage(hGap, TBM_SETPOS, TRUE, g_crosshair.gap);
     hLabelGap = CreateWindow(L"STATIC", L"", WS_CHILD | WS_VISIBLE, 220, 250, 105, 30, hwndSettings, NULL, hInstance, NULL);
 
-    hCrosshairCodeInput = CreateWindowEx(WS_EX_CLIENTEDGE, L"EDIT", L"", WS_CHILD | WS_VISIBLE | ES_AUTOHSCROLL, 10, 300, 200, 30, hwndSettings, (HMENU)201 ,hInstance, NULL);
+    HWND hRotation = CreateWindowEx(0, TRACKBAR_CLASS, L"", WS_CHILD | WS_VISIBLE, 10, 300, 200, 30, hwndSettings, (HMENU)105, hInstance, NULL);
+    SendMessage(hRotation, TBM_SETRANGE, TRUE, MAKELONG(kRotationMin, kRotationMax));
+    hLabelRotation = CreateWindow(L"STATIC", L"", WS_CHILD | WS_VISIBLE, 220, 300, 105, 30, hwndSettings, NULL, hInstance, NULL);
 
-    HWND controls[] = { hBtnClose, hBtnCenter, hBtnFill, hBtnOutline, hBtnLoadCode, hLabelLen, hLabelThickness, hLabelOutline, hLabelGap, hLen, hThick, hOutline, hGap, hCrosshairCodeInput };
-    for (HWND ctrl : controls) { SendMessage(ctrl, WM_SETFONT, (WPARAM)g_hFont, TRUE); }
+    HWND hCircle = CreateWindowEx(0, TRACKBAR_CLASS, L"", WS_CHILD | WS_VISIBLE | TBS_AUTOTICKS, 10, 350, 200, 30, hwndSettings, (HMENU)106, hInstance, NULL);
+    SendMessage(hCircle, TBM_SETRANGE, TRUE, MAKELONG(kCircleRadiusMin, kCircleRadiusMax));
+    hLabelCircle = CreateWindow(L"STATIC", L"", WS_CHILD | WS_VISIBLE, 220, 350, 105, 30, hwndSettings, NULL, hInstance, NULL);
 
-    wchar_t buf[32];
-    swprintf(buf, 32, L"Length: %d", g_len); SetWindowText(hLabelLen, buf);
-    swprintf(buf, 32, L"Thickness: %d", g_thickness); SetWindowText(hLabelThickness, buf);
-    swprintf(buf, 32, L"Outline: %d", g_outlineThickness); SetWindowText(hLabelOutline, buf);
-    swprintf(buf, 32, L"Gap: %d", g_gap); SetWindowText(hLabelGap, buf);
+    hBtnTStyle = CreateWindow(L"BUTTON", L"T-Style", WS_VISIBLE | WS_CHILD | BS_OWNERDRAW, 10, 400, 304, 30, hwndSettings, (HMENU)6, hInstance, NULL);
 
-    SetWindowText(hCrosshairCodeInput, GetCrosshairCode().c_str());
+    hCrosshairCodeInput = CreateWindowEx(WS_EX_CLIENTEDGE, L"EDIT", L"", WS_CHILD | WS_VISIBLE | ES_AUTOHSCROLL, 10, 450, 200, 30, hwndSettings, (HMENU)201 ,hInstance, NULL);
 
-    ShowWindow(hwndSettings, SW_SHOW); UpdateWindow(hwndSettings);
+    hBtnImportCodes = CreateWindow(L"BUTTON", L"Import Code List...", WS_VISIBLE | WS_CHILD | BS_OWNERDRAW, 10, 490, 147, 30, hwndSettings, (HMENU)7, hInstance, NULL);
+    hBtnUseClosest = CreateWindow(L"BUTTON", L"Use Closest", WS_VISIBLE | WS_CHILD | WS_DISABLED | BS_OWNERDRAW, 167, 490, 147, 30, hwndSettings, (HMENU)8, hInstance, NULL);
+    hLabelImport = CreateWindow(L"STATIC", L"", WS_CHILD | WS_VISIBLE, 10, 530, 304, 40, hwndSettings, NULL, hInstance, NULL);
+    if (g_codeImport.Running()) { EnableWindow(hBtnImportCodes, FALSE); SetWindowText(hLabelImport, L"Importing..."); }
 
-    // Message loop for settings window (modal-like behavior)
-    MSG msg;
-    while (IsWindow(hwndSettings) && GetMessage(&msg, NULL, 0, 0)) { TranslateMessage(&msg); DispatchMessage(&msg); }
+    HWND controls[] = { hBtnClose, hBtnCenter, hBtnFill, hBtnOutline, hBtnLoadCode, hBtnTStyle, hLabelLen, hLabelThickness, hLabelOutline, hLabelGap,
+        hLabelRotation, hLabelCircle, hLen, hThick, hOutline, hGap, hRotation, hCircle, hCrosshairCodeInput, hBtnImportCodes, hBtnUseClosest, hLabelImport };
+    for (HWND ctrl : controls) { SendMessage(ctrl, WM_SETFONT, (WPARAM)ToFont(g_settingsFont.Get()), TRUE); }
+
+    // The new controls show nothing yet; the first sync fills in every one of them
+    g_settingsPanel.Reset();
+    SetThreadDpiAwarenessContext(previousDpiContext);
 }
 
-// Background thread: listens for F12 to open settings window
-void KeyCheckThread(HINSTANCE hInstance) {
-    while (true) {
-        if (GetAsyncKeyState(VK_F12) & 0x8000) { OpenSettingsWindow(hInstance); Sleep(500); /* simple debounce to avoid rapid repeated opens */ } Sleep(50);
+// Show the settings window (building it first if startup has not got that far) and bring it to the front
+void OpenSettingsWindow(HINSTANCE hInstance) {
+    if (!hwndSettings || !IsWindow(hwndSettings)) CreateSettingsWindow(hInstance);
+    if (!hwndSettings) return;
+
+    // Labels, sliders and the code box catch up with whatever changed while it was hidden, before the first paint
+    ShowWindow(hwndSettings, SW_SHOW);
+    SyncSettingsWindow();
+    UpdateWindow(hwndSettings);
+    SetForegroundWindow(hwndSettings);
+}
+
+// Push changed settings fields into the sliders, labels and code box of the settings window (if shown;
+// a hidden window catches up when it is shown again)
+void SyncSettingsWindow(uint32_t fields) {
+    if (!hwndSettings || !IsWindowVisible(hwndSettings) || !fields) return;
+
+    // Only controls whose text actually changed get new text; a label changes exactly when its slider's value does
+    const uint32_t changed = g_settingsPanel.Update(g_crosshair, fields);
+    if (!changed) return;
+
+    // Update Slider & Labels
+    struct { SettingsControl control; int id; HWND label; int value; } const sliders[] = {
+        { SettingsControl::LengthLabel, 101, hLabelLen, g_crosshair.len },
+        { SettingsControl::ThicknessLabel, 102, hLabelThickness, g_crosshair.thickness },
+        { SettingsControl::OutlineLabel, 103, hLabelOutline, g_crosshair.outlineThickness },
+        { SettingsControl::GapLabel, 104, hLabelGap, g_crosshair.gap },
+        { SettingsControl::RotationLabel, 105, hLabelRotation, g_crosshair.rotation },
+        { SettingsControl::CircleLabel, 106, hLabelCircle, g_crosshair.circleRadius },
+    };
+    for (const auto& slider : sliders) {
+        if (!(changed & SettingsControlBit(slider.control))) continue;
+        SendMessage(GetDlgItem(hwndSettings, slider.id), TBM_SETPOS, TRUE, slider.value);
+        SetWindowText(slider.label, g_settingsPanel.Text(slider.control));
     }
+
+    // Update code string shown to user, from the settings as they are now
+    if (changed & SettingsControlBit(SettingsControl::CodeBox)) SetWindowText(hCrosshairCodeInput, g_settingsPanel.Text(SettingsControl::CodeBox));
+
+    // Redraw just the toggle buttons whose caption changed
+    if (changed & SettingsControlBit(SettingsControl::CenterDotButton)) InvalidateRect(hBtnCenter, NULL, TRUE);
+    if (changed & SettingsControlBit(SettingsControl::TStyleButton)) InvalidateRect(hBtnTStyle, NULL, TRUE);
+}
+
+// Load hotkey bindings and start listening; the hook thread only wakes up on key transitions
+void StartHotkeys() {
+    struct { HotkeyAction action; const char* key; const char* fallback; } const defaults[] = {
+        { HotkeyAction::OpenSettings, "OpenSettings", "F12" },
+        { HotkeyAction::NextProfile, "NextProfile", "Ctrl+F11" },
+        { HotkeyAction::PreviousProfile, "PreviousProfile", "Ctrl+F10" },
+        { HotkeyAction::SaveProfile, "SaveProfile", "Ctrl+F9" },
+        { HotkeyAction::DumpTrace, "DumpTrace", "Ctrl+F8" },
+        { HotkeyAction::AnimationHold, "AnimationHold", "Ctrl+F7" },
+    };
+
+    // [Hotkeys] entries override the defaults; an unparsable entry falls back to the default
+    HotkeyBinding bindings[sizeof(defaults) / sizeof(defaults[0])];
+    size_t count = 0;
+    for (const auto& hotkey : defaults) {
+        HotkeyBinding& binding = bindings[count];
+        binding.action = hotkey.action;
+        if (ParseHotkey(g_settingsStore.Get("Hotkeys", hotkey.key, hotkey.fallback), binding.key, binding.modifiers) ||
+            ParseHotkey(hotkey.fallback, binding.key, binding.modifiers)) {
+            count++;
+        }
+    }
+
+    g_hotkeys.SetBindings(bindings, count);
+    g_hotkeys.SetWakeCallback([](void*) { PostMessage(hwndMain, WM_APP_HOTKEY, 0, 0); }, nullptr);
+    g_inputSource.Start(g_hotkeys, bindings, count);
 }
 
 int WINAPI WinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPSTR lpCmdLine, _In_ int nCmdShow) {
-    const wchar_t CLASS_NAME[] = L"AdrixCH";
+    // Startup phases count from process creation, so loading and static initialization are included
+    uint64_t processStartNs = TraceNow();
+    FILETIME created, exited, kernelTime, userTime, now;
+    if (GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernelTime, &userTime)) {
+        GetSystemTimePreciseAsFileTime(&now);
+        const uint64_t sinceCreatedNs = ((((uint64_t)now.dwHighDateTime << 32) | now.dwLowDateTime) -
+            (((uint64_t)created.dwHighDateTime << 32) | created.dwLowDateTime)) * 100;
+        if (sinceCreatedNs < processStartNs) processStartNs -= sinceCreatedNs;
+    }
+    TraceStartupBegin(processStartNs);
+    g_hInstance = hInstance;
+
+    // Overlay positions and sizes are in physical pixels on every monitor
+    SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2);
 
-    // Resolve AppData path and INI file location
+    // Resolve AppData path and the files in it; ensure the configuration directory exists
     wchar_t appData[MAX_PATH];
     SHGetFolderPathW(NULL, CSIDL_APPDATA, NULL, 0, appData);
-    iniPath = std::wstring(appData) + L"\\AdrixCH\\crosshair_settings.ini";
-
-    // Ensure configuration directory exists
-    CreateDirectoryW((std::wstring(appData) + L"\\AdrixCH").c_str(), NULL);
-
-    // Load persisted settings (if any)
+    const std::wstring configDir = std::wstring(appData) + L"\\AdrixCH";
+    CreateDirectoryW(configDir.c_str(), NULL);
+    iniPath = configDir + L"\\crosshair_settings.ini";
+    tracePath = configDir + L"\\trace.txt";
+    profilesPath = configDir + L"\\profiles.axpl";
+    TraceStartupMark(StartupPhase::Paths);
+
+    // Load persisted settings (if any) in one streaming pass; this also decides whether tracing is on, so the
+    // span is closed afterwards
+    const uint64_t loadStart = TraceNow();
     LoadCrosshairSettings();
+    TraceEnd(TraceSpan::SettingsLoad, loadStart);
+    TraceStartupMark(StartupPhase::Settings);
 
-    // Register overlay window class
+    // Register overlay window class, with the icon embedded in the executable rather than read from disk
+    g_appIcon = (HICON)LoadImage(hInstance, MAKEINTRESOURCE(IDI_ICON1), IMAGE_ICON, 0, 0, LR_DEFAULTSIZE | LR_SHARED);
     WNDCLASSEX wc = {};
     wc.cbSize = sizeof(WNDCLASSEX);
     wc.lpfnWndProc = WndProc;
     wc.hInstance = hInstance;
-    wc.lpszClassName = CLASS_NAME;
+    wc.lpszClassName = OVERLAY_CLASS_NAME;
     wc.hbrBackground = (HBRUSH)GetStockObject(NULL_BRUSH);
-    
-    // Attempt to load icon from file; if missing, LoadImage returns NULL and system defaults apply
-    wc.hIcon = (HICON)LoadImage(hInstance, L"AdrixCH.ico", IMAGE_ICON, 0, 0, LR_LOADFROMFILE | LR_DEFAULTSIZE | LR_SHARED);
-    wc.hIconSm = (HICON)LoadImage(hInstance, L"AdrixCH.ico", IMAGE_ICON, 64, 64, LR_LOADFROMFILE | LR_SHARED);
+    wc.hIcon = g_appIcon;
+    wc.hIconSm = (HICON)LoadImage(hInstance, MAKEINTRESOURCE(IDI_ICON1), IMAGE_ICON, GetSystemMetrics(SM_CXSMICON), GetSystemMetrics(SM_CYSMICON), LR_SHARED);
     RegisterClassEx(&wc);
 
-    // Create an always-on-top, layered, transparent window that covers the screen
-    hwndMain = CreateWindowEx(
-        WS_EX_LAYERED | WS_EX_TRANSPARENT | WS_EX_TOPMOST | WS_EX_TOOLWINDOW,
-        CLASS_NAME, L"AdrixCH", WS_POPUP,
-        0, 0, GetSystemMetrics(SM_CXSCREEN), GetSystemMetrics(SM_CYSCREEN),
-        NULL, NULL, hInstance, NULL
-    );
+    // Create the first overlay window; UpdateOverlay places and shows it, and adds one per further selected monitor
+    hwndMain = CreateOverlayWindow();
+    g_overlays.push_back({ hwndMain });
+    g_animationTimer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!g_animationTimer) g_animationTimer = CreateWaitableTimerW(NULL, FALSE, NULL); // Before Windows 10 1803
+
+    UpdateRepaintInterval();
+    TraceStartupMark(StartupPhase::Overlay);
+
+    // Place and present the first crosshair now rather than from the message loop: this ends the critical path
+    UpdateOverlay();
+    TraceStartupMark(StartupPhase::FirstFrame);
 
-    // Use color-key transparency for the background (RGB(0,0,0) will be transparent)
-    SetLayeredWindowAttributes(hwndMain, RGB(0, 0, 0), 255, LWA_COLORKEY | LWA_ALPHA);
-    ShowWindow(hwndMain, SW_SHOW);
+    // Everything below can wait until the crosshair is up
+    UpdateAdaptiveTimer();
 
-    // Start key-check thread to open settings with F12
-    std::thread(KeyCheckThread, hInstance).detach();
+    // Listen for the settings hotkey (F12 by default)
+    StartHotkeys();
 
-    // Standard message loop for main window
+    // Pick up edits other programs make to the INI file; one message per burst of notifications
+    g_settingsWatcher.Start(iniPath, [](void*) {
+        if (!g_settingsChangePosted.exchange(true)) PostMessage(hwndMain, WM_APP_SETTINGS_CHANGED, 0, 0);
+    }, nullptr);
+
+    // Accept commands from external tools, only if asked to: any process in the session could send them
+    if (g_settingsStore.GetFlag("Control", "Enabled", false)) g_control.Create();
+
+    // Map the profile library; this only reads its header, however many profiles it holds
+    g_profiles.Open(profilesPath);
+    TraceStartupMark(StartupPhase::Services);
+
+    // Build the settings window once, hidden: the hotkey then only has to show it
+    CreateSettingsWindow(hInstance);
+    TraceStartupMark(StartupPhase::SettingsWindow);
+
+    // Message loop for the overlay and the settings window, which also wakes up when a client rings the control
+    // channel's doorbell or an animation step comes due (both wait while a modal loop such as a message box runs)
     MSG msg;
-    while (GetMessage(&msg, NULL, 0, 0)) { TranslateMessage(&msg); DispatchMessage(&msg); }
+    HANDLE waits[2];
+    DWORD waitCount = 0;
+    const HANDLE controlEvent = g_control.IsOpen() ? g_control.WakeEvent() : NULL;
+    if (controlEvent) waits[waitCount++] = controlEvent;
+    if (g_animationTimer) waits[waitCount++] = g_animationTimer;
+    bool running = true;
+    while (running) {
+        const DWORD wake = MsgWaitForMultipleObjectsEx(waitCount, waits, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+        if (wake < WAIT_OBJECT_0 + waitCount) {
+            if (waits[wake - WAIT_OBJECT_0] == controlEvent) DrainControlChannel();
+            else StepAnimation();
+        }
+        while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+            if (msg.message == WM_QUIT) { running = false; break; }
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+    }
+
+    g_control.Close();
+    if (g_animationTimer) CloseHandle(g_animationTimer);
+    g_codeImport.Cancel();
+    g_inputSource.Stop();
+    g_settingsWatcher.Stop();
 
     return 0;
 }
\ No newline at end of file
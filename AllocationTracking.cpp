@@ -0,0 +1,79 @@
+// AdrixCH - Heap allocation counting: counting replacements of the global operator new and delete.
+
+#include "AllocationTracking.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+
+std::atomic<uint64_t> g_heapAllocations{ 0 };
+thread_local uint64_t t_heapAllocations = 0; // Constant-initialized, so safe to touch from inside operator new
+
+void* CountedAllocate(size_t size) noexcept {
+    g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    t_heapAllocations++;
+    return std::malloc(size ? size : 1);
+}
+
+void* CountedAllocateAligned(size_t size, std::align_val_t alignment) noexcept {
+    g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    t_heapAllocations++;
+    const size_t align = (size_t)alignment;
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, align);
+#else
+    // aligned_alloc wants a whole number of alignments
+    return std::aligned_alloc(align, (size + align - 1) / align * align);
+#endif
+}
+
+void FreeAligned(void* p) noexcept {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+uint64_t HeapAllocationCount() {
+    return g_heapAllocations.load(std::memory_order_relaxed);
+}
+
+uint64_t ThreadHeapAllocationCount() {
+    return t_heapAllocations;
+}
+
+void* operator new(size_t size) {
+    if (void* p = CountedAllocate(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* p = CountedAllocateAligned(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return CountedAllocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return CountedAllocateAligned(size, alignment); }
+void operator delete(void* p, std::align_val_t) noexcept { FreeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { FreeAligned(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { FreeAligned(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { FreeAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(p); }
@@ -0,0 +1,16 @@
+// AdrixCH - Heap allocation counting.
+//
+// Linking AllocationTracking.cpp replaces the global operator new and delete with versions on top of malloc
+// that count every allocation, process-wide and per thread. Once warm, the overlay thread is meant to handle
+// slider moves, code loads, profile switches and paints without allocating at all; the benchmark asserts
+// that, and the trace dump reports the count so a regression also shows up in a running overlay.
+
+#pragma once
+
+#include <cstdint>
+
+// Allocations made through operator new since the process started, by every thread
+uint64_t HeapAllocationCount();
+
+// The same, by the calling thread only (unaffected by what other threads do meanwhile)
+uint64_t ThreadHeapAllocationCount();
@@ -0,0 +1,491 @@
+// AdrixCH - Microbenchmarks for the rendering and code hot paths.
+// Usage: adrixch_bench [filter]   (runs every benchmark whose name contains filter)
+//
+// Only timings: the results are checked by adrixch_tests (Tests.cpp), which uses the same inputs. Setup that
+// cannot go ahead (a temporary file that cannot be written, a channel that cannot be opened) still exits non-zero.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AdaptiveContrast.h"
+#include "AllocationTracking.h"
+#include "CodeLibrary.h"
+#include "ControlChannel.h"
+#include "CrosshairAnimation.h"
+#include "CrosshairCode.h"
+#include "CrosshairGeometry.h"
+#include "CrosshairRaster.h"
+#include "CrosshairSettings.h"
+#include "CrosshairShapes.h"
+#include "DisplayLayout.h"
+#include "GdiResourceCache.h"
+#include "HotkeyDispatcher.h"
+#include "ProfileLibrary.h"
+#include "RepaintScheduler.h"
+#include "Seqlock.h"
+#include "SettingsPanel.h"
+#include "SettingsStore.h"
+#include "SpriteCache.h"
+#include "TestSupport.h"
+#include "Trace.h"
+
+// Keep results observable so the optimizer cannot drop the measured work
+static volatile uint64_t g_sink;
+
+struct BenchmarkResult {
+    uint64_t ops;
+    double nsPerOp;
+    double allocsPerOp;
+};
+
+// Run body(i) for i in [0, ops) once to warm up, then timed; body returns a value folded into the sink
+template <typename Body>
+static BenchmarkResult Measure(uint64_t ops, Body&& body) {
+    uint64_t sink = 0;
+    for (uint64_t i = 0; i < ops && i < 1024; i++) sink += body(i);
+
+    const uint64_t allocsBefore = HeapAllocationCount();
+    const auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < ops; i++) sink += body(i);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const uint64_t allocs = HeapAllocationCount() - allocsBefore;
+
+    g_sink = sink;
+    const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    return { ops, ns / (double)ops, (double)allocs / (double)ops };
+}
+
+static const char* g_filter = nullptr;
+
+static bool Selected(const char* name) {
+    return !g_filter || std::strstr(name, g_filter);
+}
+
+template <typename Body>
+static void Run(const char* name, uint64_t ops, Body&& body) {
+    if (!Selected(name)) return;
+    const BenchmarkResult r = Measure(ops, body);
+    std::printf("%-32s %12llu %12.1f %12.3f\n", name, (unsigned long long)r.ops, r.nsPerOp, r.allocsPerOp);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) g_filter = argv[1];
+
+    const std::vector<CrosshairSettings> range = SliderRange();
+    const uint64_t n = range.size();
+
+    std::vector<std::wstring> codes, legacyCodes;
+    std::vector<std::string> narrowCodes;
+    codes.reserve(n);
+    legacyCodes.reserve(n);
+    narrowCodes.reserve(n);
+    for (const CrosshairSettings& s : range) {
+        codes.push_back(GetCrosshairCode(s));
+        narrowCodes.emplace_back(codes.back().begin(), codes.back().end());
+
+        wchar_t legacy[32];
+        swprintf(legacy, 32, L"%02d%02d%02d%02d%d-%06X-%06X", s.len, s.gap, s.thickness, s.outlineThickness,
+            s.centerDot ? 1 : 0, s.fillColor, s.outlineColor);
+        legacyCodes.emplace_back(legacy);
+    }
+
+    std::vector<std::string> values;
+    values.reserve(n);
+    for (const CrosshairSettings& s : range) {
+        char buf[16];
+        FormatCrosshairField(s, CrosshairField::FillColor, buf, 16);
+        values.emplace_back(buf);
+    }
+
+    std::printf("%-32s %12s %12s %12s\n", "benchmark", "ops", "ns/op", "allocs/op");
+    Run("geometry/rects+bounds", n, [&](uint64_t i) {
+        CrosshairRect rects[kMaxCrosshairRects];
+        const int count = ComputeCrosshairRects(range[i], rects);
+        const CrosshairRect bounds = ComputeCrosshairBounds(range[i]);
+        return (uint64_t)(count + bounds.right - bounds.left);
+    });
+
+    CrosshairSprite sprite;
+    Run("raster/sweep", n, [&](uint64_t i) {
+        RasterizeCrosshair(range[i], sprite);
+        return (uint64_t)sprite.pixels[(size_t)sprite.originY * sprite.width + sprite.originX];
+    });
+
+    CrosshairSprite largest;
+    CrosshairSettings big = range.back();
+    Run("raster/largest", 2000, [&](uint64_t) {
+        RasterizeCrosshair(big, largest);
+        return (uint64_t)largest.pixels.size();
+    });
+
+    SpriteCache cache;
+    Run("sprite-cache/hit", 1000000, [&](uint64_t i) {
+        return (uint64_t)cache.Get(range[i & 31]).width;
+    });
+    Run("sprite-cache/sweep", n / 8, [&](uint64_t i) {
+        return (uint64_t)cache.Get(range[i * 8]).width;
+    });
+
+    Run("code/encode", n, [&](uint64_t i) {
+        wchar_t buf[kCrosshairCodeBufferSize];
+        return (uint64_t)EncodeCrosshairCode(range[i], buf, kCrosshairCodeBufferSize);
+    });
+    Run("code/encode-wstring", n, [&](uint64_t i) {
+        return (uint64_t)GetCrosshairCode(range[i]).size();
+    });
+    Run("code/decode", n, [&](uint64_t i) {
+        CrosshairSettings s;
+        return (uint64_t)DecodeCrosshairCode(codes[i], s) + (uint64_t)s.len;
+    });
+    Run("code/decode-legacy", n, [&](uint64_t i) {
+        CrosshairSettings s;
+        return (uint64_t)DecodeCrosshairCode(legacyCodes[i], s) + (uint64_t)s.len;
+    });
+    Run("code/decode-mutated", n, [&](uint64_t i) {
+        // One corrupted character per code: exercises the reject paths
+        char buf[kCrosshairCodeBufferSize];
+        std::memcpy(buf, narrowCodes[i].data(), narrowCodes[i].size());
+        buf[i % kCrosshairCodeLength] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ"[(i * 7) & 31];
+        CrosshairSettings s = range[i];
+        return (uint64_t)DecodeCrosshairCode(std::string_view(buf, kCrosshairCodeLength), s);
+    });
+
+    Run("settings/parse-field", n, [&](uint64_t i) {
+        CrosshairSettings s;
+        ParseCrosshairField(s, CrosshairField::FillColor, values[i]);
+        return (uint64_t)s.fillColor;
+    });
+    Run("settings/format-field", n, [&](uint64_t i) {
+        char buf[16];
+        return (uint64_t)FormatCrosshairField(range[i], CrosshairField::OutlineColor, buf, 16);
+    });
+
+    // A typical settings file: the crosshair section plus a few other keys
+    SettingsStore store;
+    store.SetCrosshair(range[n / 2]);
+    store.Set("Crosshair", "CompactOverlay", "1");
+    store.Set("Hotkeys", "OpenSettings", "F12");
+    const std::string ini = store.Serialize();
+    Run("settings/load-ini", 100000, [&](uint64_t) {
+        store.LoadFromString(ini);
+        return (uint64_t)store.Crosshair().len;
+    });
+    Run("settings/serialize-ini", 100000, [&](uint64_t i) {
+        store.SetCrosshair(range[i % n]);
+        return (uint64_t)store.Serialize().size();
+    });
+
+    // Profile libraries of very different sizes: opening must cost the same for both
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    for (size_t profiles : { (size_t)10, (size_t)10000 }) {
+        std::vector<ProfileRecord> records;
+        records.reserve(profiles);
+        for (size_t i = 0; i < profiles; i++) records.push_back(ProfileLibrary::MakeRecord("profile-" + std::to_string(i), range[i * 37 % n]));
+        const std::filesystem::path path = dir / ("adrixch_bench_" + std::to_string(profiles) + ".axpl");
+        if (!ProfileLibrary::Write(path, records.data(), records.size())) { std::printf("cannot write %s\n", path.string().c_str()); return 1; }
+
+        ProfileLibrary library;
+        const std::string suffix = "/" + std::to_string(profiles);
+        Run(("profiles/open" + suffix).c_str(), 2000, [&](uint64_t) {
+            library.Open(path);
+            return (uint64_t)library.Count();
+        });
+        Run(("profiles/cycle" + suffix).c_str(), 1000000, [&](uint64_t i) {
+            CrosshairSettings s;
+            ProfileLibrary::ToSettings(*library.At(i % library.Count()), s);
+            return (uint64_t)s.len;
+        });
+        const std::string probe = "profile-" + std::to_string(profiles / 2);
+        Run(("profiles/find" + suffix).c_str(), 1000000, [&](uint64_t) {
+            return (uint64_t)library.SlotOf(library.Find(probe));
+        });
+        library.Close();
+        std::filesystem::remove(path);
+    }
+
+    // Three monitors, two at 150% and a primary at 100%, listed out of order
+    SyntheticTopology topology({
+        { { 1920, 0, 4480, 1440 }, 144, false },
+        { { 0, 0, 1920, 1080 }, 96, true },
+        { { -2560, -200, 0, 1240 }, 144, false },
+    });
+    DisplayLayout layout(topology);
+    std::vector<CrosshairPlacement> placements;
+    Run("layout/place-all", 1000000, [&](uint64_t i) {
+        layout.Place(range[i % n], kAllMonitors, true, placements);
+        return (uint64_t)placements.back().box.right;
+    });
+    Run("layout/place-primary", 1000000, [&](uint64_t i) {
+        layout.Place(range[i % n], kPrimaryMonitorOnly, true, placements);
+        return (uint64_t)placements.back().box.right;
+    });
+    Run("layout/re-enumerate", 1000000, [&](uint64_t i) {
+        layout.Invalidate();
+        layout.Place(range[i % n], kAllMonitors, true, placements);
+        return (uint64_t)placements.back().box.right;
+    });
+
+    LatencyHistogram histogram;
+    Run("trace/histogram-record", 10000000, [&](uint64_t i) {
+        histogram.Record(i * 2654435761u % 100000000);
+        return histogram.Count();
+    });
+    Run("trace/scope-disabled", 10000000, [&](uint64_t i) {
+        ScopedTrace trace(TraceSpan::DrawCrosshair);
+        return i;
+    });
+    SetTraceEnabled(true);
+    Run("trace/scope-enabled", 10000000, [&](uint64_t i) {
+        ScopedTrace trace(TraceSpan::DrawCrosshair);
+        return i;
+    });
+    std::vector<TraceRecord> records;
+    records.reserve(kTraceRingCapacity * kMaxTraceThreads);
+    Run("trace/snapshot", 10000, [&](uint64_t) {
+        TraceSnapshot(records);
+        return (uint64_t)records.size();
+    });
+    SetTraceEnabled(false);
+    TraceReset();
+
+    FakeClock clock;
+    RepaintScheduler scheduler(clock);
+    Run("scheduler/mark-take", 10000000, [&](uint64_t i) {
+        clock.now += 1000;
+        scheduler.MarkChanged(CrosshairFieldBit((CrosshairField)(i % kCrosshairFieldCount)));
+        return (uint64_t)scheduler.TakeDue();
+    });
+
+    Seqlock<CrosshairSettings> snapshot;
+    Run("seqlock/publish", 10000000, [&](uint64_t i) {
+        snapshot.Publish(range[i % n]);
+        return (uint64_t)i;
+    });
+    Run("seqlock/read", 10000000, [&](uint64_t) {
+        return (uint64_t)snapshot.Read().len;
+    });
+
+    const std::vector<uint32_t> noise64 = SyntheticFrame(64, 64, 0x808080, 127, 3);
+    const std::vector<uint32_t> noise256 = SyntheticFrame(256, 256, 0x808080, 127, 3);
+    BackgroundSums backgroundSums;
+    Run("adaptive/sum-64x64", 200000, [&](uint64_t) {
+        SumBackground(noise64.data(), 64, 64, 64, backgroundSums);
+        return backgroundSums.luma;
+    });
+    Run("adaptive/sum-64x64-reference", 20000, [&](uint64_t) {
+        SumBackgroundReference(noise64.data(), 64, 64, 64, backgroundSums);
+        return backgroundSums.luma;
+    });
+    Run("adaptive/sum-256x256", 20000, [&](uint64_t) {
+        SumBackground(noise256.data(), 256, 256, 256, backgroundSums);
+        return backgroundSums.luma;
+    });
+    const std::vector<BackgroundStats> scenes = {
+        FrameStats(SyntheticFrame(64, 64, 0x70A050, 96, 1), 64), FrameStats(SyntheticFrame(64, 64, 0xFFFF00, 8, 2), 64),
+        FrameStats(SyntheticFrame(64, 64, 0x202020, 40, 3), 64), FrameStats(SyntheticFrame(64, 64, 0x80B0F0, 20, 4), 64),
+    };
+    AdaptiveContrast picker;
+    Run("adaptive/stats+update", 1000000, [&](uint64_t i) {
+        BackgroundSums sums = backgroundSums;
+        sums.luma += i & 1;
+        const BackgroundStats stats = ComputeBackgroundStats(sums);
+        return (uint64_t)picker.Update(scenes[i % scenes.size()]) + (uint64_t)stats.meanLuma;
+    });
+
+    // Bulk code import: a million-line shared list streamed from disk and indexed, then searched
+    if (Selected("codes/")) {
+        std::string text;
+        size_t badLines = 0;
+        CodeListText(1000000, 2, text, badLines);
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "adrixch_bench_codes.txt";
+        if (!WriteTextFile(path, text)) {
+            std::printf("cannot write %s\n", path.string().c_str());
+            return 1;
+        }
+
+        CrosshairCodeLibrary corpus;
+        CodeImportStats stats;
+        const auto importStart = std::chrono::steady_clock::now();
+        ImportCrosshairCodes(path, corpus, stats);
+        const auto indexStart = std::chrono::steady_clock::now();
+        corpus.BuildIndex();
+        const auto indexEnd = std::chrono::steady_clock::now();
+        std::filesystem::remove(path);
+        const double importMs = std::chrono::duration<double, std::milli>(indexStart - importStart).count();
+        std::printf("code import: %llu lines, %zu crosshairs, %llu repeats, %llu rejected in %.1f ms (%.0f ns/line); index %.1f ms\n",
+            (unsigned long long)stats.lines, corpus.Size(), (unsigned long long)stats.duplicates, (unsigned long long)stats.rejected, importMs,
+            importMs * 1e6 / (double)stats.lines, std::chrono::duration<double, std::milli>(indexEnd - indexStart).count());
+
+        // Random points anywhere in the settings space are the worst case; real queries are a crosshair someone
+        // is tuning, a few slider steps away from one in the list
+        uint64_t state = 12345;
+        std::vector<CrosshairSettings> queries(4096), tweaked(4096);
+        for (CrosshairSettings& query : queries) query = RandomSettings(state);
+        for (size_t i = 0; i < tweaked.size(); i++) {
+            CrosshairSettings s = corpus.At(i * 211 % corpus.Size());
+            s.len = std::clamp(s.len + (int)(i % 5) - 2, kLengthMin, kLengthMax);
+            s.gap = std::clamp(s.gap + (int)(i % 3) - 1, kGapMin, kGapMax);
+            s.fillColor ^= 0x0F0F0F & (uint32_t)(i * 0x010101);
+            tweaked[i] = s;
+        }
+        Run("codes/nearest-1M-random", 2000, [&](uint64_t i) {
+            return (uint64_t)corpus.Nearest(queries[i & 4095]);
+        });
+        Run("codes/nearest-1M-tweaked", 20000, [&](uint64_t i) {
+            return (uint64_t)corpus.Nearest(tweaked[i & 4095]);
+        });
+        Run("codes/contains-1M", 1000000, [&](uint64_t i) {
+            return (uint64_t)corpus.Contains(i & 1 ? queries[i & 4095] : corpus.At(i % corpus.Size()));
+        });
+        const std::string slice = text.substr(0, 1 << 20);
+        CrosshairCodeLibrary scratch;
+        scratch.Reserve(60000);
+        Run("codes/import-1MiB", 20, [&](uint64_t) {
+            scratch.Clear();
+            CrosshairCodeImporter importer(scratch);
+            importer.Feed(slice);
+            importer.Finish();
+            return (uint64_t)scratch.Size();
+        });
+    }
+
+    MockGdiAllocator gdiAllocator;
+    GdiResourceCache gdiCache(gdiAllocator);
+    const GdiResourceKey gdiKeys[] = {
+        GdiResourceKey::Brush(0x000000), GdiResourceKey::Brush(0x1E1E1E), GdiResourceKey::Font("Segoe UI", 18), GdiResourceKey::Pen(0xFFFFFF, 1),
+    };
+    Run("gdi/acquire+release", 10000000, [&](uint64_t i) {
+        const GdiHandle handle = gdiCache.Acquire(gdiKeys[i & 3]);
+        gdiCache.Release(handle);
+        return (uint64_t)handle;
+    });
+
+    // Settings hot reload when the file did not change: the cost of every notification that was not ours to act on
+    {
+        const std::filesystem::path reloadIni = dir / "adrixch_bench_reload.ini";
+        if (!WriteTextFile(reloadIni, "[Crosshair]\r\nLength=10\r\nGapSize=4\r\n[Adaptive]\r\nEnabled=1\r\n")) {
+            std::printf("cannot write %s\n", reloadIni.string().c_str());
+            return 1;
+        }
+        SettingsStore watched;
+        watched.Load(reloadIni);
+        uint32_t fields = 0;
+        Run("settings/reload-unchanged", 20000, [&](uint64_t) {
+            return (uint64_t)watched.Reload(reloadIni, fields);
+        });
+        std::filesystem::remove(reloadIni);
+    }
+
+    // Control channel round trip through POSIX or Win32 shared memory, against a server that sleeps on the
+    // doorbell between commands the way the overlay sleeps in its message loop
+    if (Selected("control/round-trip")) {
+        ControlChannelServer server;
+        ControlChannelClient client;
+        if (!server.Create("AdrixCH.Bench") || !client.Open("AdrixCH.Bench")) {
+            std::printf("control channel: created %d, opened %d\n", server.IsOpen(), client.IsOpen());
+            return 1;
+        }
+        std::atomic<bool> done{ false };
+        std::thread serverThread([&] {
+            CrosshairSettings settings;
+            ControlCommand received;
+            while (!done.load(std::memory_order_relaxed)) {
+                if (!server.Wait(1000)) continue;
+                while (server.Poll(received)) server.Acknowledge(received.sequence, ApplyControlCommand(received, settings));
+            }
+        });
+        LatencyHistogram roundTrips;
+        uint64_t timeouts = 0;
+        Run("control/round-trip", 20000, [&](uint64_t i) {
+            const uint64_t start = TraceNow();
+            const uint64_t sequence = client.SetField(CrosshairField::GapSize, (int)(i % 8));
+            if (client.WaitForAck(sequence, 1000000) != ControlStatus::Applied) timeouts++;
+            roundTrips.Record(TraceNow() - start);
+            return sequence;
+        });
+        done = true;
+        serverThread.join();
+        std::printf("control round trip: p50 %llu ns, p99 %llu ns, max %llu ns, %llu unacknowledged\n",
+            (unsigned long long)roundTrips.Percentile(50), (unsigned long long)roundTrips.Percentile(99),
+            (unsigned long long)roundTrips.Max(), (unsigned long long)timeouts);
+    }
+
+    // A 60 Hz pulse sets the step; the atlas is rebuilt and the timeline stepped for color cycling
+    AnimationSettings animation;
+    animation.mode = AnimationMode::Pulse;
+    std::vector<CrosshairSettings> frames;
+    BuildAnimationFrames(range[n / 3], animation, frames);
+    AnimationTimeline timeline;
+    timeline.Configure(animation, frames.size(), 1000000);
+    const uint64_t step = timeline.StepUs();
+    AnimationAtlas atlas;
+    animation.mode = AnimationMode::ColorCycle;
+    Run("animation/atlas-build", 2000, [&](uint64_t i) {
+        BuildAnimationFrames(range[i % n], animation, frames);
+        atlas.Build(frames);
+        return (uint64_t)atlas.Bytes();
+    });
+    timeline.Configure(animation, frames.size(), 0);
+    Run("animation/advance", 10000000, [&](uint64_t i) {
+        return (uint64_t)timeline.Advance(i * step);
+    });
+
+    // Steady state: the overlay thread's whole path for a slider move or a code load, and a settings window
+    // refresh that finds nothing changed
+    SteadyStateOverlay overlay(range);
+    overlay.edited = range[n / 2];
+    Run("steady/slider-move", 1000000, [&](uint64_t i) { return overlay.Slide((int)(i % 21)); });
+    Run("steady/code-load", 1000000, [&](uint64_t i) { return overlay.LoadCode((size_t)i); });
+    Run("steady/panel-unchanged", 10000000, [&](uint64_t) { return (uint64_t)overlay.panel.Update(overlay.edited); });
+
+    const HotkeyBinding bindings[] = {
+        { kKeyF12, 0, HotkeyAction::OpenSettings },
+        { kKeyF1 + 10, kModCtrl, HotkeyAction::NextProfile },
+        { kKeyF1 + 6, kModCtrl, HotkeyAction::AnimationHold },
+    };
+    HotkeyDispatcher dispatcher;
+    dispatcher.SetBindings(bindings, 3);
+    uint64_t keyTime = 2000000000;
+    Run("hotkey/press-release-poll", 1000000, [&](uint64_t) {
+        keyTime += 250000;
+        dispatcher.OnKeyEvent({ kKeyF12, 0, true, keyTime });
+        dispatcher.OnKeyEvent({ kKeyF12, 0, false, keyTime + 1000 });
+        uint64_t polled = 0;
+        HotkeyEvent event;
+        while (dispatcher.Poll(event)) polled += event.pressed;
+        return polled;
+    });
+
+    // Crosshairs that need the shape engine, with every kernel this CPU supports
+    const std::vector<CrosshairSettings> shapeRange = ShapeRange();
+    const uint64_t shapeCount = shapeRange.size();
+    const ShapeKernel best = ActiveShapeKernel();
+    for (ShapeKernel kernel : { ShapeKernel::Scalar, ShapeKernel::Sse2, ShapeKernel::Avx }) {
+        if (!SetShapeKernel(kernel)) continue;
+        CrosshairSprite shapeSprite;
+        Run((std::string("shapes/raster/") + ShapeKernelName(kernel)).c_str(), 20000, [&](uint64_t i) {
+            RasterizeCrosshair(shapeRange[i % shapeCount], shapeSprite);
+            return (uint64_t)shapeSprite.pixels.size();
+        });
+    }
+    SetShapeKernel(best);
+    CrosshairShapes shapes;
+    std::vector<CoverageSpan> spans;
+    Run("shapes/compile+spans", 200000, [&](uint64_t i) {
+        const CrosshairSettings& settings = shapeRange[i % shapeCount];
+        CompileCrosshairShapes(settings, shapes);
+        const float outline = (float)settings.outlineThickness;
+        BuildCoverageSpans(shapes, outline, ComputeShapeBounds(shapes, outline), spans);
+        return (uint64_t)spans.size();
+    });
+
+    return 0;
+}
@@ -0,0 +1,335 @@
+// AdrixCH - Bulk crosshair code lists: streaming import, deduplication and nearest-match search.
+
+#include "CodeLibrary.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+
+namespace {
+
+constexpr size_t kLeafSize = 8;               // Ranges this small are scanned instead of split
+constexpr size_t kSpreadSamples = 256;        // Points sampled to choose a node's split feature
+constexpr float kToggleWeight = 4.0f;
+constexpr float kRotationRadius = 12.0f;      // Chord on this circle: about 0.2 per degree
+constexpr float kChannelWeight = 1.0f / 8.0f;
+constexpr size_t kReadBlockSize = 64 * 1024;
+
+inline float SquaredDistance(const float* a, const float* b) {
+    float sum = 0;
+    for (size_t i = 0; i < CrosshairCodeLibrary::kFeatureCount; i++) {
+        const float d = a[i] - b[i];
+        sum += d * d;
+    }
+    return sum;
+}
+
+} // namespace
+
+void CrosshairCodeLibrary::Features(const CrosshairSettings& s, float features[kFeatureCount]) {
+    const float angle = (float)s.rotation * (3.14159265358979f / 180.0f);
+    features[0] = (float)s.len;
+    features[1] = (float)s.gap;
+    features[2] = (float)s.thickness;
+    features[3] = (float)s.outlineThickness;
+    features[4] = (float)s.circleRadius;
+    features[5] = s.centerDot ? kToggleWeight : 0.0f;
+    features[6] = s.tStyle ? kToggleWeight : 0.0f;
+    features[7] = kRotationRadius * std::cos(angle);
+    features[8] = kRotationRadius * std::sin(angle);
+    for (int channel = 0; channel < 3; channel++) {
+        features[9 + channel] = kChannelWeight * (float)((s.fillColor >> (8 * channel)) & 0xFF);
+        features[12 + channel] = kChannelWeight * (float)((s.outlineColor >> (8 * channel)) & 0xFF);
+    }
+}
+
+float CrosshairCodeLibrary::Distance(const CrosshairSettings& a, const CrosshairSettings& b) {
+    float fa[kFeatureCount], fb[kFeatureCount];
+    Features(a, fa);
+    Features(b, fb);
+    return std::sqrt(SquaredDistance(fa, fb));
+}
+
+size_t CrosshairCodeLibrary::FindSlot(const CrosshairSettings& settings, uint64_t hash) const {
+    const size_t mask = slots_.size() - 1;
+    for (size_t slot = (size_t)hash & mask;; slot = (slot + 1) & mask) {
+        const uint32_t entry = slots_[slot];
+        if (entry == kEmptySlot || entries_[entry] == settings) return slot;
+    }
+}
+
+void CrosshairCodeLibrary::Rehash(size_t slotCount) {
+    slots_.assign(slotCount, kEmptySlot);
+    const size_t mask = slots_.size() - 1;
+    for (uint32_t i = 0; i < (uint32_t)entries_.size(); i++) {
+        size_t slot = (size_t)HashCrosshairSettings(entries_[i]) & mask;
+        while (slots_[slot] != kEmptySlot) slot = (slot + 1) & mask;
+        slots_[slot] = i;
+    }
+}
+
+bool CrosshairCodeLibrary::Add(const CrosshairSettings& settings) {
+    if ((entries_.size() + 1) * 2 > slots_.size()) Rehash(std::max<size_t>(slots_.size() * 2, 64));
+    const size_t slot = FindSlot(settings, HashCrosshairSettings(settings));
+    if (slots_[slot] != kEmptySlot) return false;
+    slots_[slot] = (uint32_t)entries_.size();
+    entries_.push_back(settings);
+    treeBuilt_ = false;
+    return true;
+}
+
+size_t CrosshairCodeLibrary::IndexOf(const CrosshairSettings& settings) const {
+    if (slots_.empty()) return npos;
+    const uint32_t entry = slots_[FindSlot(settings, HashCrosshairSettings(settings))];
+    return entry == kEmptySlot ? npos : entry;
+}
+
+bool CrosshairCodeLibrary::Contains(const CrosshairSettings& settings) const {
+    return IndexOf(settings) != npos;
+}
+
+void CrosshairCodeLibrary::Reserve(size_t count) {
+    entries_.reserve(count);
+    if (count * 2 <= slots_.size()) return;
+    size_t slotCount = std::max<size_t>(slots_.size(), 64);
+    while (slotCount < count * 2) slotCount *= 2;
+    Rehash(slotCount);
+}
+
+void CrosshairCodeLibrary::Clear() {
+    entries_.clear();
+    slots_.clear();
+    tree_.clear();
+    splitFeatures_.clear();
+    treeBuilt_ = false;
+}
+
+void CrosshairCodeLibrary::BuildTree(size_t begin, size_t end) const {
+    if (end - begin <= kLeafSize) return;
+
+    // Split on the feature that varies most, judged from an evenly spaced sample of the range
+    const size_t step = std::max<size_t>((end - begin) / kSpreadSamples, 1);
+    float low[kFeatureCount], high[kFeatureCount];
+    std::fill(low, low + kFeatureCount, INFINITY);
+    std::fill(high, high + kFeatureCount, -INFINITY);
+    for (size_t i = begin; i < end; i += step) {
+        for (size_t f = 0; f < kFeatureCount; f++) {
+            low[f] = std::min(low[f], tree_[i].features[f]);
+            high[f] = std::max(high[f], tree_[i].features[f]);
+        }
+    }
+    size_t split = 0;
+    for (size_t f = 1; f < kFeatureCount; f++) {
+        if (high[f] - low[f] > high[split] - low[split]) split = f;
+    }
+
+    const size_t middle = begin + (end - begin) / 2;
+    std::nth_element(tree_.begin() + begin, tree_.begin() + middle, tree_.begin() + end, [split](const TreePoint& a, const TreePoint& b) {
+        return a.features[split] < b.features[split];
+    });
+    splitFeatures_[middle] = (uint8_t)split;
+    BuildTree(begin, middle);
+    BuildTree(middle + 1, end);
+}
+
+void CrosshairCodeLibrary::BuildIndex() const {
+    if (treeBuilt_) return;
+    const size_t count = entries_.size();
+    tree_.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        Features(entries_[i], tree_[i].features);
+        tree_[i].entry = (uint32_t)i;
+    }
+    splitFeatures_.assign(count, 0);
+    BuildTree(0, count);
+    treeBuilt_ = true;
+}
+
+void CrosshairCodeLibrary::Search(size_t begin, size_t end, SearchState& search) const {
+    if (end - begin <= kLeafSize) {
+        for (size_t i = begin; i < end; i++) {
+            const float d = SquaredDistance(search.query, tree_[i].features);
+            if (d < search.bestDistance) { search.bestDistance = d; search.best = i; }
+        }
+        return;
+    }
+
+    const size_t middle = begin + (end - begin) / 2;
+    const float* point = tree_[middle].features;
+    const float d = SquaredDistance(search.query, point);
+    if (d < search.bestDistance) { search.bestDistance = d; search.best = middle; }
+
+    // Nearer side first. The far side's cell is at least cellDistance away, counting its offset along every
+    // feature split on so far rather than only this one, which prunes far more in this many dimensions.
+    const size_t split = splitFeatures_[middle];
+    const float offset = search.query[split] - point[split];
+    const bool below = offset < 0;
+    Search(below ? begin : middle + 1, below ? middle : end, search);
+
+    const float previous = search.offsets[split];
+    const float farDistance = search.cellDistance - previous * previous + offset * offset;
+    if (farDistance >= search.bestDistance) return;
+    const float cellDistance = search.cellDistance;
+    search.offsets[split] = offset;
+    search.cellDistance = farDistance;
+    Search(below ? middle + 1 : begin, below ? end : middle, search);
+    search.offsets[split] = previous;
+    search.cellDistance = cellDistance;
+}
+
+size_t CrosshairCodeLibrary::Nearest(const CrosshairSettings& settings, float* distance) const {
+    if (entries_.empty()) return npos;
+    BuildIndex();
+
+    SearchState search;
+    Features(settings, search.query);
+    Search(0, entries_.size(), search);
+    if (distance) *distance = std::sqrt(search.bestDistance);
+    return tree_[search.best].entry;
+}
+
+CrosshairCodeImporter::CrosshairCodeImporter(CrosshairCodeLibrary& library) : library_(library) {
+    batch_.reserve(kBatchSize);
+    batchLines_.reserve(kBatchSize);
+    decoded_.resize(kBatchSize);
+    statuses_.resize(kBatchSize);
+}
+
+void CrosshairCodeImporter::Reject(uint64_t line, CrosshairCodeStatus status) {
+    if (!stats_.rejected++) {
+        stats_.firstRejectedLine = line;
+        stats_.firstRejectedStatus = status;
+    }
+}
+
+void CrosshairCodeImporter::AddLine(std::string_view line) {
+    const uint64_t number = ++stats_.lines;
+    size_t first = 0;
+    while (first < line.size() && (line[first] == ' ' || line[first] == '\t' || line[first] == '\r')) first++;
+    if (first == line.size() || line[first] == '#') return;
+
+    batch_.push_back(line);
+    batchLines_.push_back(number);
+    if (batch_.size() == kBatchSize) FlushBatch();
+}
+
+void CrosshairCodeImporter::RejectOverlongLine() {
+    FlushBatch(); // Earlier lines first, so the first rejected line stays the first
+    stats_.lines++;
+    stats_.codes++;
+    Reject(stats_.lines, CrosshairCodeStatus::BadLength);
+}
+
+void CrosshairCodeImporter::FlushBatch() {
+    // Decode the whole batch first, then insert: each pass keeps its own tables and code hot
+    const size_t count = batch_.size();
+    for (size_t i = 0; i < count; i++) {
+        decoded_[i] = CrosshairSettings{};
+        statuses_[i] = DecodeCrosshairCode(batch_[i], decoded_[i]);
+    }
+    stats_.codes += count;
+    for (size_t i = 0; i < count; i++) {
+        if (statuses_[i] != CrosshairCodeStatus::Ok) Reject(batchLines_[i], statuses_[i]);
+        else if (library_.Add(decoded_[i])) stats_.added++;
+        else stats_.duplicates++;
+    }
+    batch_.clear();
+    batchLines_.clear();
+}
+
+void CrosshairCodeImporter::Feed(std::string_view text) {
+    // The first line of this chunk finishes the one cut off at the end of the previous chunk
+    bool carried = !partial_.empty() || overlong_;
+    size_t start = 0;
+    for (size_t newline; (newline = text.find('\n', start)) != std::string_view::npos; start = newline + 1) {
+        std::string_view line = text.substr(start, newline - start);
+        if (carried) {
+            carried = false;
+            if (overlong_ || partial_.size() + line.size() > kMaxLineLength) { overlong_ = false; RejectOverlongLine(); continue; }
+            partial_.append(line);
+            line = partial_;
+        }
+        else if (line.size() > kMaxLineLength) {
+            RejectOverlongLine();
+            continue;
+        }
+        AddLine(line);
+    }
+    FlushBatch(); // The batch may point into partial_ and into this chunk
+
+    // Keep the unfinished last line for the next chunk, but never more than a code can be long
+    const std::string_view rest = text.substr(start);
+    if (!carried) partial_.clear();
+    if (overlong_ || partial_.size() + rest.size() > kMaxLineLength) {
+        overlong_ = true;
+        partial_.clear();
+    }
+    else {
+        partial_.append(rest);
+    }
+}
+
+void CrosshairCodeImporter::Finish() {
+    if (overlong_) RejectOverlongLine();
+    else if (!partial_.empty()) AddLine(partial_);
+    FlushBatch();
+    partial_.clear();
+    overlong_ = false;
+}
+
+bool ImportCrosshairCodes(const std::filesystem::path& path, CrosshairCodeLibrary& library, CodeImportStats& stats,
+    const std::atomic<bool>* cancel) {
+    FILE* file = nullptr;
+#ifdef _WIN32
+    if (_wfopen_s(&file, path.c_str(), L"rb") != 0) file = nullptr;
+#else
+    file = std::fopen(path.c_str(), "rb");
+#endif
+    if (!file) return false;
+
+    CrosshairCodeImporter importer(library);
+    std::vector<char> block(kReadBlockSize);
+    size_t read;
+    bool cancelled = false;
+    while (!(cancelled = cancel && cancel->load(std::memory_order_relaxed)) &&
+        (read = std::fread(block.data(), 1, block.size(), file)) > 0) {
+        importer.Feed(std::string_view(block.data(), read));
+    }
+    const bool complete = !cancelled && !std::ferror(file);
+    std::fclose(file);
+    importer.Finish();
+    stats = importer.Stats();
+    return complete;
+}
+
+bool CrosshairCodeImportJob::Start(const std::filesystem::path& path, DoneCallback done, void* context) {
+    if (thread_.joinable()) return false;
+    cancel_.store(false, std::memory_order_relaxed);
+    finished_.store(false, std::memory_order_relaxed);
+    library_.Clear();
+    thread_ = std::thread([this, path, done, context] {
+        complete_ = ImportCrosshairCodes(path, library_, stats_, &cancel_);
+        const bool cancelled = cancel_.load(std::memory_order_relaxed);
+        if (!cancelled) library_.BuildIndex();
+        finished_.store(true, std::memory_order_release);
+        if (done && !cancelled) done(context);
+    });
+    return true;
+}
+
+bool CrosshairCodeImportJob::Finish(CrosshairCodeLibrary& library, CodeImportStats& stats) {
+    if (!thread_.joinable()) return false;
+    thread_.join();
+    library = std::move(library_);
+    library_ = CrosshairCodeLibrary();
+    stats = stats_;
+    return complete_;
+}
+
+void CrosshairCodeImportJob::Cancel() {
+    if (!thread_.joinable()) return;
+    cancel_.store(true, std::memory_order_relaxed);
+    thread_.join();
+    library_ = CrosshairCodeLibrary();
+}
@@ -0,0 +1,150 @@
+// AdrixCH - Bulk crosshair code lists: streaming import, deduplication and nearest-match search.
+//
+// Shared lists are plain text with one code per line; blank lines and lines starting with '#' are skipped.
+// The importer takes the text in chunks of any size, so a file of any length is read in fixed-size blocks;
+// complete lines are gathered into batches that are decoded in one pass and then inserted in another.
+// Every distinct crosshair is kept once, found through an open-addressed hash index on the settings tuple.
+// A k-d tree over a weighted feature vector of each crosshair answers "which crosshair in the library is
+// closest to these settings"; it is built on the first query after the library changed.
+// CrosshairCodeImportJob runs an import on a thread of its own, so a long list never stalls the UI thread.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "CrosshairCode.h"
+#include "CrosshairSettings.h"
+
+class CrosshairCodeLibrary {
+public:
+    static constexpr size_t npos = (size_t)-1;
+    static constexpr size_t kFeatureCount = 15;
+
+    size_t Size() const { return entries_.size(); }
+    const CrosshairSettings& At(size_t index) const { return entries_[index]; }
+
+    // Add a crosshair unless an equal one is already in the library; returns whether it was added
+    bool Add(const CrosshairSettings& settings);
+    bool Contains(const CrosshairSettings& settings) const;
+    size_t IndexOf(const CrosshairSettings& settings) const; // npos if absent
+    void Reserve(size_t count);
+    void Clear();
+
+    // Index of the entry closest to settings (npos for an empty library), and optionally its distance
+    size_t Nearest(const CrosshairSettings& settings, float* distance = nullptr) const;
+    // Build the search tree now instead of on the first Nearest call
+    void BuildIndex() const;
+
+    // Distance used by Nearest: sizes in pixels, toggles as 4 pixels each, a degree of rotation as about
+    // 0.2 pixels, and each color channel at 1/8 weight, so a full channel swing counts like 32 pixels
+    static void Features(const CrosshairSettings& settings, float features[kFeatureCount]);
+    static float Distance(const CrosshairSettings& a, const CrosshairSettings& b);
+
+private:
+    static constexpr uint32_t kEmptySlot = UINT32_MAX;
+
+    size_t FindSlot(const CrosshairSettings& settings, uint64_t hash) const;
+    void Rehash(size_t slotCount);
+    // One crosshair in the search tree; exactly a cache line
+    struct TreePoint {
+        float features[kFeatureCount];
+        uint32_t entry;
+    };
+    void BuildTree(size_t begin, size_t end) const;
+    struct SearchState {
+        float query[kFeatureCount];
+        float offsets[kFeatureCount] = {}; // Query's offset from the current cell along each feature
+        float cellDistance = 0;            // Squared distance from the query to the current cell
+        size_t best = 0;                   // Tree position of the best match so far
+        float bestDistance = INFINITY;     // Its squared distance
+    };
+    void Search(size_t begin, size_t end, SearchState& search) const;
+
+    std::vector<CrosshairSettings> entries_;
+    std::vector<uint32_t> slots_; // Entry index per slot, linear probing, at most half full
+
+    // Search tree, stored implicitly: the median of every range [begin, end) is its node
+    mutable std::vector<TreePoint> tree_;
+    mutable std::vector<uint8_t> splitFeatures_; // Split feature of the node at each position
+    mutable bool treeBuilt_ = false;
+};
+
+struct CodeImportStats {
+    uint64_t lines = 0;       // Every line, including blank and comment lines
+    uint64_t codes = 0;       // Lines that held something to decode
+    uint64_t added = 0;
+    uint64_t duplicates = 0;  // Valid codes for crosshairs already in the library
+    uint64_t rejected = 0;
+    uint64_t firstRejectedLine = 0; // 1-based; 0 if nothing was rejected
+    CrosshairCodeStatus firstRejectedStatus = CrosshairCodeStatus::Ok;
+};
+
+class CrosshairCodeImporter {
+public:
+    static constexpr size_t kBatchSize = 1024;
+    static constexpr size_t kMaxLineLength = 256; // Longer lines, comments included, are rejected without being buffered
+
+    explicit CrosshairCodeImporter(CrosshairCodeLibrary& library);
+
+    // Consume the next piece of the text; lines may be split anywhere between calls
+    void Feed(std::string_view text);
+    // The text is complete: the last line need not end with a newline
+    void Finish();
+
+    const CodeImportStats& Stats() const { return stats_; }
+
+private:
+    void AddLine(std::string_view line);
+    void RejectOverlongLine();
+    void Reject(uint64_t line, CrosshairCodeStatus status);
+    void FlushBatch();
+
+    CrosshairCodeLibrary& library_;
+    CodeImportStats stats_;
+    std::string partial_;  // Start of a line cut off at the end of the last chunk
+    bool overlong_ = false; // partial_ went past kMaxLineLength
+    std::vector<std::string_view> batch_;
+    std::vector<uint64_t> batchLines_;
+    std::vector<CrosshairSettings> decoded_;
+    std::vector<CrosshairCodeStatus> statuses_;
+};
+
+// Stream a code list from disk into library in 64 KiB blocks. Returns false if the file cannot be read or
+// cancel was set between two blocks; rejected lines are counted in stats, not treated as failure.
+bool ImportCrosshairCodes(const std::filesystem::path& path, CrosshairCodeLibrary& library, CodeImportStats& stats,
+    const std::atomic<bool>* cancel = nullptr);
+
+// One code list import on a worker thread. The list goes into a library of the job's own, which is indexed
+// before the callback runs, so the receiver's first Nearest query is immediate. One import at a time: the
+// result must be collected with Finish (or dropped with Cancel) before the next Start.
+class CrosshairCodeImportJob {
+public:
+    using DoneCallback = void (*)(void* context);
+
+    ~CrosshairCodeImportJob() { Cancel(); }
+
+    // done runs on the worker thread once the library is ready, not after a Cancel; returns false if an
+    // earlier import has not been collected yet
+    bool Start(const std::filesystem::path& path, DoneCallback done, void* context);
+    bool Running() const { return thread_.joinable() && !finished_.load(std::memory_order_acquire); }
+    // Wait for the worker and move its library into library; returns whether the whole file was read
+    bool Finish(CrosshairCodeLibrary& library, CodeImportStats& stats);
+    // Stop the worker between two read blocks, wait for it and discard what it imported
+    void Cancel();
+
+private:
+    std::thread thread_;
+    std::atomic<bool> cancel_{ false };
+    std::atomic<bool> finished_{ false };
+    CrosshairCodeLibrary library_;
+    CodeImportStats stats_;
+    bool complete_ = false;
+};
@@ -0,0 +1,370 @@
+// AdrixCH - Shared-memory control channel: external tools send settings commands to a running overlay.
+
+#include "ControlChannel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cwchar>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace {
+
+constexpr uint32_t kCapacity = ControlChannelLayout::kCapacity;
+constexpr size_t kMaxNameLength = 48;
+constexpr uint32_t kAckSpins = 2048; // Polls of the acknowledged counter before WaitForAck starts yielding
+
+#ifdef _WIN32
+
+// "Local\<name><suffix>" as a wide string; names are plain ASCII
+bool ObjectName(std::string_view name, const wchar_t* suffix, wchar_t* buffer, size_t capacity) {
+    if (name.empty() || name.size() > kMaxNameLength) return false;
+    const int written = swprintf(buffer, capacity, L"Local\\%.*hs%ls", (int)name.size(), name.data(), suffix);
+    return written > 0;
+}
+
+#else
+
+// "/<name>" for shm_open
+bool ObjectName(std::string_view name, char* buffer, size_t capacity) {
+    if (name.empty() || name.size() > kMaxNameLength || name.size() + 2 > capacity || name.find('/') != std::string_view::npos) return false;
+    buffer[0] = '/';
+    std::memcpy(buffer + 1, name.data(), name.size());
+    buffer[name.size() + 1] = 0;
+    return true;
+}
+
+void WaitOnDoorbell(std::atomic<uint32_t>& doorbell, uint32_t expected, uint32_t timeoutUs) {
+#ifdef __linux__
+    // Not FUTEX_PRIVATE_FLAG: the word lives in memory shared with the client process
+    const timespec timeout = { (time_t)(timeoutUs / 1000000), (long)(timeoutUs % 1000000) * 1000 };
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&doorbell), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+#else
+    // No cross-process futex: poll at up to 1 ms
+    if (doorbell.load(std::memory_order_acquire) == expected) {
+        std::this_thread::sleep_for(std::chrono::microseconds(std::min<uint32_t>(timeoutUs, 1000)));
+    }
+#endif
+}
+
+void RingDoorbell(std::atomic<uint32_t>& doorbell) {
+    doorbell.fetch_add(1, std::memory_order_release);
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&doorbell), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#endif
+}
+
+#endif
+
+} // namespace
+
+#ifdef _WIN32
+
+bool ControlChannelServer::Create(std::string_view name) {
+    Close();
+    wchar_t mappingName[64], eventName[64];
+    if (!ObjectName(name, L"", mappingName, 64) || !ObjectName(name, L".Wake", eventName, 64)) return false;
+
+    HANDLE mapping = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)sizeof(ControlChannelLayout), mappingName);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(ControlChannelLayout)) : nullptr;
+    HANDLE event = view ? CreateEventW(NULL, FALSE, FALSE, eventName) : NULL;
+    if (!event) {
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        return false;
+    }
+    mapping_ = mapping;
+    event_ = event;
+    layout_ = static_cast<ControlChannelLayout*>(view);
+    Reset();
+    return true;
+}
+
+void ControlChannelServer::Close() {
+    if (layout_) {
+        layout_->magic.store(0, std::memory_order_release);
+        UnmapViewOfFile(layout_);
+    }
+    if (event_) CloseHandle(event_);
+    if (mapping_) CloseHandle(mapping_);
+    layout_ = nullptr;
+    event_ = nullptr;
+    mapping_ = nullptr;
+}
+
+bool ControlChannelServer::Wait(uint32_t timeoutUs) {
+    if (!layout_) return false;
+    if (layout_->head.load(std::memory_order_acquire) == tail_) WaitForSingleObject(event_, (timeoutUs + 999) / 1000);
+    return layout_->head.load(std::memory_order_acquire) != tail_;
+}
+
+bool ControlChannelClient::Open(std::string_view name) {
+    Close();
+    wchar_t mappingName[64], eventName[64];
+    if (!ObjectName(name, L"", mappingName, 64) || !ObjectName(name, L".Wake", eventName, 64)) return false;
+
+    HANDLE mapping = OpenFileMappingW(FILE_MAP_ALL_ACCESS, FALSE, mappingName);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(ControlChannelLayout)) : nullptr;
+    HANDLE event = view ? OpenEventW(EVENT_MODIFY_STATE, FALSE, eventName) : NULL;
+    if (!event) {
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        return false;
+    }
+    mapping_ = mapping;
+    event_ = event;
+    layout_ = static_cast<ControlChannelLayout*>(view);
+    if (!Attach()) { Close(); return false; }
+    return true;
+}
+
+void ControlChannelClient::Close() {
+    if (layout_) UnmapViewOfFile(layout_);
+    if (event_) CloseHandle(event_);
+    if (mapping_) CloseHandle(mapping_);
+    layout_ = nullptr;
+    event_ = nullptr;
+    mapping_ = nullptr;
+}
+
+void ControlChannelClient::Wake() {
+    SetEvent(event_);
+}
+
+#else
+
+bool ControlChannelServer::Create(std::string_view name) {
+    Close();
+    char path[sizeof(name_)];
+    if (!ObjectName(name, path, sizeof(path))) return false;
+
+    const int fd = shm_open(path, O_CREAT | O_RDWR | O_CLOEXEC, 0600);
+    if (fd < 0) return false;
+    void* view = ftruncate(fd, (off_t)sizeof(ControlChannelLayout)) == 0
+        ? mmap(nullptr, sizeof(ControlChannelLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd); // The mapping keeps its own reference
+    if (view == MAP_FAILED) {
+        shm_unlink(path);
+        return false;
+    }
+    std::memcpy(name_, path, sizeof(name_));
+    layout_ = static_cast<ControlChannelLayout*>(view);
+    Reset();
+    return true;
+}
+
+void ControlChannelServer::Close() {
+    if (layout_) {
+        layout_->magic.store(0, std::memory_order_release);
+        munmap(layout_, sizeof(ControlChannelLayout));
+        shm_unlink(name_);
+    }
+    layout_ = nullptr;
+    name_[0] = 0;
+}
+
+bool ControlChannelServer::Wait(uint32_t timeoutUs) {
+    if (!layout_) return false;
+    if (layout_->head.load(std::memory_order_acquire) != tail_) return true;
+
+    // Announce the sleep, then look at the ring once more: a client publishing in between either shows up
+    // in head here or sees sleeping and bumps the doorbell, which makes the futex wait return at once
+    const uint32_t doorbell = layout_->doorbell.load(std::memory_order_acquire);
+    layout_->sleeping.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (layout_->head.load(std::memory_order_relaxed) == tail_) WaitOnDoorbell(layout_->doorbell, doorbell, timeoutUs);
+    layout_->sleeping.store(0, std::memory_order_relaxed);
+    return layout_->head.load(std::memory_order_acquire) != tail_;
+}
+
+bool ControlChannelClient::Open(std::string_view name) {
+    Close();
+    char path[64];
+    if (!ObjectName(name, path, sizeof(path))) return false;
+
+    const int fd = shm_open(path, O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) return false;
+    struct stat st;
+    void* view = fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(ControlChannelLayout)
+        ? mmap(nullptr, sizeof(ControlChannelLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (view == MAP_FAILED) return false;
+    layout_ = static_cast<ControlChannelLayout*>(view);
+    if (!Attach()) { Close(); return false; }
+    return true;
+}
+
+void ControlChannelClient::Close() {
+    if (layout_) munmap(layout_, sizeof(ControlChannelLayout));
+    layout_ = nullptr;
+}
+
+void ControlChannelClient::Wake() {
+    // Pairs with the fence in ControlChannelServer::Wait: either the overlay sees the new head, or this sees it asleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (layout_->sleeping.load(std::memory_order_relaxed)) RingDoorbell(layout_->doorbell);
+}
+
+#endif
+
+void ControlChannelServer::Reset() {
+    // Whatever a previous overlay or client left behind is discarded; clients attach once magic is set
+    ControlChannelLayout* layout = new (layout_) ControlChannelLayout;
+    layout->version = ControlChannelLayout::kVersion;
+    layout->capacity = kCapacity;
+    layout->commandSize = (uint32_t)sizeof(ControlCommand);
+    layout->magic.store(ControlChannelLayout::kMagic, std::memory_order_release);
+    tail_ = 0;
+}
+
+bool ControlChannelServer::Poll(ControlCommand& command) {
+    if (!layout_) return false;
+    const uint64_t head = layout_->head.load(std::memory_order_acquire);
+    if (head == tail_) return false;
+    if (head < tail_ || head - tail_ > kCapacity) {
+        // Only a misbehaving client gets here: drop whatever it claims to have published and start over from head
+        malformed_++;
+        tail_ = head;
+        layout_->tail.store(tail_, std::memory_order_release);
+        return false;
+    }
+
+    std::memcpy(&command, &layout_->commands[tail_ % kCapacity], sizeof(command));
+    tail_++;
+    layout_->tail.store(tail_, std::memory_order_release); // The slot may be reused from here on
+    received_++;
+
+    // Everything else is checked where it is applied; a slot from another lap is turned into a no-op
+    if (command.sequence != tail_) {
+        malformed_++;
+        command = ControlCommand{};
+        command.sequence = tail_;
+    }
+    return true;
+}
+
+void ControlChannelServer::Acknowledge(uint64_t sequence, ControlStatus status) {
+    if (!layout_) return;
+    layout_->statuses[sequence % kCapacity].store(status, std::memory_order_relaxed);
+    layout_->acknowledged.store(sequence, std::memory_order_release);
+}
+
+bool ControlChannelClient::Attach() {
+    if (layout_->magic.load(std::memory_order_acquire) != ControlChannelLayout::kMagic || layout_->version != ControlChannelLayout::kVersion ||
+        layout_->capacity != kCapacity || layout_->commandSize != sizeof(ControlCommand)) {
+        return false;
+    }
+    head_ = layout_->head.load(std::memory_order_relaxed); // Carry on after an earlier client
+    return true;
+}
+
+uint64_t ControlChannelClient::Send(const ControlCommand& command) {
+    if (!layout_ || head_ - layout_->tail.load(std::memory_order_acquire) >= kCapacity) return 0;
+
+    ControlCommand& slot = layout_->commands[head_ % kCapacity];
+    slot = command;
+    slot.sequence = ++head_;
+    layout_->head.store(head_, std::memory_order_release);
+    Wake();
+    return head_;
+}
+
+uint64_t ControlChannelClient::SetField(CrosshairField field, int value) {
+    ControlCommand command;
+    command.type = ControlCommandType::SetField;
+    command.field = field;
+    command.value = value;
+    return Send(command);
+}
+
+uint64_t ControlChannelClient::LoadCode(std::string_view code) {
+    if (code.empty() || code.size() >= kCrosshairCodeBufferSize) return 0;
+    ControlCommand command;
+    command.type = ControlCommandType::LoadCode;
+    command.codeLength = (uint8_t)code.size();
+    std::memcpy(command.code, code.data(), code.size());
+    return Send(command);
+}
+
+uint64_t ControlChannelClient::SelectProfile(int slot) {
+    ControlCommand command;
+    command.type = ControlCommandType::SelectProfile;
+    command.value = slot;
+    return Send(command);
+}
+
+uint64_t ControlChannelClient::StepProfile(int step) {
+    ControlCommand command;
+    command.type = ControlCommandType::StepProfile;
+    command.value = step;
+    return Send(command);
+}
+
+uint64_t ControlChannelClient::SetVisible(bool visible) {
+    ControlCommand command;
+    command.type = ControlCommandType::SetVisible;
+    command.value = visible ? 1 : 0;
+    return Send(command);
+}
+
+uint64_t ControlChannelClient::ToggleVisible() {
+    ControlCommand command;
+    command.type = ControlCommandType::ToggleVisible;
+    return Send(command);
+}
+
+uint64_t ControlChannelClient::Acknowledged() const {
+    return layout_ ? layout_->acknowledged.load(std::memory_order_acquire) : 0;
+}
+
+ControlStatus ControlChannelClient::WaitForAck(uint64_t sequence, uint32_t timeoutUs) const {
+    if (!layout_ || sequence == 0) return ControlStatus::Pending;
+
+    // The overlay usually answers within microseconds: spin briefly, then give up the core while waiting
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeoutUs);
+    for (uint32_t spins = 0;; spins++) {
+        if (layout_->acknowledged.load(std::memory_order_acquire) >= sequence) {
+            return layout_->statuses[sequence % kCapacity].load(std::memory_order_relaxed);
+        }
+        if (spins < kAckSpins) continue;
+        if (std::chrono::steady_clock::now() >= deadline) return ControlStatus::Pending;
+        std::this_thread::yield();
+    }
+}
+
+ControlStatus ApplyControlCommand(const ControlCommand& command, CrosshairSettings& settings) {
+    CrosshairSettings updated = settings;
+    switch (command.type) {
+    case ControlCommandType::SetField: {
+        // Only the field being set has to fit the slider range; the others may hold wider INI values already
+        CrosshairSettings probe;
+        if (!SetCrosshairField(probe, command.field, command.value) || !IsCrosshairSettingsInRange(probe)) return ControlStatus::Rejected;
+        CopyCrosshairFields(updated, probe, CrosshairFieldBit(command.field));
+        break;
+    }
+    case ControlCommandType::LoadCode:
+        if (command.codeLength == 0 || command.codeLength >= kCrosshairCodeBufferSize ||
+            DecodeCrosshairCode(std::string_view(command.code, command.codeLength), updated) != CrosshairCodeStatus::Ok) {
+            return ControlStatus::Rejected;
+        }
+        break;
+    default:
+        return ControlStatus::Rejected;
+    }
+    settings = updated;
+    return ControlStatus::Applied;
+}
@@ -0,0 +1,170 @@
+// AdrixCH - Shared-memory control channel: external tools send settings commands to a running overlay.
+//
+// The overlay creates a named shared-memory region holding a single-producer, single-consumer ring of
+// fixed-size commands (set a field, load a code, select or step a profile, show, hide or toggle the overlay).
+// A client maps the same region, writes commands into the ring and rings a doorbell; the overlay takes them
+// on its next pass through the message loop and applies them to the crosshair, which is then drawn at the next
+// refresh boundary like any other settings change. Every command carries a sequence number, and the overlay
+// publishes the sequence of the last command it has dealt with plus an applied/rejected status per command,
+// so a client can wait for its update without any window messages.
+//
+// Only one client may send at a time: the ring has a single producer. Everything read from the region is
+// validated by the overlay, since any process of the same user can write to it.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "CrosshairCode.h"
+#include "CrosshairSettings.h"
+
+// Shared-memory name: "/AdrixCH.Control" for shm_open, "Local\AdrixCH.Control" for Win32 (per session)
+constexpr std::string_view kControlChannelName = "AdrixCH.Control";
+
+enum class ControlCommandType : uint8_t {
+    None,
+    SetField,      // field = value, inside the settings slider ranges
+    LoadCode,      // code[0, codeLength) is a crosshair code
+    SelectProfile, // value is a profile library slot
+    StepProfile,   // value steps forwards or backwards through the profiles, wrapping around
+    SetVisible,    // value 0 hides the overlay, anything else shows it
+    ToggleVisible,
+};
+
+enum class ControlStatus : uint8_t {
+    Pending,  // Not dealt with yet (or the wait timed out)
+    Applied,
+    Rejected, // Malformed, out of range, or nothing to apply it to
+};
+
+// One ring slot, exactly a cache line
+struct ControlCommand {
+    uint64_t sequence = 0; // Set by Send: 1 for the first command sent through the region, then counting up
+    ControlCommandType type = ControlCommandType::None;
+    CrosshairField field = CrosshairField::Count;
+    uint8_t codeLength = 0;
+    uint8_t reserved = 0;
+    int32_t value = 0;
+    char code[kCrosshairCodeBufferSize] = {};
+    uint8_t padding[16] = {};
+};
+static_assert(sizeof(ControlCommand) == 64, "ControlCommand is one cache line");
+
+// Layout of the shared region. Indices count up forever; slot = index % kCapacity.
+struct ControlChannelLayout {
+    static constexpr uint32_t kMagic = 0x43435841; // "AXCC"
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kCapacity = 256;
+
+    std::atomic<uint32_t> magic;  // Stored last when the overlay sets the region up
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t commandSize;
+
+    // Written by the client
+    alignas(64) std::atomic<uint64_t> head;      // Commands published
+    std::atomic<uint32_t> doorbell;              // Bumped after a publish while the overlay sleeps on it
+
+    // Written by the overlay
+    alignas(64) std::atomic<uint64_t> tail;      // Commands taken out of the ring
+    std::atomic<uint64_t> acknowledged;          // Sequence of the last command applied or rejected
+    std::atomic<uint32_t> sleeping;              // The overlay is (about to be) asleep on the doorbell
+
+    alignas(64) std::atomic<ControlStatus> statuses[kCapacity]; // Status of each of the last kCapacity commands, by sequence
+    alignas(64) ControlCommand commands[kCapacity];
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free &&
+    std::atomic<ControlStatus>::is_always_lock_free,
+    "the shared counters must be lock-free to work across processes");
+
+// Overlay side: creates the region, takes commands and acknowledges them. Single thread.
+class ControlChannelServer {
+public:
+    ControlChannelServer() = default;
+    ~ControlChannelServer() { Close(); }
+    ControlChannelServer(const ControlChannelServer&) = delete;
+    ControlChannelServer& operator=(const ControlChannelServer&) = delete;
+
+    // Create (or take over and reset) the named region. Returns false if it cannot be created or mapped.
+    bool Create(std::string_view name = kControlChannelName);
+    // Unmap the region; on POSIX the name is removed too, so clients can tell the overlay is gone
+    void Close();
+    bool IsOpen() const { return layout_ != nullptr; }
+
+    // Take the next command, if any. Commands are taken in order; each must be acknowledged before the next
+    // one is taken, or the client sees only the later sequence.
+    bool Poll(ControlCommand& command);
+    void Acknowledge(uint64_t sequence, ControlStatus status);
+
+    // Sleep until a client rings the doorbell, a command is already waiting, or timeoutUs passes.
+    // Returns whether a command is waiting.
+    bool Wait(uint32_t timeoutUs);
+#ifdef _WIN32
+    // Auto-reset event (HANDLE) clients signal after every send, for waiting alongside window messages
+    void* WakeEvent() const { return event_; }
+#endif
+
+    uint64_t Received() const { return received_; }
+    uint64_t Malformed() const { return malformed_; } // Ring states or slots that could not be valid
+
+private:
+    void Reset();
+
+    ControlChannelLayout* layout_ = nullptr;
+    uint64_t tail_ = 0;
+    uint64_t received_ = 0;
+    uint64_t malformed_ = 0;
+#ifdef _WIN32
+    void* mapping_ = nullptr; // HANDLE
+    void* event_ = nullptr;   // HANDLE
+#else
+    char name_[64] = {};
+#endif
+};
+
+// Client library: maps an overlay's region and sends it commands. Single thread; one client per region at a time.
+class ControlChannelClient {
+public:
+    ControlChannelClient() = default;
+    ~ControlChannelClient() { Close(); }
+    ControlChannelClient(const ControlChannelClient&) = delete;
+    ControlChannelClient& operator=(const ControlChannelClient&) = delete;
+
+    // Map the region of a running overlay. Returns false if there is none, or it is of another version.
+    bool Open(std::string_view name = kControlChannelName);
+    void Close();
+    bool IsOpen() const { return layout_ != nullptr; }
+
+    // Publish a command and ring the doorbell. Returns its sequence, or 0 if the ring is full.
+    uint64_t Send(const ControlCommand& command);
+    uint64_t SetField(CrosshairField field, int value);
+    uint64_t LoadCode(std::string_view code); // 0 without sending if the code cannot fit a slot
+    uint64_t SelectProfile(int slot);
+    uint64_t StepProfile(int step);
+    uint64_t SetVisible(bool visible);
+    uint64_t ToggleVisible();
+
+    // Spin, then yield, until the overlay has dealt with sequence or timeoutUs passes. The status of a command
+    // stays readable until kCapacity further commands have been acknowledged.
+    ControlStatus WaitForAck(uint64_t sequence, uint32_t timeoutUs) const;
+    uint64_t Acknowledged() const;
+
+private:
+    bool Attach(); // Check the mapped region is a set-up overlay region of this version
+    void Wake();
+
+    ControlChannelLayout* layout_ = nullptr;
+    uint64_t head_ = 0;
+#ifdef _WIN32
+    void* mapping_ = nullptr; // HANDLE
+    void* event_ = nullptr;   // HANDLE
+#endif
+};
+
+// Apply a SetField or LoadCode command to settings. A SetField value must be inside its slider range, whatever
+// the other fields hold. Leaves settings untouched unless the result is Applied; other command types are
+// Rejected, they are for the caller to handle.
+ControlStatus ApplyControlCommand(const ControlCommand& command, CrosshairSettings& settings);
@@ -0,0 +1,235 @@
+// AdrixCH - Dynamic crosshairs: a fixed-timestep animation clock and a pre-rasterized sprite atlas.
+
+#include "CrosshairAnimation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+bool EqualsNoCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        const char c = (a[i] >= 'A' && a[i] <= 'Z') ? (char)(a[i] - 'A' + 'a') : a[i];
+        if (c != b[i]) return false;
+    }
+    return true;
+}
+
+int AnimationAmount(const AnimationSettings& animation) {
+    return std::clamp(animation.amount, 1, kMaxAnimationAmount);
+}
+
+uint64_t AnimationStepUs(const AnimationSettings& animation) {
+    return 1000000u / (uint64_t)std::clamp(animation.frameRateHz, 1, 1000);
+}
+
+// Steps in one period (or, for the expanding gap, from closed to fully open); at least 1
+uint64_t AnimationPeriodSteps(const AnimationSettings& animation) {
+    const uint64_t periodUs = (uint64_t)std::max(animation.periodMs, 1) * 1000;
+    const uint64_t stepUs = AnimationStepUs(animation);
+    return std::max<uint64_t>((periodUs + stepUs / 2) / stepUs, 1);
+}
+
+// Turn the hue of a COLORREF by degrees, keeping its value; a gray gets full saturation so it visibly cycles
+uint32_t RotateHue(uint32_t color, float degrees) {
+    const float red = (float)(color & 0xFF), green = (float)((color >> 8) & 0xFF), blue = (float)((color >> 16) & 0xFF);
+    const float high = std::max({ red, green, blue }), low = std::min({ red, green, blue });
+    const float chroma = high - low;
+    float hue = 0;
+    if (chroma > 0) {
+        if (high == red) hue = (green - blue) / chroma;
+        else if (high == green) hue = (blue - red) / chroma + 2.0f;
+        else hue = (red - green) / chroma + 4.0f;
+        hue *= 60.0f;
+    }
+    const float value = high > 0 ? high : 255.0f;
+    const float saturation = chroma > 0 ? chroma / high : 1.0f;
+
+    hue = std::fmod(hue + degrees, 360.0f);
+    if (hue < 0) hue += 360.0f;
+    const float c = value * saturation;
+    const float x = c * (1.0f - std::fabs(std::fmod(hue / 60.0f, 2.0f) - 1.0f));
+    const float m = value - c;
+    float r = 0, g = 0, b = 0;
+    switch ((int)(hue / 60.0f)) {
+    case 0: r = c; g = x; break;
+    case 1: r = x; g = c; break;
+    case 2: g = c; b = x; break;
+    case 3: g = x; b = c; break;
+    case 4: r = x; b = c; break;
+    default: r = c; b = x; break;
+    }
+    auto channel = [m](float v) { return (uint32_t)std::clamp((int)std::lround(v + m), 0, 255); };
+    return channel(r) | (channel(g) << 8) | (channel(b) << 16);
+}
+
+} // namespace
+
+bool ParseAnimationMode(std::string_view text, AnimationMode& mode) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) text.remove_suffix(1);
+    if (EqualsNoCase(text, "none")) mode = AnimationMode::None;
+    else if (EqualsNoCase(text, "expand-gap")) mode = AnimationMode::ExpandGap;
+    else if (EqualsNoCase(text, "pulse")) mode = AnimationMode::Pulse;
+    else if (EqualsNoCase(text, "color-cycle")) mode = AnimationMode::ColorCycle;
+    else return false;
+    return true;
+}
+
+void BuildAnimationFrames(const CrosshairSettings& base, const AnimationSettings& animation, std::vector<CrosshairSettings>& frames) {
+    frames.clear();
+    const int amount = AnimationAmount(animation);
+    switch (animation.mode) {
+    case AnimationMode::ExpandGap:
+        for (int k = 0; k <= amount; k++) {
+            frames.push_back(base);
+            frames.back().gap = base.gap + k;
+        }
+        break;
+    case AnimationMode::Pulse:
+        for (int k = 0; k <= amount; k++) {
+            frames.push_back(base);
+            frames.back().len = base.len + k;
+        }
+        break;
+    case AnimationMode::ColorCycle: {
+        // No more hues than the clock can show in one period
+        const size_t count = (size_t)std::min<uint64_t>(kColorCycleFrames, std::max<uint64_t>(AnimationPeriodSteps(animation), 2));
+        for (size_t i = 0; i < count; i++) {
+            frames.push_back(base);
+            frames.back().fillColor = i == 0 ? base.fillColor : RotateHue(base.fillColor, 360.0f * (float)i / (float)count);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void AnimationAtlas::Build(const std::vector<CrosshairSettings>& frames) {
+    frameCount_ = frames.size();
+    if (frames.empty()) { Clear(); return; }
+
+    bounds_ = ComputeCrosshairBounds(frames[0]);
+    for (const CrosshairSettings& frame : frames) bounds_ = UnionCrosshairRects(bounds_, ComputeCrosshairBounds(frame));
+    cellWidth_ = bounds_.right - bounds_.left;
+    cellHeight_ = bounds_.bottom - bounds_.top;
+    const size_t cellPixels = (size_t)cellWidth_ * (size_t)cellHeight_;
+    pixels_.assign(cellPixels * frameCount_, 0);
+
+    for (size_t i = 0; i < frameCount_; i++) {
+        RasterizeCrosshair(frames[i], scratch_);
+        uint32_t* cell = pixels_.data() + i * cellPixels;
+
+        // Every sprite lies within its bounds, which lie within the cell; clip anyway
+        const int x = OriginX() - scratch_.originX, y = OriginY() - scratch_.originY;
+        const int left = std::max(x, 0), right = std::min(x + scratch_.width, cellWidth_);
+        if (right <= left) continue;
+        for (int row = std::max(y, 0); row < std::min(y + scratch_.height, cellHeight_); row++) {
+            const uint32_t* source = scratch_.pixels.data() + (size_t)(row - y) * scratch_.width + (left - x);
+            std::memcpy(cell + (size_t)row * cellWidth_ + left, source, (size_t)(right - left) * sizeof(uint32_t));
+        }
+    }
+}
+
+void AnimationAtlas::Clear() {
+    pixels_.clear();
+    bounds_ = {};
+    cellWidth_ = cellHeight_ = 0;
+    frameCount_ = 0;
+}
+
+void AnimationTimeline::Configure(const AnimationSettings& animation, size_t frameCount, uint64_t nowUs) {
+    mode_ = frameCount > 0 ? animation.mode : AnimationMode::None;
+    frameCount_ = frameCount;
+    stepUs_ = AnimationStepUs(animation);
+    originUs_ = nowUs;
+    step_ = 0;
+    cycleOffset_ = 0;
+    position_ = 0;
+    frame_ = 0;
+    lastLatenessUs_ = 0;
+    cycle_.clear();
+
+    const uint64_t periodSteps = AnimationPeriodSteps(animation);
+    switch (mode_) {
+    case AnimationMode::ExpandGap:
+        openSteps_ = periodSteps;
+        break;
+    case AnimationMode::Pulse:
+        // Eased: the arms linger at both ends and move fastest in between
+        cycle_.resize(std::max<uint64_t>(periodSteps, 2));
+        for (size_t i = 0; i < cycle_.size(); i++) {
+            const double phase = (double)i / (double)cycle_.size();
+            const double extent = 0.5 - 0.5 * std::cos(2.0 * 3.14159265358979 * phase);
+            cycle_[i] = (uint16_t)std::lround(extent * (double)(frameCount - 1));
+        }
+        break;
+    case AnimationMode::ColorCycle:
+        cycle_.resize(std::max<uint64_t>(periodSteps, 2));
+        for (size_t i = 0; i < cycle_.size(); i++) cycle_[i] = (uint16_t)(i * frameCount / cycle_.size());
+        break;
+    default:
+        break;
+    }
+}
+
+bool AnimationTimeline::Running() const {
+    switch (mode_) {
+    case AnimationMode::ExpandGap: return held_ ? position_ < openSteps_ : position_ > 0;
+    case AnimationMode::Pulse:
+    case AnimationMode::ColorCycle: return true;
+    default: return false;
+    }
+}
+
+void AnimationTimeline::SetHeld(bool held, uint64_t nowUs) {
+    // A clock at rest restarts from now, so the time it stood still does not count as dropped steps
+    if (!Running()) Resync(nowUs);
+    held_ = held;
+}
+
+void AnimationTimeline::Resync(uint64_t nowUs) {
+    // Carry on from the current frame rather than jumping back to the start of the period
+    const uint64_t phase = cycle_.empty() ? 0 : (step_ + cycleOffset_) % cycle_.size();
+    originUs_ = nowUs;
+    step_ = 0;
+    cycleOffset_ = phase;
+}
+
+uint64_t AnimationTimeline::DelayUs(uint64_t nowUs) const {
+    const uint64_t next = originUs_ + (step_ + 1) * stepUs_;
+    return next > nowUs ? next - nowUs : 0;
+}
+
+size_t AnimationTimeline::Advance(uint64_t nowUs) {
+    if (mode_ == AnimationMode::None || nowUs < originUs_) return frame_;
+    const uint64_t due = (nowUs - originUs_) / stepUs_;
+    if (due <= step_) return frame_;
+
+    const uint64_t count = due - step_;
+    step_ = due;
+    if (mode_ == AnimationMode::ExpandGap) {
+        // Steps past the ends leave the frame alone, and do not count as frames
+        const uint64_t before = position_;
+        position_ = held_ ? std::min(position_ + count, openSteps_) : (position_ > count ? position_ - count : 0);
+        if (position_ == before) return frame_;
+        const uint64_t moved = held_ ? position_ - before : before - position_;
+        stats_.steps += moved;
+        stats_.dropped += moved - 1;
+        frame_ = (size_t)((position_ * (frameCount_ - 1) + openSteps_ / 2) / openSteps_);
+    }
+    else {
+        stats_.steps += count;
+        stats_.dropped += count - 1;
+        frame_ = cycle_[(step_ + cycleOffset_) % cycle_.size()];
+    }
+
+    stats_.frames++;
+    lastLatenessUs_ = nowUs - (originUs_ + step_ * stepUs_);
+    if (lastLatenessUs_ * 2 > stepUs_) stats_.late++;
+    stats_.maxLatenessUs = std::max(stats_.maxLatenessUs, lastLatenessUs_);
+    return frame_;
+}
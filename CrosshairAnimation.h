@@ -0,0 +1,122 @@
+// AdrixCH - Dynamic crosshairs: a fixed-timestep animation clock and a pre-rasterized sprite atlas.
+//
+// An animation is a short list of crosshair looks (a gap opening pixel by pixel, arms growing and shrinking, the
+// fill running through the hues). All of them are rasterized once, when the settings change, into one atlas of
+// equal cells that share the crosshair center, so showing any frame is a single blit of one cell with no geometry
+// or GDI object work. The timeline advances in fixed steps on its own clock and picks the frame for each step;
+// steps that come due together are simulated at once and all but the last are counted as dropped frames.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "CrosshairGeometry.h"
+#include "CrosshairRaster.h"
+#include "CrosshairSettings.h"
+
+enum class AnimationMode : uint8_t {
+    None,
+    ExpandGap,  // The gap opens while the hold hotkey is down and closes again after it is released
+    Pulse,      // The arms grow and shrink back once per period
+    ColorCycle, // The fill runs through every hue once per period
+};
+
+constexpr int kMaxAnimationAmount = 32;   // Pixels, at 96 DPI
+constexpr size_t kColorCycleFrames = 36;  // 10 degrees of hue apart
+
+// [Animation] section of the INI file
+struct AnimationSettings {
+    AnimationMode mode = AnimationMode::None;
+    int frameRateHz = 60; // Steps per second of the animation clock
+    int periodMs = 600;   // One pulse or color cycle; for the expanding gap, the time to open fully
+    int amount = 8;       // Pixels the gap opens or the arms grow at the peak, at 96 DPI
+
+    bool operator==(const AnimationSettings&) const = default;
+};
+
+// "none", "expand-gap", "pulse" or "color-cycle" (case-insensitive)
+bool ParseAnimationMode(std::string_view text, AnimationMode& mode);
+
+// Every distinct look of the animation, at the same scale as base; frame 0 is the look at rest.
+// Empty for AnimationMode::None.
+void BuildAnimationFrames(const CrosshairSettings& base, const AnimationSettings& animation, std::vector<CrosshairSettings>& frames);
+
+// Frames of one animation as a single top-down BGRA image: cells of CellWidth x CellHeight stacked top to bottom
+class AnimationAtlas {
+public:
+    // Rasterize every frame and pack it into its cell. The buffers are reused, so rebuilding for frames of the
+    // same or smaller size does not allocate.
+    void Build(const std::vector<CrosshairSettings>& frames);
+    void Clear();
+
+    size_t FrameCount() const { return frameCount_; }
+    int CellWidth() const { return cellWidth_; }
+    int CellHeight() const { return cellHeight_; }
+    // Position of the crosshair center inside every cell
+    int OriginX() const { return -bounds_.left; }
+    int OriginY() const { return -bounds_.top; }
+    // Cell rectangle relative to the crosshair center: the union of the bounds of every frame
+    const CrosshairRect& Bounds() const { return bounds_; }
+    // First pixel of a frame's cell; its rows are CellWidth() pixels apart
+    const uint32_t* FramePixels(size_t frame) const { return pixels_.data() + frame * (size_t)cellWidth_ * (size_t)cellHeight_; }
+    size_t Bytes() const { return pixels_.size() * sizeof(uint32_t); }
+
+private:
+    std::vector<uint32_t> pixels_;
+    CrosshairSprite scratch_;
+    CrosshairRect bounds_ = {};
+    int cellWidth_ = 0;
+    int cellHeight_ = 0;
+    size_t frameCount_ = 0;
+};
+
+struct AnimationStats {
+    uint64_t steps = 0;         // Fixed steps the clock has advanced
+    uint64_t frames = 0;        // Frames handed out for presenting
+    uint64_t dropped = 0;       // Steps whose frame was superseded by a later step before it could be presented
+    uint64_t late = 0;          // Frames handed out more than half a step after their step was due
+    uint64_t maxLatenessUs = 0;
+};
+
+class AnimationTimeline {
+public:
+    // Set up the clock for an atlas of frameCount frames (as built by BuildAnimationFrames) and start it at nowUs
+    void Configure(const AnimationSettings& animation, size_t frameCount, uint64_t nowUs);
+
+    // Expanding gap: the hold hotkey went down or up
+    void SetHeld(bool held, uint64_t nowUs);
+    // Restart the clock at nowUs from the current frame, without counting the steps in between as dropped
+    // (e.g. after the overlay was hidden)
+    void Resync(uint64_t nowUs);
+
+    // Move the clock forward to nowUs in whole steps and return the frame to present
+    size_t Advance(uint64_t nowUs);
+    size_t Frame() const { return frame_; }
+    // Whether further steps can change the frame; periodic modes always run
+    bool Running() const;
+    // Microseconds from nowUs until the next step is due; 0 if it already is
+    uint64_t DelayUs(uint64_t nowUs) const;
+    uint64_t StepUs() const { return stepUs_; }
+    // How long after its step was due the last frame was handed out
+    uint64_t LastLatenessUs() const { return lastLatenessUs_; }
+
+    const AnimationStats& Stats() const { return stats_; }
+
+private:
+    AnimationMode mode_ = AnimationMode::None;
+    uint64_t stepUs_ = 16667;
+    uint64_t originUs_ = 0;          // When step 0 was due
+    uint64_t step_ = 0;              // Steps taken since originUs_
+    std::vector<uint16_t> cycle_;    // Periodic modes: the frame for each step of one period
+    uint64_t cycleOffset_ = 0;       // Periodic modes: position in the period at step 0
+    uint64_t openSteps_ = 1;         // Expanding gap: steps from closed to fully open
+    uint64_t position_ = 0;          // Expanding gap: steps open so far
+    bool held_ = false;
+    size_t frameCount_ = 0;
+    size_t frame_ = 0;
+    uint64_t lastLatenessUs_ = 0;
+    AnimationStats stats_;
+};
@@ -0,0 +1,266 @@
+// AdrixCH - Crosshair codes: the compact text form users paste to share a crosshair.
+
+#include "CrosshairCode.h"
+
+#include <array>
+#include <type_traits>
+
+namespace {
+
+constexpr char kAlphabet[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+constexpr uint8_t kInvalid = 0xFF;
+constexpr size_t kV1Bytes = 11;
+constexpr size_t kV2Bytes = 13;
+
+// Character -> 5-bit value for the base32 alphabet, including lowercase and Crockford aliases
+constexpr std::array<uint8_t, 128> MakeBase32Table() {
+    std::array<uint8_t, 128> table{};
+    for (uint8_t& v : table) v = kInvalid;
+    for (uint8_t i = 0; i < 32; i++) {
+        const char c = kAlphabet[i];
+        table[(uint8_t)c] = i;
+        if (c >= 'A' && c <= 'Z') table[(uint8_t)(c - 'A' + 'a')] = i;
+    }
+    table['O'] = table['o'] = 0;
+    table['I'] = table['i'] = table['L'] = table['l'] = 1;
+    return table;
+}
+
+// Character -> value for the legacy decimal/hex fields
+constexpr std::array<uint8_t, 128> MakeHexTable() {
+    std::array<uint8_t, 128> table{};
+    for (uint8_t& v : table) v = kInvalid;
+    for (uint8_t i = 0; i < 10; i++) table['0' + i] = i;
+    for (uint8_t i = 0; i < 6; i++) table['A' + i] = table['a' + i] = (uint8_t)(10 + i);
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> MakeCrc8Table() {
+    std::array<uint8_t, 256> table{};
+    for (int i = 0; i < 256; i++) {
+        uint8_t crc = (uint8_t)i;
+        for (int bit = 0; bit < 8; bit++) crc = (uint8_t)((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr auto kBase32 = MakeBase32Table();
+constexpr auto kHex = MakeHexTable();
+constexpr auto kCrc8 = MakeCrc8Table();
+
+template <typename CharT>
+uint8_t Lookup(const std::array<uint8_t, 128>& table, CharT c) {
+    const auto code = static_cast<std::make_unsigned_t<CharT>>(c);
+    return code < 128 ? table[code] : kInvalid;
+}
+
+int Clamp(int value, int lo, int hi) {
+    return value < lo ? lo : (value > hi ? hi : value);
+}
+
+// The 72-bit payload is handled as a 64-bit head (length..fill, then the top 18 bits of the outline
+// color field) and one tail byte, so packing is a handful of shifts instead of a bit loop.
+void PackPayload(const CrosshairSettings& s, uint8_t* out) {
+    const uint64_t fields = ((uint64_t)Clamp(s.len, kLengthMin, kLengthMax) << 40) |
+        ((uint64_t)Clamp(s.gap, kGapMin, kGapMax) << 34) |
+        ((uint64_t)Clamp(s.thickness, kThicknessMin, kThicknessMax) << 29) |
+        ((uint64_t)Clamp(s.outlineThickness, kOutlineMin, kOutlineMax) << 25) |
+        ((uint64_t)(s.centerDot ? 1 : 0) << 24) |
+        (uint64_t)(s.fillColor & 0xFFFFFF);                // 46 bits
+    const uint32_t tail = (s.outlineColor & 0xFFFFFF) << 2; // 24 bits + 2 reserved zero bits
+    const uint64_t head = (fields << 18) | (tail >> 8);
+    for (int i = 0; i < 8; i++) out[i] = (uint8_t)(head >> (56 - 8 * i));
+    out[8] = (uint8_t)tail;
+}
+
+// Returns false if the reserved bits are set
+bool UnpackPayload(const uint8_t* in, CrosshairSettings& s) {
+    uint64_t head = 0;
+    for (int i = 0; i < 8; i++) head = (head << 8) | in[i];
+    const uint32_t tail = (uint32_t)((head & 0x3FFFF) << 8) | in[8];
+    const uint64_t fields = head >> 18;
+
+    s.len = (int)((fields >> 40) & 0x3F);
+    s.gap = (int)((fields >> 34) & 0x3F);
+    s.thickness = (int)((fields >> 29) & 0x1F);
+    s.outlineThickness = (int)((fields >> 25) & 0xF);
+    s.centerDot = ((fields >> 24) & 1) != 0;
+    s.fillColor = (uint32_t)(fields & 0xFFFFFF);
+    s.outlineColor = tail >> 2;
+    s.rotation = 0;
+    s.tStyle = false;
+    s.circleRadius = 0;
+    return (tail & 3) == 0;
+}
+
+bool HasVersion2Fields(const CrosshairSettings& s) {
+    return s.rotation != 0 || s.tStyle || s.circleRadius != 0;
+}
+
+void PackExtension(const CrosshairSettings& s, uint8_t* out) {
+    const uint16_t fields = (uint16_t)((Clamp(s.rotation, kRotationMin, kRotationMax) << 7) | ((s.tStyle ? 1 : 0) << 6) |
+        Clamp(s.circleRadius, kCircleRadiusMin, kCircleRadiusMax));
+    out[0] = (uint8_t)(fields >> 8);
+    out[1] = (uint8_t)fields;
+}
+
+void UnpackExtension(const uint8_t* in, CrosshairSettings& s) {
+    const uint16_t fields = (uint16_t)((in[0] << 8) | in[1]);
+    s.rotation = fields >> 7;
+    s.tStyle = ((fields >> 6) & 1) != 0;
+    s.circleRadius = fields & 0x3F;
+}
+
+template <typename CharT>
+size_t Encode(const CrosshairSettings& s, CharT* out, size_t capacity) {
+    const bool extended = HasVersion2Fields(s);
+    if (capacity <= (extended ? kExtendedCrosshairCodeLength : kCrosshairCodeLength)) return 0;
+
+    uint8_t bytes[kV2Bytes] = {};
+    const size_t size = extended ? kV2Bytes : kV1Bytes;
+    bytes[0] = extended ? 2 : 1;
+    PackPayload(s, bytes + 1);
+    if (extended) PackExtension(s, bytes + 1 + 9);
+
+    uint8_t crc = 0;
+    for (size_t i = 0; i < size - 1; i++) crc = kCrc8[crc ^ bytes[i]];
+    bytes[size - 1] = crc;
+
+    // 88 bits -> 18 base32 digits padded with two zero bits, or 104 bits -> 21 digits padded with one
+    uint32_t acc = 0;
+    int bits = 0;
+    size_t pos = 0;
+    for (size_t i = 0; i < size; i++) {
+        acc = (acc << 8) | bytes[i];
+        bits += 8;
+        while (bits >= 5) { bits -= 5; out[pos++] = (CharT)kAlphabet[(acc >> bits) & 31]; }
+    }
+    out[pos++] = (CharT)kAlphabet[(acc << (5 - bits)) & 31];
+    out[pos] = CharT(0);
+    return pos;
+}
+
+template <typename CharT>
+CrosshairCodeStatus DecodeCurrent(std::basic_string_view<CharT> code, CrosshairSettings& settings) {
+    uint8_t bytes[kV2Bytes] = {};
+    size_t size = 0; // Decided by the version byte
+    uint32_t acc = 0;
+    int bits = 0;
+    size_t count = 0;
+    uint8_t crc = 0;
+    for (CharT c : code) {
+        const uint8_t v = Lookup(kBase32, c);
+        if (v == kInvalid) return CrosshairCodeStatus::BadCharacter;
+        acc = (acc << 5) | v;
+        bits += 5;
+        if (bits >= 8) {
+            bits -= 8;
+            const uint8_t byte = (uint8_t)(acc >> bits);
+            // The version decides how long the code must be, so check it as soon as it is known
+            if (count == 0) {
+                if (byte == 1) size = kV1Bytes;
+                else if (byte == kCrosshairCodeVersion) size = kV2Bytes;
+                else return CrosshairCodeStatus::UnknownVersion;
+            }
+            if (count == size) return CrosshairCodeStatus::BadLength;
+            if (count < size - 1) crc = kCrc8[crc ^ byte];
+            bytes[count++] = byte;
+        }
+    }
+    if (size == 0 || count != size || (acc & ((1u << bits) - 1)) != 0) return CrosshairCodeStatus::BadLength;
+    if (crc != bytes[size - 1]) return CrosshairCodeStatus::BadChecksum;
+
+    CrosshairSettings decoded = settings;
+    if (!UnpackPayload(bytes + 1, decoded)) return CrosshairCodeStatus::OutOfRange;
+    if (size == kV2Bytes) UnpackExtension(bytes + 1 + 9, decoded);
+    if (!IsCrosshairSettingsInRange(decoded)) return CrosshairCodeStatus::OutOfRange;
+
+    settings = decoded;
+    return CrosshairCodeStatus::Ok;
+}
+
+// LLGGTTOOD-FFFFFF-OOOOOO
+template <typename CharT>
+CrosshairCodeStatus DecodeLegacy(std::basic_string_view<CharT> code, CrosshairSettings& settings) {
+    int decimal[5] = {};
+    uint32_t hex[2] = {};
+    for (size_t i = 0; i < kLegacyCrosshairCodeLength; i++) {
+        const CharT c = code[i];
+        if (i == 9 || i == 16) {
+            if (c != CharT('-')) return CrosshairCodeStatus::BadCharacter;
+            continue;
+        }
+        const uint8_t v = Lookup(kHex, c);
+        if (i < 9) {
+            if (v > 9) return CrosshairCodeStatus::BadCharacter;
+            if (i == 8) decimal[4] = v;
+            else decimal[i / 2] = decimal[i / 2] * 10 + v;
+        }
+        else {
+            if (v == kInvalid) return CrosshairCodeStatus::BadCharacter;
+            hex[i > 16] = (hex[i > 16] << 4) | v;
+        }
+    }
+    if (decimal[4] > 1) return CrosshairCodeStatus::BadCharacter;
+
+    CrosshairSettings decoded = settings;
+    decoded.len = decimal[0];
+    decoded.gap = decimal[1];
+    decoded.thickness = decimal[2];
+    decoded.outlineThickness = decimal[3];
+    decoded.centerDot = decimal[4] != 0;
+    decoded.fillColor = hex[0];
+    decoded.outlineColor = hex[1];
+    decoded.rotation = 0;
+    decoded.tStyle = false;
+    decoded.circleRadius = 0;
+    if (!IsCrosshairSettingsInRange(decoded)) return CrosshairCodeStatus::OutOfRange;
+
+    settings = decoded;
+    return CrosshairCodeStatus::Ok;
+}
+
+template <typename CharT>
+CrosshairCodeStatus Decode(std::basic_string_view<CharT> code, CrosshairSettings& settings) {
+    auto blank = [](CharT c) { return c == CharT(' ') || c == CharT('\t') || c == CharT('\r') || c == CharT('\n'); };
+    while (!code.empty() && blank(code.front())) code.remove_prefix(1);
+    while (!code.empty() && blank(code.back())) code.remove_suffix(1);
+
+    if (code.size() == kLegacyCrosshairCodeLength) return DecodeLegacy(code, settings);
+    if (code.size() < 2 || code.size() > kCrosshairCodeBufferSize) return CrosshairCodeStatus::BadLength;
+    return DecodeCurrent(code, settings);
+}
+
+} // namespace
+
+size_t EncodeCrosshairCode(const CrosshairSettings& settings, wchar_t* out, size_t capacity) {
+    return Encode(settings, out, capacity);
+}
+
+size_t EncodeCrosshairCode(const CrosshairSettings& settings, char* out, size_t capacity) {
+    return Encode(settings, out, capacity);
+}
+
+CrosshairCodeStatus DecodeCrosshairCode(std::wstring_view code, CrosshairSettings& settings) {
+    return Decode(code, settings);
+}
+
+CrosshairCodeStatus DecodeCrosshairCode(std::string_view code, CrosshairSettings& settings) {
+    return Decode(code, settings);
+}
+
+std::wstring GetCrosshairCode(const CrosshairSettings& settings) {
+    wchar_t buf[kCrosshairCodeBufferSize];
+    const size_t length = EncodeCrosshairCode(settings, buf, kCrosshairCodeBufferSize);
+    return std::wstring(buf, length);
+}
+
+bool IsValidCrosshairCode(std::wstring_view code) {
+    CrosshairSettings scratch;
+    return DecodeCrosshairCode(code, scratch) == CrosshairCodeStatus::Ok;
+}
+
+bool LoadCrosshairCode(std::wstring_view code, CrosshairSettings& settings) {
+    return DecodeCrosshairCode(code, settings) == CrosshairCodeStatus::Ok;
+}
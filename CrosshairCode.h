@@ -0,0 +1,54 @@
+// AdrixCH - Crosshair codes: the compact text form users paste to share a crosshair.
+//
+// Current codes are a version byte, a bit-packed payload and a CRC-8, written in Crockford base32
+// (case-insensitive, O/I/L accepted as 0/1/1). Version 1 is 18 characters:
+//   byte 0     version (1)
+//   bytes 1-9  length:6 gap:6 thickness:5 outline:4 centerDot:1 fill:24 outlineColor:24, 2 zero bits
+//   byte 10    CRC-8 (poly 0x07) over bytes 0-9
+// Version 2 is 21 characters and only written for crosshairs that use rotation, T-style or a ring:
+//   byte 0     version (2)
+//   bytes 1-9  as version 1
+//   bytes 10-11 rotation:9 tStyle:1 circleRadius:6
+//   byte 12    CRC-8 over bytes 0-11
+// Legacy 23-character codes (LLGGTTOOD-FFFFFF-OOOOOO) are still accepted by the decoder.
+// Encoding, decoding and validation run in one pass over the text and never allocate.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "CrosshairSettings.h"
+
+constexpr uint8_t kCrosshairCodeVersion = 2;             // Newest version understood
+constexpr size_t kCrosshairCodeLength = 18;              // Version 1
+constexpr size_t kExtendedCrosshairCodeLength = 21;      // Version 2
+constexpr size_t kLegacyCrosshairCodeLength = 23;
+constexpr size_t kCrosshairCodeBufferSize = 32;   // Enough for any code plus terminator
+
+enum class CrosshairCodeStatus : uint8_t {
+    Ok,
+    BadLength,
+    BadCharacter,
+    BadChecksum,
+    UnknownVersion,
+    OutOfRange,
+};
+
+// Write the code for settings: version 1 unless a version 2 field is in use (values are clamped to the slider ranges).
+// Returns the length written excluding the terminator, or 0 if capacity is too small.
+size_t EncodeCrosshairCode(const CrosshairSettings& settings, wchar_t* out, size_t capacity);
+size_t EncodeCrosshairCode(const CrosshairSettings& settings, char* out, size_t capacity);
+
+// Validate and decode a current or legacy code. Surrounding blanks are ignored. On success the
+// fields carried by the code are written to settings (version 1 and legacy codes reset the version 2
+// fields to their defaults); on failure settings is left untouched.
+CrosshairCodeStatus DecodeCrosshairCode(std::wstring_view code, CrosshairSettings& settings);
+CrosshairCodeStatus DecodeCrosshairCode(std::string_view code, CrosshairSettings& settings);
+
+// Convenience wrapper that returns a new string; paths that must not allocate encode into a fixed buffer instead
+std::wstring GetCrosshairCode(const CrosshairSettings& settings);
+bool IsValidCrosshairCode(std::wstring_view code);
+bool LoadCrosshairCode(std::wstring_view code, CrosshairSettings& settings);
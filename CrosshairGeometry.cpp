@@ -0,0 +1,42 @@
+// AdrixCH - Crosshair geometry: turns settings into the rectangles that make up the crosshair.
+
+#include "CrosshairGeometry.h"
+
+#include <algorithm>
+
+#include "CrosshairShapes.h"
+
+int ComputeCrosshairRects(const CrosshairSettings& settings, CrosshairRect (&rects)[kMaxCrosshairRects]) {
+    const int len = settings.len;
+    const int gap = settings.gap;
+    const int half = settings.thickness;
+
+    int count = 0;
+    rects[count++] = { -len - gap, -half, -gap, half };                           // left
+    rects[count++] = { gap, -half, len + gap, half };                             // right
+    if (!settings.tStyle) rects[count++] = { -half, -len - gap, half, -gap };    // top
+    rects[count++] = { -half, gap, half, len + gap };                             // bottom
+    if (settings.centerDot) rects[count++] = { -half, -half, half, half };
+    return count;
+}
+
+CrosshairRect ComputeCrosshairBounds(const CrosshairSettings& settings) {
+    const int outline = std::max(settings.outlineThickness, 0);
+    if (UsesShapeEngine(settings)) {
+        CrosshairShapes shapes;
+        CompileCrosshairShapes(settings, shapes);
+        return ComputeShapeBounds(shapes, (float)outline);
+    }
+
+    CrosshairRect rects[kMaxCrosshairRects];
+    const int count = ComputeCrosshairRects(settings, rects);
+
+    CrosshairRect bounds = { 0, 0, 1, 1 };
+    for (int i = 0; i < count; i++) {
+        bounds.left = std::min(bounds.left, rects[i].left - outline);
+        bounds.top = std::min(bounds.top, rects[i].top - outline);
+        bounds.right = std::max(bounds.right, rects[i].right + outline);
+        bounds.bottom = std::max(bounds.bottom, rects[i].bottom + outline);
+    }
+    return bounds;
+}
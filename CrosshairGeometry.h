@@ -0,0 +1,40 @@
+// AdrixCH - Crosshair geometry: turns settings into the rectangles that make up the crosshair.
+
+#pragma once
+
+#include "CrosshairSettings.h"
+
+// Half-open integer rectangle [left, right) x [top, bottom), same convention as a Win32 RECT.
+struct CrosshairRect {
+    int left, top, right, bottom;
+};
+
+constexpr int kMaxCrosshairRects = 5; // Four arms plus the optional center dot
+
+// Fill rectangles of each element relative to the crosshair center (0, 0). Returns the number written.
+// Rotation and the ring are not represented; settings that use them are drawn through CrosshairShapes.
+int ComputeCrosshairRects(const CrosshairSettings& settings, CrosshairRect (&rects)[kMaxCrosshairRects]);
+
+// Bounding box of everything that gets drawn (fill plus outline) relative to the crosshair center.
+// Always contains the center pixel so the box never collapses when the gap is large.
+CrosshairRect ComputeCrosshairBounds(const CrosshairSettings& settings);
+
+constexpr bool IsEmptyCrosshairRect(const CrosshairRect& r) {
+    return r.right <= r.left || r.bottom <= r.top;
+}
+
+constexpr bool operator==(const CrosshairRect& a, const CrosshairRect& b) {
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+constexpr CrosshairRect OffsetCrosshairRect(const CrosshairRect& r, int dx, int dy) {
+    return { r.left + dx, r.top + dy, r.right + dx, r.bottom + dy };
+}
+
+// Smallest rectangle covering both; an empty side is ignored
+constexpr CrosshairRect UnionCrosshairRects(const CrosshairRect& a, const CrosshairRect& b) {
+    if (IsEmptyCrosshairRect(a)) return b;
+    if (IsEmptyCrosshairRect(b)) return a;
+    return { a.left < b.left ? a.left : b.left, a.top < b.top ? a.top : b.top,
+             a.right > b.right ? a.right : b.right, a.bottom > b.bottom ? a.bottom : b.bottom };
+}
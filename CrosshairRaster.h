@@ -0,0 +1,30 @@
+// AdrixCH - Portable software rasterizer producing the crosshair as a premultiplied BGRA sprite.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CrosshairSettings.h"
+
+// Top-down 32-bit BGRA image (one uint32_t per pixel, 0xAARRGGBB in memory order B, G, R, A), with color
+// premultiplied by alpha as UpdateLayeredWindow expects. Transparent pixels are 0.
+struct CrosshairSprite {
+    int width = 0;
+    int height = 0;
+    int originX = 0; // Position of the crosshair center inside the sprite
+    int originY = 0;
+    std::vector<uint32_t> pixels;
+};
+
+// Convert a COLORREF (0x00BBGGRR) into an opaque premultiplied BGRA pixel.
+constexpr uint32_t ColorRefToPixel(uint32_t color) {
+    return 0xFF000000u | ((color & 0xFFu) << 16) | (color & 0xFF00u) | ((color >> 16) & 0xFFu);
+}
+
+// Fill count pixels starting at dst with value.
+void FillSpan(uint32_t* dst, int count, uint32_t value);
+
+// Render the crosshair into sprite. The pixel buffer is reused, so repeated calls with
+// settings of the same or smaller size do not allocate.
+void RasterizeCrosshair(const CrosshairSettings& settings, CrosshairSprite& sprite);
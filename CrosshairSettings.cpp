@@ -0,0 +1,107 @@
+// AdrixCH - Crosshair settings shared by the overlay, the rasterizer and the code helpers.
+
+#include "CrosshairSettings.h"
+
+static const char* const kFieldKeys[kCrosshairFieldCount] = {
+    "Length", "GapSize", "Thickness", "OutlineThickness", "CenterDot", "FillColor", "OutlineColor",
+    "Rotation", "TStyle", "CircleRadius",
+};
+
+const char* CrosshairFieldKey(CrosshairField field) {
+    const size_t index = static_cast<size_t>(field);
+    return index < kCrosshairFieldCount ? kFieldKeys[index] : "";
+}
+
+bool ParseSettingsInteger(std::string_view text, long long& value) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) text.remove_suffix(1);
+
+    bool negative = false;
+    if (!text.empty() && (text.front() == '-' || text.front() == '+')) { negative = text.front() == '-'; text.remove_prefix(1); }
+    if (text.empty() || text.size() > 10) return false;
+
+    long long result = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        result = result * 10 + (c - '0');
+    }
+    value = negative ? -result : result;
+    return true;
+}
+
+bool ParseCrosshairField(CrosshairSettings& settings, CrosshairField field, std::string_view text) {
+    long long value = 0;
+    return ParseSettingsInteger(text, value) && SetCrosshairField(settings, field, value);
+}
+
+bool SetCrosshairField(CrosshairSettings& settings, CrosshairField field, long long value) {
+    switch (field) {
+    case CrosshairField::Length: if (value < 0 || value > 255) return false; settings.len = (int)value; return true;
+    case CrosshairField::GapSize: if (value < 0 || value > 255) return false; settings.gap = (int)value; return true;
+    case CrosshairField::Thickness: if (value < 0 || value > 255) return false; settings.thickness = (int)value; return true;
+    case CrosshairField::OutlineThickness: if (value < 0 || value > 255) return false; settings.outlineThickness = (int)value; return true;
+    case CrosshairField::CenterDot: settings.centerDot = (value == 1); return true;
+    case CrosshairField::FillColor: if (value < 0 || value > 0xFFFFFF) return false; settings.fillColor = (uint32_t)value; return true;
+    case CrosshairField::OutlineColor: if (value < 0 || value > 0xFFFFFF) return false; settings.outlineColor = (uint32_t)value; return true;
+    case CrosshairField::Rotation: if (value < kRotationMin || value > kRotationMax) return false; settings.rotation = (int)value; return true;
+    case CrosshairField::TStyle: settings.tStyle = (value == 1); return true;
+    case CrosshairField::CircleRadius: if (value < kCircleRadiusMin || value > kCircleRadiusMax) return false; settings.circleRadius = (int)value; return true;
+    default: return false;
+    }
+}
+
+uint32_t DiffCrosshairSettings(const CrosshairSettings& a, const CrosshairSettings& b) {
+    uint32_t fields = 0;
+    if (a.len != b.len) fields |= CrosshairFieldBit(CrosshairField::Length);
+    if (a.gap != b.gap) fields |= CrosshairFieldBit(CrosshairField::GapSize);
+    if (a.thickness != b.thickness) fields |= CrosshairFieldBit(CrosshairField::Thickness);
+    if (a.outlineThickness != b.outlineThickness) fields |= CrosshairFieldBit(CrosshairField::OutlineThickness);
+    if (a.centerDot != b.centerDot) fields |= CrosshairFieldBit(CrosshairField::CenterDot);
+    if (a.fillColor != b.fillColor) fields |= CrosshairFieldBit(CrosshairField::FillColor);
+    if (a.outlineColor != b.outlineColor) fields |= CrosshairFieldBit(CrosshairField::OutlineColor);
+    if (a.rotation != b.rotation) fields |= CrosshairFieldBit(CrosshairField::Rotation);
+    if (a.tStyle != b.tStyle) fields |= CrosshairFieldBit(CrosshairField::TStyle);
+    if (a.circleRadius != b.circleRadius) fields |= CrosshairFieldBit(CrosshairField::CircleRadius);
+    return fields;
+}
+
+void CopyCrosshairFields(CrosshairSettings& target, const CrosshairSettings& source, uint32_t fields) {
+    auto has = [fields](CrosshairField field) { return (fields & CrosshairFieldBit(field)) != 0; };
+    if (has(CrosshairField::Length)) target.len = source.len;
+    if (has(CrosshairField::GapSize)) target.gap = source.gap;
+    if (has(CrosshairField::Thickness)) target.thickness = source.thickness;
+    if (has(CrosshairField::OutlineThickness)) target.outlineThickness = source.outlineThickness;
+    if (has(CrosshairField::CenterDot)) target.centerDot = source.centerDot;
+    if (has(CrosshairField::FillColor)) target.fillColor = source.fillColor;
+    if (has(CrosshairField::OutlineColor)) target.outlineColor = source.outlineColor;
+    if (has(CrosshairField::Rotation)) target.rotation = source.rotation;
+    if (has(CrosshairField::TStyle)) target.tStyle = source.tStyle;
+    if (has(CrosshairField::CircleRadius)) target.circleRadius = source.circleRadius;
+}
+
+size_t FormatCrosshairField(const CrosshairSettings& settings, CrosshairField field, char* buffer, size_t capacity) {
+    unsigned long value = 0;
+    switch (field) {
+    case CrosshairField::Length: value = (unsigned long)settings.len; break;
+    case CrosshairField::GapSize: value = (unsigned long)settings.gap; break;
+    case CrosshairField::Thickness: value = (unsigned long)settings.thickness; break;
+    case CrosshairField::OutlineThickness: value = (unsigned long)settings.outlineThickness; break;
+    case CrosshairField::CenterDot: value = settings.centerDot ? 1 : 0; break;
+    case CrosshairField::FillColor: value = settings.fillColor; break;
+    case CrosshairField::OutlineColor: value = settings.outlineColor; break;
+    case CrosshairField::Rotation: value = (unsigned long)settings.rotation; break;
+    case CrosshairField::TStyle: value = settings.tStyle ? 1 : 0; break;
+    case CrosshairField::CircleRadius: value = (unsigned long)settings.circleRadius; break;
+    default: break;
+    }
+
+    // Digits are produced backwards into a scratch buffer, then copied out
+    char digits[16];
+    size_t count = 0;
+    do { digits[count++] = (char)('0' + value % 10); value /= 10; } while (value != 0);
+    if (capacity == 0) return 0;
+    if (count >= capacity) count = capacity - 1;
+    for (size_t i = 0; i < count; i++) buffer[i] = digits[count - 1 - i];
+    buffer[count] = '\0';
+    return count;
+}
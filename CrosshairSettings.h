@@ -0,0 +1,102 @@
+// AdrixCH - Crosshair settings shared by the overlay, the rasterizer and the code helpers.
+// Kept free of Win32 types so the core can be built and tested on any platform.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Colors use the COLORREF layout (0x00BBGGRR) so values can be passed straight to GDI.
+struct CrosshairSettings {
+    int len = 7;               // Arm length in pixels
+    int gap = 1;               // Distance from the center to the start of each arm
+    int thickness = 2;         // Half the arm width in pixels: arms, dot and ring stroke are 2 * thickness wide
+    int outlineThickness = 1;  // Outline width around every element (0 = no outline)
+    bool centerDot = false;
+    uint32_t fillColor = 0x00FFFF;
+    uint32_t outlineColor = 0x010000;
+    int rotation = 0;          // Clockwise, in degrees
+    bool tStyle = false;       // Leave out the top arm
+    int circleRadius = 0;      // Ring around the center, stroked as wide as the arms (0 = no ring)
+
+    bool operator==(const CrosshairSettings&) const = default;
+};
+
+// Ranges offered by the settings sliders; crosshair codes only carry values inside them
+constexpr int kLengthMin = 2, kLengthMax = 50;
+constexpr int kGapMin = 0, kGapMax = 50;
+constexpr int kThicknessMin = 1, kThicknessMax = 20;
+constexpr int kOutlineMin = 0, kOutlineMax = 10;
+constexpr int kRotationMin = 0, kRotationMax = 359;
+constexpr int kCircleRadiusMin = 0, kCircleRadiusMax = 50;
+
+constexpr bool IsCrosshairSettingsInRange(const CrosshairSettings& s) {
+    return s.len >= kLengthMin && s.len <= kLengthMax && s.gap >= kGapMin && s.gap <= kGapMax &&
+        s.thickness >= kThicknessMin && s.thickness <= kThicknessMax &&
+        s.outlineThickness >= kOutlineMin && s.outlineThickness <= kOutlineMax &&
+        s.fillColor <= 0xFFFFFF && s.outlineColor <= 0xFFFFFF &&
+        s.rotation >= kRotationMin && s.rotation <= kRotationMax &&
+        s.circleRadius >= kCircleRadiusMin && s.circleRadius <= kCircleRadiusMax;
+}
+
+// 64-bit hash of the settings tuple (the same fields the crosshair code serializes).
+// Suitable as a cache key; equal settings always hash equally, collisions are possible.
+constexpr uint64_t HashCrosshairSettings(const CrosshairSettings& s) {
+    const uint64_t geometry = (uint64_t)(uint8_t)s.len | ((uint64_t)(uint8_t)s.gap << 8) |
+        ((uint64_t)(uint8_t)s.thickness << 16) | ((uint64_t)(uint8_t)s.outlineThickness << 24) |
+        ((uint64_t)(s.centerDot ? 1 : 0) << 32) | ((uint64_t)(s.tStyle ? 1 : 0) << 33) |
+        ((uint64_t)(uint16_t)s.rotation << 34) | ((uint64_t)(uint8_t)s.circleRadius << 50);
+    const uint64_t colors = (uint64_t)(s.fillColor & 0xFFFFFF) | ((uint64_t)(s.outlineColor & 0xFFFFFF) << 24);
+
+    // Two rounds of a 64-bit finalizer (splitmix64) over both words
+    uint64_t h = geometry * 0x9E3779B97F4A7C15ull ^ colors;
+    h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27; h *= 0x94D049BB133111EBull;
+    h ^= h >> 31;
+    return h;
+}
+
+// Persisted fields, in the order they appear in the [Crosshair] INI section
+enum class CrosshairField : uint8_t {
+    Length,
+    GapSize,
+    Thickness,
+    OutlineThickness,
+    CenterDot,
+    FillColor,
+    OutlineColor,
+    Rotation,
+    TStyle,
+    CircleRadius,
+    Count
+};
+
+constexpr size_t kCrosshairFieldCount = static_cast<size_t>(CrosshairField::Count);
+
+// Sets of fields, one bit per CrosshairField
+constexpr uint32_t CrosshairFieldBit(CrosshairField field) { return 1u << static_cast<uint32_t>(field); }
+constexpr uint32_t kAllCrosshairFields = (1u << kCrosshairFieldCount) - 1;
+
+// INI key name of a field, e.g. "GapSize"
+const char* CrosshairFieldKey(CrosshairField field);
+
+// Decimal integer with optional sign and surrounding blanks, the format of values in the INI file (SettingsStore)
+bool ParseSettingsInteger(std::string_view text, long long& value);
+
+// Parse an INI value into the field. Returns false and leaves settings untouched if the text is
+// malformed or out of range; never throws.
+bool ParseCrosshairField(CrosshairSettings& settings, CrosshairField field, std::string_view text);
+
+// Set a field to an integer value, with the same ranges the INI accepts. Returns false and leaves settings
+// untouched if the value is out of range.
+bool SetCrosshairField(CrosshairSettings& settings, CrosshairField field, long long value);
+
+// Fields whose values differ between a and b
+uint32_t DiffCrosshairSettings(const CrosshairSettings& a, const CrosshairSettings& b);
+
+// Copy only the given fields from source into target
+void CopyCrosshairFields(CrosshairSettings& target, const CrosshairSettings& source, uint32_t fields);
+
+// Format a field the way it is stored in the INI (decimal). Returns the length written, excluding the terminator.
+size_t FormatCrosshairField(const CrosshairSettings& settings, CrosshairField field, char* buffer, size_t capacity);
@@ -0,0 +1,613 @@
+// AdrixCH - Anti-aliased shape engine for rotated and ring crosshairs.
+
+#include "CrosshairShapes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define ADRIXCH_HAS_SSE2 1
+#define ADRIXCH_HAS_AVX 1 // Compiled in with a target attribute; only called if the CPU reports AVX
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define ADRIXCH_TARGET_AVX
+#else
+#define ADRIXCH_TARGET_AVX __attribute__((target("avx")))
+#endif
+#endif
+
+namespace {
+
+// A primitive with the grow distance and pixel footprint folded in, as the kernels consume it.
+// A unit pixel projected onto an edge normal (nx, ny) is a trapezoid: p = max(|nx|, |ny|) and
+// q = min(|nx|, |ny|) give a flat top of half width e = (p - q) / 2 and feet of half width f = (p + q) / 2.
+// Its integral (SlabCdf) gives the exact fraction of the pixel on one side of an edge.
+struct PreparedShape {
+    ShapeKind kind;
+    float centerX, centerY;
+    float axisX, axisY;
+    float half0;     // Box: half length; Ring: stroke radius
+    float half1;     // Box: half width; Ring: half stroke width
+    float footHalf;  // Box: f; Ring: the largest f over all directions, for bounds and spans
+    float flatHalf;  // Box: e
+    float cdfScale;  // Box: 1 / (2pq)
+};
+
+using CoverageKernelFn = void (*)(const PreparedShape* shapes, int count, int y, int x0, int x1, float* coverage);
+
+// q never reaches 0 so the trapezoid formula stays finite; the error this adds is far below 1/255
+constexpr float kMinFootSlope = 1e-3f;
+constexpr float kRingFootHalf = 0.70711f;
+
+int Prepare(const CrosshairShapes& shapes, float grow, PreparedShape (&out)[kMaxCrosshairShapes]) {
+    for (int i = 0; i < shapes.count; i++) {
+        const ShapePrimitive& s = shapes.shapes[i];
+        PreparedShape& p = out[i];
+        p.kind = s.kind;
+        p.centerX = s.centerX;
+        p.centerY = s.centerY;
+        p.axisX = s.axisX;
+        p.axisY = s.axisY;
+        if (s.kind == ShapeKind::Box) {
+            const float major = std::max(std::fabs(s.axisX), std::fabs(s.axisY));
+            const float minor = std::max(std::min(std::fabs(s.axisX), std::fabs(s.axisY)), kMinFootSlope);
+            p.half0 = s.halfLength + grow;
+            p.half1 = s.halfWidth + grow;
+            p.footHalf = (major + minor) * 0.5f;
+            p.flatHalf = (major - minor) * 0.5f;
+            p.cdfScale = 0.5f / (major * minor);
+        }
+        else {
+            p.half0 = s.halfLength;
+            p.half1 = s.halfWidth + grow;
+            p.footHalf = kRingFootHalf;
+            p.flatHalf = 0;
+            p.cdfScale = 0;
+        }
+    }
+    return shapes.count;
+}
+
+// Fraction of a pixel whose projection lies below u, relative to the projection of its center
+inline float SlabCdf(float u, float e, float f, float scale) {
+    u = std::clamp(u, -f, f);
+    const float a = u + f, b = std::max(u + e, 0.0f), c = std::max(u - e, 0.0f);
+    return (a * a - b * b - c * c) * scale;
+}
+
+// Fraction of a pixel centered at t (projected) that falls inside [-half, half]
+inline float SlabCoverage(float t, float half, float e, float f, float scale) {
+    return std::max(0.0f, SlabCdf(half - t, e, f, scale) - SlabCdf(-half - t, e, f, scale));
+}
+
+// Coverage of a square cell of side cell (1 for a whole pixel) centered at (dx, dy) from the shape's center
+inline float CoverageAt(const PreparedShape& s, float dx, float dy, float cell) {
+    if (s.kind == ShapeKind::Box) {
+        const float along = dx * s.axisX + dy * s.axisY;
+        const float across = dy * s.axisX - dx * s.axisY;
+        const float e = s.flatHalf * cell, f = s.footHalf * cell, scale = s.cdfScale / (cell * cell);
+        return SlabCoverage(along, s.half0, e, f, scale) * SlabCoverage(across, s.half1, e, f, scale);
+    }
+    // The radial direction sets the footprint, so a ring is a slab along its own normal
+    const float distance = std::max(std::sqrt(dx * dx + dy * dy), 1e-6f);
+    const float nx = std::fabs(dx) / distance, ny = std::fabs(dy) / distance;
+    const float major = std::max(nx, ny) * cell, minor = std::max(std::min(nx, ny), kMinFootSlope) * cell;
+    return SlabCoverage(distance - s.half0, s.half1, (major - minor) * 0.5f, (major + minor) * 0.5f, 0.5f / (major * minor));
+}
+
+// The union of several shapes is the largest coverage, which is exact unless two shapes each cover only part
+// of the pixel. The kernels mark those pixels (where arms cross the ring or meet the dot) and ResolveCrossings
+// evaluates them again on a sub-pixel grid, where taking the largest coverage is accurate enough.
+constexpr float kCrossingMarker = -1.0f;
+constexpr float kCrossingEpsilon = 1e-4f;
+constexpr int kCrossingGrid = 4;
+
+void CoverageScalar(const PreparedShape* shapes, int count, int y, int x0, int x1, float* coverage) {
+    const float py = (float)y + 0.5f;
+    for (int x = x0; x < x1; x++) {
+        const float px = (float)x + 0.5f;
+        float c = 0.0f, sum = 0.0f;
+        for (int i = 0; i < count; i++) {
+            const float shape = CoverageAt(shapes[i], px - shapes[i].centerX, py - shapes[i].centerY, 1.0f);
+            c = std::max(c, shape);
+            sum += shape;
+        }
+        coverage[x - x0] = sum > c + kCrossingEpsilon && c < 1.0f - kCrossingEpsilon ? kCrossingMarker : c;
+    }
+}
+
+void ResolveCrossings(const PreparedShape* shapes, int count, int y, int x0, int x1, float* coverage) {
+    constexpr float cell = 1.0f / kCrossingGrid;
+    for (int x = x0; x < x1; x++) {
+        if (coverage[x - x0] != kCrossingMarker) continue;
+
+        // Only the shapes that partly cover the pixel matter on the sub-grid
+        PreparedShape partial[kMaxCrosshairShapes];
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            if (CoverageAt(shapes[i], (float)x + 0.5f - shapes[i].centerX, (float)y + 0.5f - shapes[i].centerY, 1.0f) > 0.0f) partial[n++] = shapes[i];
+        }
+
+        float total = 0.0f;
+        for (int sy = 0; sy < kCrossingGrid; sy++) {
+            const float py = (float)y + ((float)sy + 0.5f) * cell;
+            for (int sx = 0; sx < kCrossingGrid; sx++) {
+                const float px = (float)x + ((float)sx + 0.5f) * cell;
+                float c = 0.0f;
+                for (int i = 0; i < n; i++) c = std::max(c, CoverageAt(partial[i], px - partial[i].centerX, py - partial[i].centerY, cell));
+                total += c;
+            }
+        }
+        coverage[x - x0] = total * (cell * cell);
+    }
+}
+
+#ifdef ADRIXCH_HAS_SSE2
+inline __m128 SlabCdfSse2(__m128 u, __m128 e, __m128 f, __m128 scale) {
+    const __m128 zero = _mm_setzero_ps();
+    u = _mm_min_ps(_mm_max_ps(u, _mm_sub_ps(zero, f)), f);
+    const __m128 a = _mm_add_ps(u, f), b = _mm_max_ps(_mm_add_ps(u, e), zero), c = _mm_max_ps(_mm_sub_ps(u, e), zero);
+    return _mm_mul_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(a, a), _mm_mul_ps(b, b)), _mm_mul_ps(c, c)), scale);
+}
+
+inline __m128 SlabCoverageSse2(__m128 t, __m128 half, __m128 e, __m128 f, __m128 scale) {
+    const __m128 below = SlabCdfSse2(_mm_sub_ps(half, t), e, f, scale);
+    const __m128 above = SlabCdfSse2(_mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), half), t), e, f, scale);
+    return _mm_max_ps(_mm_setzero_ps(), _mm_sub_ps(below, above));
+}
+
+void CoverageSse2(const PreparedShape* shapes, int count, int y, int x0, int x1, float* coverage) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 lanes = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const float py = (float)y + 0.5f;
+    int x = x0;
+    for (; x + 4 <= x1; x += 4) {
+        const __m128 px = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+        __m128 c = zero, sum = zero;
+        for (int i = 0; i < count; i++) {
+            const PreparedShape& s = shapes[i];
+            const __m128 dx = _mm_sub_ps(px, _mm_set1_ps(s.centerX));
+            const float dy = py - s.centerY;
+            __m128 shape;
+            if (s.kind == ShapeKind::Box) {
+                const __m128 e = _mm_set1_ps(s.flatHalf), f = _mm_set1_ps(s.footHalf), scale = _mm_set1_ps(s.cdfScale);
+                const __m128 along = _mm_add_ps(_mm_mul_ps(dx, _mm_set1_ps(s.axisX)), _mm_set1_ps(dy * s.axisY));
+                const __m128 across = _mm_sub_ps(_mm_set1_ps(dy * s.axisX), _mm_mul_ps(dx, _mm_set1_ps(s.axisY)));
+                shape = _mm_mul_ps(SlabCoverageSse2(along, _mm_set1_ps(s.half0), e, f, scale),
+                    SlabCoverageSse2(across, _mm_set1_ps(s.half1), e, f, scale));
+            }
+            else {
+                const __m128 distance = _mm_max_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_set1_ps(dy * dy))), _mm_set1_ps(1e-6f));
+                const __m128 nx = _mm_div_ps(_mm_andnot_ps(signMask, dx), distance);
+                const __m128 ny = _mm_div_ps(_mm_set1_ps(std::fabs(dy)), distance);
+                const __m128 major = _mm_max_ps(nx, ny), minor = _mm_max_ps(_mm_min_ps(nx, ny), _mm_set1_ps(kMinFootSlope));
+                const __m128 half = _mm_set1_ps(0.5f);
+                shape = SlabCoverageSse2(_mm_sub_ps(distance, _mm_set1_ps(s.half0)), _mm_set1_ps(s.half1),
+                    _mm_mul_ps(_mm_sub_ps(major, minor), half), _mm_mul_ps(_mm_add_ps(major, minor), half), _mm_div_ps(half, _mm_mul_ps(major, minor)));
+            }
+            c = _mm_max_ps(c, shape);
+            sum = _mm_add_ps(sum, shape);
+        }
+        const __m128 crossing = _mm_and_ps(_mm_cmpgt_ps(sum, _mm_add_ps(c, _mm_set1_ps(kCrossingEpsilon))), _mm_cmplt_ps(c, _mm_set1_ps(1.0f - kCrossingEpsilon)));
+        c = _mm_or_ps(_mm_andnot_ps(crossing, c), _mm_and_ps(crossing, _mm_set1_ps(kCrossingMarker)));
+        _mm_storeu_ps(coverage + (x - x0), c);
+    }
+    if (x < x1) CoverageScalar(shapes, count, y, x, x1, coverage + (x - x0));
+}
+#endif
+
+#ifdef ADRIXCH_HAS_AVX
+ADRIXCH_TARGET_AVX inline __m256 SlabCdfAvx(__m256 u, __m256 e, __m256 f, __m256 scale) {
+    const __m256 zero = _mm256_setzero_ps();
+    u = _mm256_min_ps(_mm256_max_ps(u, _mm256_sub_ps(zero, f)), f);
+    const __m256 a = _mm256_add_ps(u, f), b = _mm256_max_ps(_mm256_add_ps(u, e), zero), c = _mm256_max_ps(_mm256_sub_ps(u, e), zero);
+    return _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(_mm256_mul_ps(a, a), _mm256_mul_ps(b, b)), _mm256_mul_ps(c, c)), scale);
+}
+
+ADRIXCH_TARGET_AVX inline __m256 SlabCoverageAvx(__m256 t, __m256 half, __m256 e, __m256 f, __m256 scale) {
+    const __m256 below = SlabCdfAvx(_mm256_sub_ps(half, t), e, f, scale);
+    const __m256 above = SlabCdfAvx(_mm256_sub_ps(_mm256_sub_ps(_mm256_setzero_ps(), half), t), e, f, scale);
+    return _mm256_max_ps(_mm256_setzero_ps(), _mm256_sub_ps(below, above));
+}
+
+ADRIXCH_TARGET_AVX void CoverageAvx(const PreparedShape* shapes, int count, int y, int x0, int x1, float* coverage) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 lanes = _mm256_set_ps(7.5f, 6.5f, 5.5f, 4.5f, 3.5f, 2.5f, 1.5f, 0.5f);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const float py = (float)y + 0.5f;
+    int x = x0;
+    for (; x + 8 <= x1; x += 8) {
+        const __m256 px = _mm256_add_ps(_mm256_set1_ps((float)x), lanes);
+        __m256 c = zero, sum = zero;
+        for (int i = 0; i < count; i++) {
+            const PreparedShape& s = shapes[i];
+            const __m256 dx = _mm256_sub_ps(px, _mm256_set1_ps(s.centerX));
+            const float dy = py - s.centerY;
+            __m256 shape;
+            if (s.kind == ShapeKind::Box) {
+                const __m256 e = _mm256_set1_ps(s.flatHalf), f = _mm256_set1_ps(s.footHalf), scale = _mm256_set1_ps(s.cdfScale);
+                const __m256 along = _mm256_add_ps(_mm256_mul_ps(dx, _mm256_set1_ps(s.axisX)), _mm256_set1_ps(dy * s.axisY));
+                const __m256 across = _mm256_sub_ps(_mm256_set1_ps(dy * s.axisX), _mm256_mul_ps(dx, _mm256_set1_ps(s.axisY)));
+                shape = _mm256_mul_ps(SlabCoverageAvx(along, _mm256_set1_ps(s.half0), e, f, scale),
+                    SlabCoverageAvx(across, _mm256_set1_ps(s.half1), e, f, scale));
+            }
+            else {
+                const __m256 distance = _mm256_max_ps(_mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_set1_ps(dy * dy))), _mm256_set1_ps(1e-6f));
+                const __m256 nx = _mm256_div_ps(_mm256_andnot_ps(signMask, dx), distance);
+                const __m256 ny = _mm256_div_ps(_mm256_set1_ps(std::fabs(dy)), distance);
+                const __m256 major = _mm256_max_ps(nx, ny), minor = _mm256_max_ps(_mm256_min_ps(nx, ny), _mm256_set1_ps(kMinFootSlope));
+                const __m256 half = _mm256_set1_ps(0.5f);
+                shape = SlabCoverageAvx(_mm256_sub_ps(distance, _mm256_set1_ps(s.half0)), _mm256_set1_ps(s.half1),
+                    _mm256_mul_ps(_mm256_sub_ps(major, minor), half), _mm256_mul_ps(_mm256_add_ps(major, minor), half), _mm256_div_ps(half, _mm256_mul_ps(major, minor)));
+            }
+            c = _mm256_max_ps(c, shape);
+            sum = _mm256_add_ps(sum, shape);
+        }
+        const __m256 crossing = _mm256_and_ps(_mm256_cmp_ps(sum, _mm256_add_ps(c, _mm256_set1_ps(kCrossingEpsilon)), _CMP_GT_OQ),
+            _mm256_cmp_ps(c, _mm256_set1_ps(1.0f - kCrossingEpsilon), _CMP_LT_OQ));
+        c = _mm256_blendv_ps(c, _mm256_set1_ps(kCrossingMarker), crossing);
+        _mm256_storeu_ps(coverage + (x - x0), c);
+    }
+    if (x < x1) CoverageSse2(shapes, count, y, x, x1, coverage + (x - x0));
+}
+
+bool CpuHasAvx() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+    return osSavesYmm && (info[2] & (1 << 28)) != 0;
+#else
+    return __builtin_cpu_supports("avx");
+#endif
+}
+#endif
+
+CoverageKernelFn KernelFunction(ShapeKernel kernel) {
+    switch (kernel) {
+#ifdef ADRIXCH_HAS_AVX
+    case ShapeKernel::Avx: return CoverageAvx;
+#endif
+#ifdef ADRIXCH_HAS_SSE2
+    case ShapeKernel::Sse2: return CoverageSse2;
+#endif
+    default: return CoverageScalar;
+    }
+}
+
+ShapeKernel BestShapeKernel() {
+    if (IsShapeKernelSupported(ShapeKernel::Avx)) return ShapeKernel::Avx;
+    if (IsShapeKernelSupported(ShapeKernel::Sse2)) return ShapeKernel::Sse2;
+    return ShapeKernel::Scalar;
+}
+
+ShapeKernel g_kernel = BestShapeKernel();
+CoverageKernelFn g_kernelFn = KernelFunction(g_kernel);
+
+// Narrow [lo, hi] to the t where |slope * t + offset| < limit; false if that leaves nothing
+bool SolveAbsLess(float slope, float offset, float limit, float& lo, float& hi) {
+    if (std::fabs(slope) < 1e-6f) return std::fabs(offset) < limit;
+    float t0 = (-limit - offset) / slope;
+    float t1 = (limit - offset) / slope;
+    if (t0 > t1) std::swap(t0, t1);
+    lo = std::max(lo, t0);
+    hi = std::min(hi, t1);
+    return lo < hi;
+}
+
+struct PixelInterval {
+    int x0, x1;
+    uint32_t shapes;
+};
+
+// Pixels whose centers may lie in (lo, hi), relative to the crosshair center
+PixelInterval ToPixels(float lo, float hi) {
+    return { (int)std::floor(lo - 0.5f), (int)std::ceil(hi - 0.5f), 0 };
+}
+
+// A pixel is touched only when its center is within half a footprint of the shape
+int RowIntervals(const PreparedShape& s, float py, PixelInterval* out) {
+    const float dy = py - s.centerY;
+    if (s.kind == ShapeKind::Box) {
+        float lo = -1e30f, hi = 1e30f;
+        if (!SolveAbsLess(s.axisX, dy * s.axisY, s.half0 + s.footHalf, lo, hi)) return 0;
+        if (!SolveAbsLess(-s.axisY, dy * s.axisX, s.half1 + s.footHalf, lo, hi)) return 0;
+        out[0] = ToPixels(s.centerX + lo, s.centerX + hi);
+        return 1;
+    }
+
+    const float outer = s.half0 + s.half1 + s.footHalf;
+    if (std::fabs(dy) >= outer) return 0;
+    const float outerX = std::sqrt(outer * outer - dy * dy);
+    const float inner = s.half0 - s.half1 - s.footHalf;
+    if (inner <= 0 || std::fabs(dy) >= inner) {
+        out[0] = ToPixels(s.centerX - outerX, s.centerX + outerX);
+        return 1;
+    }
+    const float innerX = std::sqrt(inner * inner - dy * dy);
+    out[0] = ToPixels(s.centerX - outerX, s.centerX - innerX);
+    out[1] = ToPixels(s.centerX + innerX, s.centerX + outerX);
+    return 2;
+}
+
+void ClearSprite(CrosshairSprite& sprite, const CrosshairRect& bounds) {
+    sprite.width = bounds.right - bounds.left;
+    sprite.height = bounds.bottom - bounds.top;
+    sprite.originX = -bounds.left;
+    sprite.originY = -bounds.top;
+    sprite.pixels.resize((size_t)sprite.width * sprite.height);
+    if (!sprite.pixels.empty()) std::memset(sprite.pixels.data(), 0, sprite.pixels.size() * sizeof(uint32_t));
+}
+
+// Premultiplied BGRA from fill coverage over outline coverage, channels in 0-255
+struct Palette {
+    float fill[3];    // B, G, R
+    float outline[3];
+};
+
+Palette MakePalette(const CrosshairSettings& settings) {
+    Palette palette;
+    for (int i = 0; i < 3; i++) {
+        palette.fill[i] = (float)((ColorRefToPixel(settings.fillColor) >> (8 * i)) & 0xFF);
+        palette.outline[i] = (float)((ColorRefToPixel(settings.outlineColor) >> (8 * i)) & 0xFF);
+    }
+    return palette;
+}
+
+inline uint32_t Composite(const Palette& palette, float fill, float outer) {
+    const float alpha = std::max(fill, outer);
+    if (alpha <= 0.0f) return 0;
+    const float edge = alpha - fill;
+    uint32_t pixel = (uint32_t)(alpha * 255.0f + 0.5f) << 24;
+    for (int i = 0; i < 3; i++) pixel |= (uint32_t)(fill * palette.fill[i] + edge * palette.outline[i] + 0.5f) << (8 * i);
+    return pixel;
+}
+
+bool InsideShape(const ShapePrimitive& s, float grow, float x, float y) {
+    const float dx = x - s.centerX, dy = y - s.centerY;
+    if (s.kind == ShapeKind::Box) {
+        return std::fabs(dx * s.axisX + dy * s.axisY) <= s.halfLength + grow &&
+            std::fabs(dy * s.axisX - dx * s.axisY) <= s.halfWidth + grow;
+    }
+    return std::fabs(std::sqrt(dx * dx + dy * dy) - s.halfLength) <= s.halfWidth + grow;
+}
+
+float SampleCoverage(const CrosshairShapes& shapes, float grow, int x, int y, int samplesPerAxis) {
+    int inside = 0;
+    for (int sy = 0; sy < samplesPerAxis; sy++) {
+        for (int sx = 0; sx < samplesPerAxis; sx++) {
+            const float px = (float)x + ((float)sx + 0.5f) / (float)samplesPerAxis;
+            const float py = (float)y + ((float)sy + 0.5f) / (float)samplesPerAxis;
+            for (int i = 0; i < shapes.count; i++) {
+                if (InsideShape(shapes.shapes[i], grow, px, py)) { inside++; break; }
+            }
+        }
+    }
+    return (float)inside / (float)(samplesPerAxis * samplesPerAxis);
+}
+
+} // namespace
+
+void CompileCrosshairShapes(const CrosshairSettings& settings, CrosshairShapes& out) {
+    out.count = 0;
+
+    // Exact axes for quarter turns so unrotated edges stay on pixel boundaries
+    const int degrees = ((settings.rotation % 360) + 360) % 360;
+    float c = 1.0f, s = 0.0f;
+    switch (degrees) {
+    case 0: break;
+    case 90: c = 0.0f; s = 1.0f; break;
+    case 180: c = -1.0f; break;
+    case 270: c = 0.0f; s = -1.0f; break;
+    default: {
+        const double radians = degrees * 3.14159265358979323846 / 180.0;
+        c = (float)std::cos(radians);
+        s = (float)std::sin(radians);
+        break;
+    }
+    }
+
+    // Arms point right, down, left and up before rotating; screen y grows downwards, so rotation is clockwise
+    const float directions[4][2] = { { c, s }, { -s, c }, { -c, -s }, { s, -c } };
+    const float len = (float)std::max(settings.len, 0);
+    const float half = (float)std::max(settings.thickness, 0);
+    const float reach = (float)settings.gap + len * 0.5f;
+    if (len > 0 && half > 0) {
+        for (int arm = 0; arm < 4; arm++) {
+            if (arm == 3 && settings.tStyle) continue;
+            ShapePrimitive& shape = out.shapes[out.count++];
+            shape.kind = ShapeKind::Box;
+            shape.centerX = directions[arm][0] * reach;
+            shape.centerY = directions[arm][1] * reach;
+            shape.axisX = directions[arm][0];
+            shape.axisY = directions[arm][1];
+            shape.halfLength = len * 0.5f;
+            shape.halfWidth = half;
+        }
+    }
+    if (settings.centerDot && half > 0) {
+        ShapePrimitive& shape = out.shapes[out.count++];
+        shape.kind = ShapeKind::Box;
+        shape.axisX = c;
+        shape.axisY = s;
+        shape.halfLength = half;
+        shape.halfWidth = half;
+    }
+    if (settings.circleRadius > 0 && half > 0) {
+        ShapePrimitive& shape = out.shapes[out.count++];
+        shape.kind = ShapeKind::Ring;
+        shape.halfLength = (float)settings.circleRadius;
+        shape.halfWidth = half; // As wide as the arms
+    }
+}
+
+CrosshairRect ComputeShapeBounds(const CrosshairShapes& shapes, float grow) {
+    PreparedShape prepared[kMaxCrosshairShapes];
+    const int count = Prepare(shapes, grow, prepared);
+
+    CrosshairRect bounds = { 0, 0, 1, 1 };
+    for (int i = 0; i < count; i++) {
+        const PreparedShape& s = prepared[i];
+        float extentX, extentY;
+        if (s.kind == ShapeKind::Box) {
+            const float along = s.half0 + s.footHalf, across = s.half1 + s.footHalf;
+            extentX = std::fabs(s.axisX) * along + std::fabs(s.axisY) * across;
+            extentY = std::fabs(s.axisY) * along + std::fabs(s.axisX) * across;
+        }
+        else {
+            extentX = extentY = s.half0 + s.half1 + s.footHalf;
+        }
+        bounds.left = std::min(bounds.left, (int)std::floor(s.centerX - extentX));
+        bounds.top = std::min(bounds.top, (int)std::floor(s.centerY - extentY));
+        bounds.right = std::max(bounds.right, (int)std::ceil(s.centerX + extentX));
+        bounds.bottom = std::max(bounds.bottom, (int)std::ceil(s.centerY + extentY));
+    }
+    return bounds;
+}
+
+void BuildCoverageSpans(const CrosshairShapes& shapes, float grow, const CrosshairRect& bounds, std::vector<CoverageSpan>& spans) {
+    spans.clear();
+    PreparedShape prepared[kMaxCrosshairShapes];
+    const int count = Prepare(shapes, grow, prepared);
+
+    for (int y = bounds.top; y < bounds.bottom; y++) {
+        PixelInterval intervals[kMaxCrosshairShapes * 2];
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            PixelInterval found[2];
+            const int added = RowIntervals(prepared[i], (float)y + 0.5f, found);
+            for (int k = 0; k < added; k++) {
+                const int x0 = std::max(found[k].x0, bounds.left), x1 = std::min(found[k].x1, bounds.right);
+                if (x0 < x1) intervals[n++] = { x0, x1, 1u << i };
+            }
+        }
+
+        // Insertion sort by start, then merge overlapping or touching runs
+        for (int i = 1; i < n; i++) {
+            for (int k = i; k > 0 && intervals[k].x0 < intervals[k - 1].x0; k--) std::swap(intervals[k], intervals[k - 1]);
+        }
+        for (int i = 0; i < n;) {
+            int x1 = intervals[i].x1;
+            uint32_t mask = intervals[i].shapes;
+            int k = i + 1;
+            for (; k < n && intervals[k].x0 <= x1; k++) {
+                x1 = std::max(x1, intervals[k].x1);
+                mask |= intervals[k].shapes;
+            }
+            spans.push_back({ y, intervals[i].x0, x1, mask });
+            i = k;
+        }
+    }
+}
+
+const char* ShapeKernelName(ShapeKernel kernel) {
+    switch (kernel) {
+    case ShapeKernel::Scalar: return "scalar";
+    case ShapeKernel::Sse2: return "sse2";
+    case ShapeKernel::Avx: return "avx";
+    default: return "unknown";
+    }
+}
+
+bool IsShapeKernelSupported(ShapeKernel kernel) {
+    switch (kernel) {
+    case ShapeKernel::Scalar: return true;
+#ifdef ADRIXCH_HAS_SSE2
+    case ShapeKernel::Sse2: return true;
+#endif
+#ifdef ADRIXCH_HAS_AVX
+    case ShapeKernel::Avx: return CpuHasAvx();
+#endif
+    default: return false;
+    }
+}
+
+ShapeKernel ActiveShapeKernel() {
+    return g_kernel;
+}
+
+bool SetShapeKernel(ShapeKernel kernel) {
+    if (!IsShapeKernelSupported(kernel)) return false;
+    g_kernel = kernel;
+    g_kernelFn = KernelFunction(kernel);
+    return true;
+}
+
+void ComputeShapeCoverage(const CrosshairShapes& shapes, float grow, int y, int x0, int x1, float* coverage) {
+    PreparedShape prepared[kMaxCrosshairShapes];
+    const int count = Prepare(shapes, grow, prepared);
+    g_kernelFn(prepared, count, y, x0, x1, coverage);
+    ResolveCrossings(prepared, count, y, x0, x1, coverage);
+}
+
+void RasterizeCrosshairShapes(const CrosshairSettings& settings, CrosshairSprite& sprite) {
+    CrosshairShapes shapes;
+    CompileCrosshairShapes(settings, shapes);
+    const float outline = (float)std::max(settings.outlineThickness, 0);
+    const CrosshairRect bounds = ComputeShapeBounds(shapes, outline);
+    ClearSprite(sprite, bounds);
+
+    // Scratch kept between calls, so re-rendering a crosshair of the same size does not allocate
+    static thread_local std::vector<CoverageSpan> spans;
+    static thread_local std::vector<float> fillCoverage, outerCoverage;
+    BuildCoverageSpans(shapes, outline, bounds, spans);
+
+    PreparedShape fillShapes[kMaxCrosshairShapes], outerShapes[kMaxCrosshairShapes];
+    const int count = Prepare(shapes, 0.0f, fillShapes);
+    Prepare(shapes, outline, outerShapes);
+    const Palette palette = MakePalette(settings);
+    const CoverageKernelFn kernel = g_kernelFn;
+
+    // Most spans are reached by one or two shapes, so each evaluates only those
+    PreparedShape spanFill[kMaxCrosshairShapes], spanOuter[kMaxCrosshairShapes];
+    uint32_t selected = 0;
+    int spanCount = 0;
+
+    for (const CoverageSpan& span : spans) {
+        if (span.shapes != selected) {
+            selected = span.shapes;
+            spanCount = 0;
+            for (int i = 0; i < count; i++) {
+                if (!(selected & (1u << i))) continue;
+                spanFill[spanCount] = fillShapes[i];
+                spanOuter[spanCount++] = outerShapes[i];
+            }
+        }
+        const int width = span.x1 - span.x0;
+        if ((int)fillCoverage.size() < width) { fillCoverage.resize(width); outerCoverage.resize(width); }
+        kernel(spanFill, spanCount, span.y, span.x0, span.x1, fillCoverage.data());
+        ResolveCrossings(spanFill, spanCount, span.y, span.x0, span.x1, fillCoverage.data());
+        const float* outer = fillCoverage.data();
+        if (outline > 0) {
+            kernel(spanOuter, spanCount, span.y, span.x0, span.x1, outerCoverage.data());
+            ResolveCrossings(spanOuter, spanCount, span.y, span.x0, span.x1, outerCoverage.data());
+            outer = outerCoverage.data();
+        }
+
+        uint32_t* row = sprite.pixels.data() + (size_t)(span.y + sprite.originY) * sprite.width + (span.x0 + sprite.originX);
+        for (int i = 0; i < width; i++) row[i] = Composite(palette, fillCoverage[i], outer[i]);
+    }
+}
+
+void RasterizeCrosshairReference(const CrosshairSettings& settings, CrosshairSprite& sprite, int samplesPerAxis) {
+    CrosshairShapes shapes;
+    CompileCrosshairShapes(settings, shapes);
+    const float outline = (float)std::max(settings.outlineThickness, 0);
+    const CrosshairRect bounds = ComputeShapeBounds(shapes, outline);
+    ClearSprite(sprite, bounds);
+    const Palette palette = MakePalette(settings);
+    samplesPerAxis = std::max(samplesPerAxis, 1);
+
+    // Every pixel of the sprite, not just the spans, so anything the spans miss shows up as a difference
+    for (int y = bounds.top; y < bounds.bottom; y++) {
+        uint32_t* row = sprite.pixels.data() + (size_t)(y + sprite.originY) * sprite.width + sprite.originX;
+        for (int x = bounds.left; x < bounds.right; x++) {
+            const float fill = SampleCoverage(shapes, 0.0f, x, y, samplesPerAxis);
+            const float outer = outline > 0 ? SampleCoverage(shapes, outline, x, y, samplesPerAxis) : fill;
+            row[x] = Composite(palette, fill, outer);
+        }
+    }
+}
@@ -0,0 +1,85 @@
+// AdrixCH - Anti-aliased shape engine for rotated and ring crosshairs.
+//
+// Crosshairs that are not axis-aligned integer rectangles (a rotation or a ring) are compiled into a
+// few primitives with float geometry: oriented boxes for the arms and the center dot, and a ring.
+// Each sprite row is reduced to the spans that can have non-zero coverage, and a coverage kernel
+// (AVX, SSE2 or scalar, picked at runtime) evaluates only those pixels, so the cost follows the
+// covered area rather than the sprite size. Coverage is the box-filtered overlap of the pixel with
+// each primitive: exact along any straight edge, approximate only at corners and where shapes cross.
+//
+// Widths follow the same convention as the rectangle path, so a look keeps its weight when it gains a
+// rotation or a ring: Thickness is half the stroke, and arms, dot and ring are all 2 * Thickness wide.
+// The settings are whole pixels, so what the engine adds over rectangles is edges at any angle and
+// sub-pixel positions (rotated arms, the ring), not odd stroke widths; the primitives themselves take any
+// float width.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "CrosshairGeometry.h"
+#include "CrosshairRaster.h"
+#include "CrosshairSettings.h"
+
+enum class ShapeKind : uint8_t {
+    Box,  // Oriented rectangle
+    Ring, // Circular stroke
+};
+
+// Coordinates are in pixels relative to the crosshair center; pixel (x, y) covers [x, x+1) x [y, y+1)
+struct ShapePrimitive {
+    ShapeKind kind = ShapeKind::Box;
+    float centerX = 0, centerY = 0;
+    float axisX = 1, axisY = 0; // Box: unit direction of the length axis
+    float halfLength = 0;       // Box: half extent along the axis; Ring: radius of the stroke's center line
+    float halfWidth = 0;        // Box: half extent across the axis; Ring: half the stroke width
+};
+
+constexpr int kMaxCrosshairShapes = 6; // Four arms, the center dot and the ring
+
+struct CrosshairShapes {
+    ShapePrimitive shapes[kMaxCrosshairShapes];
+    int count = 0;
+};
+
+// Whether settings need the shape engine; everything else is drawn pixel-exact from CrosshairRects
+constexpr bool UsesShapeEngine(const CrosshairSettings& settings) {
+    return settings.rotation % 360 != 0 || settings.circleRadius > 0;
+}
+
+void CompileCrosshairShapes(const CrosshairSettings& settings, CrosshairShapes& shapes);
+
+// Pixel bounds of everything the shapes can touch once grown by grow pixels (always contains {0, 0, 1, 1})
+CrosshairRect ComputeShapeBounds(const CrosshairShapes& shapes, float grow);
+
+// Run of pixels [x0, x1) in row y that may have non-zero coverage, and which shapes can reach it
+struct CoverageSpan {
+    int y;
+    int x0, x1;
+    uint32_t shapes; // Bit i set for shapes[i]
+};
+
+// Spans of the grown shapes inside bounds, row by row, left to right. Reuses the vector's capacity.
+void BuildCoverageSpans(const CrosshairShapes& shapes, float grow, const CrosshairRect& bounds, std::vector<CoverageSpan>& spans);
+
+enum class ShapeKernel : uint8_t {
+    Scalar,
+    Sse2,
+    Avx,
+};
+
+const char* ShapeKernelName(ShapeKernel kernel);
+bool IsShapeKernelSupported(ShapeKernel kernel);
+ShapeKernel ActiveShapeKernel();
+// The best supported kernel is active from startup; this switches it (for benchmarks), false if unsupported
+bool SetShapeKernel(ShapeKernel kernel);
+
+// Coverage (0-1) of the union of the grown shapes for pixels [x0, x1) of row y, written to coverage[0..x1-x0)
+void ComputeShapeCoverage(const CrosshairShapes& shapes, float grow, int y, int x0, int x1, float* coverage);
+
+// Render through the shape engine: outline coverage (shapes grown by the outline width) under fill coverage
+void RasterizeCrosshairShapes(const CrosshairSettings& settings, CrosshairSprite& sprite);
+
+// Same image from point sampling on a samplesPerAxis^2 grid per pixel; slow, for verifying the engine
+void RasterizeCrosshairReference(const CrosshairSettings& settings, CrosshairSprite& sprite, int samplesPerAxis);
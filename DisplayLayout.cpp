@@ -0,0 +1,125 @@
+// AdrixCH - Cached display topology and crosshair placement across monitors.
+
+#include "DisplayLayout.h"
+
+#include <algorithm>
+
+namespace {
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x = (char)(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = (char)(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+std::string_view Trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+    return text;
+}
+
+// Pixel sizes are authored at 96 DPI; a part that was visible stays at least one pixel wide
+int ScaleLength(int value, int dpi) {
+    if (value <= 0) return value;
+    return std::max(1, (value * dpi + kDefaultDpi / 2) / kDefaultDpi);
+}
+
+} // namespace
+
+bool ParseMonitorSelection(std::string_view text, uint32_t& mask) {
+    text = Trim(text);
+    if (EqualsIgnoreCase(text, "primary")) { mask = kPrimaryMonitorOnly; return true; }
+    if (EqualsIgnoreCase(text, "all")) { mask = kAllMonitors; return true; }
+
+    uint32_t parsed = 0;
+    while (true) {
+        const size_t comma = text.find(',');
+        const std::string_view item = Trim(text.substr(0, comma));
+        if (item.empty() || item.size() > 2) return false;
+
+        unsigned index = 0;
+        for (char c : item) {
+            if (c < '0' || c > '9') return false;
+            index = index * 10 + (unsigned)(c - '0');
+        }
+        if (index >= kMaxMonitors) return false;
+        parsed |= 1u << index;
+
+        if (comma == std::string_view::npos) break;
+        text.remove_prefix(comma + 1);
+    }
+    mask = parsed;
+    return true;
+}
+
+CrosshairSettings ScaleCrosshairSettings(const CrosshairSettings& settings, int dpi) {
+    if (dpi <= 0 || dpi == kDefaultDpi) return settings;
+    CrosshairSettings scaled = settings;
+    scaled.len = ScaleLength(settings.len, dpi);
+    scaled.gap = ScaleLength(settings.gap, dpi);
+    scaled.thickness = ScaleLength(settings.thickness, dpi);
+    scaled.outlineThickness = ScaleLength(settings.outlineThickness, dpi);
+    scaled.circleRadius = ScaleLength(settings.circleRadius, dpi);
+    return scaled;
+}
+
+void DisplayLayout::Refresh() {
+    monitors_.clear();
+    source_.Enumerate(monitors_);
+    std::stable_sort(monitors_.begin(), monitors_.end(), [](const MonitorInfo& a, const MonitorInfo& b) {
+        return a.bounds.left != b.bounds.left ? a.bounds.left < b.bounds.left : a.bounds.top < b.bounds.top;
+    });
+    if (monitors_.size() > kMaxMonitors) monitors_.resize(kMaxMonitors);
+    enumerations_++;
+    valid_ = true;
+}
+
+const std::vector<MonitorInfo>& DisplayLayout::Monitors() {
+    if (!valid_) Refresh();
+    return monitors_;
+}
+
+void DisplayLayout::Place(const CrosshairSettings& settings, uint32_t selection, bool dpiScaling, std::vector<CrosshairPlacement>& placements) {
+    placements.clear();
+    const std::vector<MonitorInfo>& monitors = Monitors();
+    if (monitors.empty()) return;
+
+    // Bounds depend only on the (scaled) settings, so compute them once per distinct DPI
+    int lastDpi = -1;
+    CrosshairSettings scaled = settings;
+    CrosshairRect bounds = {};
+
+    auto place = [&](size_t index) {
+        const MonitorInfo& monitor = monitors[index];
+        const int dpi = dpiScaling ? monitor.dpi : kDefaultDpi;
+        if (dpi != lastDpi) {
+            scaled = ScaleCrosshairSettings(settings, dpi);
+            bounds = ComputeCrosshairBounds(scaled);
+            lastDpi = dpi;
+        }
+
+        CrosshairPlacement& placement = placements.emplace_back();
+        placement.monitor = index;
+        placement.centerX = monitor.bounds.left + (monitor.bounds.right - monitor.bounds.left) / 2;
+        placement.centerY = monitor.bounds.top + (monitor.bounds.bottom - monitor.bounds.top) / 2;
+        placement.box = OffsetCrosshairRect(bounds, placement.centerX, placement.centerY);
+        placement.settings = scaled;
+    };
+
+    for (size_t i = 0; i < monitors.size(); i++) {
+        if (selection & (1u << i)) place(i);
+    }
+    if (!placements.empty()) return;
+
+    // Nothing selected (or only monitors that are gone): fall back to the primary, or the first monitor
+    size_t primary = 0;
+    for (size_t i = 0; i < monitors.size(); i++) {
+        if (monitors[i].primary) { primary = i; break; }
+    }
+    place(primary);
+}
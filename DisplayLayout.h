@@ -0,0 +1,75 @@
+// AdrixCH - Cached display topology and crosshair placement across monitors.
+//
+// The topology (monitor rectangles and their DPI) is read from a DisplayTopologySource once and kept
+// until Invalidate() is called, which the application does on display-change notifications only.
+// Placement is pure arithmetic on the cached topology, so it can be driven by synthetic topologies.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "CrosshairGeometry.h"
+#include "CrosshairSettings.h"
+
+constexpr int kDefaultDpi = 96;
+constexpr size_t kMaxMonitors = 32; // Width of the monitor selection mask
+
+struct MonitorInfo {
+    CrosshairRect bounds; // Virtual-screen coordinates, in physical pixels
+    int dpi = kDefaultDpi;
+    bool primary = false;
+    int refreshHz = 60;
+};
+
+// Supplies the current monitor list; Win32 enumerates the real displays, tests can return anything
+class DisplayTopologySource {
+public:
+    virtual ~DisplayTopologySource() = default;
+    virtual void Enumerate(std::vector<MonitorInfo>& monitors) = 0;
+};
+
+// One crosshair instance: where it goes and what it looks like at that monitor's DPI
+struct CrosshairPlacement {
+    size_t monitor = 0;          // Index into DisplayLayout::Monitors()
+    int centerX = 0, centerY = 0; // Crosshair center, virtual-screen coordinates
+    CrosshairRect box = {};       // Screen-space bounds of the crosshair, outline included
+    CrosshairSettings settings;   // Scaled settings; instances at the same DPI share one cached sprite
+};
+
+// Monitor selection: 0 means "the primary monitor", otherwise bit i selects Monitors()[i]
+constexpr uint32_t kPrimaryMonitorOnly = 0;
+constexpr uint32_t kAllMonitors = 0xFFFFFFFFu;
+
+// Parses "primary", "all" or a comma-separated list of monitor indices such as "0,2"
+bool ParseMonitorSelection(std::string_view text, uint32_t& mask);
+
+// Scales the pixel sizes of settings from 96 DPI to dpi, rounding to nearest and keeping visible parts visible
+CrosshairSettings ScaleCrosshairSettings(const CrosshairSettings& settings, int dpi);
+
+class DisplayLayout {
+public:
+    explicit DisplayLayout(DisplayTopologySource& source) : source_(source) {}
+
+    // Drop the cached topology; the next query enumerates the displays again
+    void Invalidate() { valid_ = false; }
+
+    // Monitors ordered left to right, then top to bottom, so selection indices stay stable across enumerations
+    const std::vector<MonitorInfo>& Monitors();
+
+    // Compute one placement per selected monitor. Selected indices that do not exist are ignored; if none
+    // remain, the crosshair goes on the primary monitor. With dpiScaling off every instance uses settings as-is.
+    void Place(const CrosshairSettings& settings, uint32_t selection, bool dpiScaling, std::vector<CrosshairPlacement>& placements);
+
+    uint64_t Enumerations() const { return enumerations_; }
+
+private:
+    void Refresh();
+
+    DisplayTopologySource& source_;
+    std::vector<MonitorInfo> monitors_;
+    bool valid_ = false;
+    uint64_t enumerations_ = 0;
+};
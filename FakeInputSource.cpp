@@ -0,0 +1,19 @@
+// AdrixCH - Scripted input source: replays timed key events, so the hotkey path can be exercised without a keyboard.
+
+#include "FakeInputSource.h"
+
+bool FakeInputSource::Start(InputSink& sink, const HotkeyBinding*, size_t) {
+    if (thread_.joinable()) return false;
+    replayed_.store(0, std::memory_order_relaxed);
+    thread_ = std::thread([this, &sink] {
+        for (const KeyEvent& event : script_) {
+            sink.OnKeyEvent(event);
+            replayed_.fetch_add(1, std::memory_order_release);
+        }
+    });
+    return true;
+}
+
+void FakeInputSource::Stop() {
+    if (thread_.joinable()) thread_.join();
+}
@@ -0,0 +1,36 @@
+// AdrixCH - Scripted input source: replays timed key events, so the hotkey path can be exercised without a keyboard.
+//
+// The script is replayed from a thread of its own, like a platform hook calls its sink, so the dispatcher's
+// queue really is crossed between two threads. Event times come from the script rather than a clock, which
+// makes debounce and auto-repeat behaviour deterministic however fast the replay runs.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "HotkeyDispatcher.h"
+
+class FakeInputSource final : public InputSource {
+public:
+    ~FakeInputSource() override { Stop(); }
+
+    // Events to replay at the next Start, in order; only call while stopped
+    void SetScript(std::vector<KeyEvent> events) { script_ = std::move(events); }
+
+    // Start replaying the script to sink on the replay thread; every event is sent, whatever the bindings
+    bool Start(InputSink& sink, const HotkeyBinding* bindings, size_t count) override;
+    // Wait for the replay to finish
+    void Stop() override;
+
+    bool Finished() const { return replayed_.load(std::memory_order_acquire) == script_.size(); }
+    size_t Replayed() const { return replayed_.load(std::memory_order_acquire); }
+
+private:
+    std::vector<KeyEvent> script_;
+    std::thread thread_;
+    std::atomic<size_t> replayed_{ 0 };
+};
@@ -0,0 +1,19 @@
+// AdrixCH - Change notifications for a single file, delivered without polling.
+
+#pragma once
+
+#include <filesystem>
+
+// Reports changes to one file from a thread of its own. The file's directory is watched rather than the
+// file itself, so a file that is replaced by a rename (how SettingsStore::Save and most tools write) keeps
+// being seen. Notifications carry no detail and may arrive in bursts for one write; the receiver re-reads
+// the file and works out what changed.
+class FileWatcher {
+public:
+    using ChangeCallback = void (*)(void* context);
+
+    virtual ~FileWatcher() = default;
+    // callback runs on the watcher thread; returns false if the directory cannot be watched
+    virtual bool Start(const std::filesystem::path& path, ChangeCallback callback, void* context) = 0;
+    virtual void Stop() = 0;
+};
@@ -0,0 +1,138 @@
+// AdrixCH - Shared, reference-counted GDI brushes, pens and fonts keyed by what they draw.
+
+#include "GdiResourceCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+inline uint64_t Mix(uint64_t h) {
+    h ^= h >> 30; h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 27; h *= 0x94D049BB133111EBull;
+    h ^= h >> 31;
+    return h;
+}
+
+} // namespace
+
+GdiResourceKey GdiResourceKey::Brush(uint32_t color) {
+    GdiResourceKey key;
+    key.kind = GdiResourceKind::Brush;
+    key.color = color & 0xFFFFFF;
+    return key;
+}
+
+GdiResourceKey GdiResourceKey::Pen(uint32_t color, int width) {
+    GdiResourceKey key;
+    key.kind = GdiResourceKind::Pen;
+    key.color = color & 0xFFFFFF;
+    key.width = std::max(width, 0);
+    return key;
+}
+
+GdiResourceKey GdiResourceKey::Font(std::string_view face, int height, int weight) {
+    GdiResourceKey key;
+    key.kind = GdiResourceKind::Font;
+    key.width = height;
+    key.weight = weight;
+    std::memcpy(key.face, face.data(), std::min(face.size(), kMaxFaceLength));
+    return key;
+}
+
+bool GdiResourceKey::operator==(const GdiResourceKey& other) const {
+    return kind == other.kind && color == other.color && width == other.width && weight == other.weight &&
+        std::memcmp(face, other.face, sizeof(face)) == 0;
+}
+
+uint64_t HashGdiResourceKey(const GdiResourceKey& key) {
+    uint64_t h = Mix(((uint64_t)key.kind << 56) ^ ((uint64_t)key.color << 24) ^ (uint64_t)(uint32_t)key.width);
+    h = Mix(h ^ ((uint64_t)(uint32_t)key.weight * 0x9E3779B97F4A7C15ull));
+    for (size_t i = 0; i < sizeof(key.face) && key.face[i]; i += 8) {
+        uint64_t word = 0;
+        std::memcpy(&word, key.face + i, std::min<size_t>(8, sizeof(key.face) - i));
+        h = Mix(h ^ word);
+    }
+    return h;
+}
+
+GdiResourceCache::GdiResourceCache(GdiAllocator& allocator, size_t maxObjects)
+    : allocator_(allocator), maxObjects_(maxObjects > 0 ? maxObjects : 1) {
+    byKey_.reserve(maxObjects_);
+    byHandle_.reserve(maxObjects_);
+}
+
+GdiResourceCache::~GdiResourceCache() {
+    for (Entry& entry : referenced_) allocator_.Destroy(entry.handle);
+    for (Entry& entry : idle_) allocator_.Destroy(entry.handle);
+}
+
+GdiHandle GdiResourceCache::Acquire(const GdiResourceKey& key) {
+    const uint64_t hash = HashGdiResourceKey(key);
+    auto [first, last] = byKey_.equal_range(hash);
+    for (auto found = first; found != last; ++found) {
+        EntryList::iterator it = found->second;
+        if (!(it->key == key)) continue;
+        stats_.hits++;
+        if (it->references++ == 0) {
+            referenced_.splice(referenced_.begin(), idle_, it);
+            stats_.referenced++;
+        }
+        return it->handle;
+    }
+    stats_.misses++;
+
+    // Make room first, so the allocator never holds more than the bound plus what is in use
+    EvictTo(maxObjects_ - 1);
+
+    const GdiHandle handle = allocator_.Create(key);
+    if (!handle) {
+        stats_.failures++;
+        return 0;
+    }
+    stats_.created++;
+    referenced_.push_front({ key, handle, 1 });
+    byKey_.emplace(hash, referenced_.begin());
+    byHandle_.emplace(handle, referenced_.begin());
+    stats_.referenced++;
+    stats_.live++;
+    stats_.peakLive = std::max(stats_.peakLive, stats_.live);
+    return handle;
+}
+
+void GdiResourceCache::Release(GdiHandle handle) {
+    auto found = byHandle_.find(handle);
+    if (found == byHandle_.end()) return;
+    EntryList::iterator it = found->second;
+    if (it->references == 0 || --it->references > 0) return;
+
+    idle_.splice(idle_.begin(), referenced_, it);
+    stats_.referenced--;
+    EvictTo(maxObjects_);
+}
+
+void GdiResourceCache::Trim() {
+    while (!idle_.empty()) Destroy(std::prev(idle_.end()));
+}
+
+size_t GdiResourceCache::References(GdiHandle handle) const {
+    auto found = byHandle_.find(handle);
+    return found == byHandle_.end() ? 0 : found->second->references;
+}
+
+void GdiResourceCache::Destroy(EntryList::iterator it) {
+    auto [first, last] = byKey_.equal_range(HashGdiResourceKey(it->key));
+    for (auto found = first; found != last; ++found) {
+        if (found->second == it) { byKey_.erase(found); break; }
+    }
+    byHandle_.erase(it->handle);
+    allocator_.Destroy(it->handle);
+    stats_.destroyed++;
+    stats_.live--;
+    idle_.erase(it);
+}
+
+void GdiResourceCache::EvictTo(size_t limit) {
+    while (stats_.live > limit && !idle_.empty()) Destroy(std::prev(idle_.end()));
+}
@@ -0,0 +1,130 @@
+// AdrixCH - Shared, reference-counted GDI brushes, pens and fonts keyed by what they draw.
+//
+// Callers acquire an object by color, width or face and release it when done; equal requests share one
+// object. Released objects stay cached (least recently released first out) up to a bound, so windows that
+// come and go or paint often reuse the same handles instead of creating and deleting them every time.
+// The cache itself knows nothing about GDI: a GdiAllocator creates and destroys the real objects.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string_view>
+#include <unordered_map>
+
+enum class GdiResourceKind : uint8_t { Brush, Pen, Font };
+
+// Opaque object handle (an HGDIOBJ on Windows); 0 means none
+using GdiHandle = uintptr_t;
+
+struct GdiResourceKey {
+    static constexpr size_t kMaxFaceLength = 31; // LF_FACESIZE - 1
+
+    GdiResourceKind kind = GdiResourceKind::Brush;
+    uint32_t color = 0;  // COLORREF layout (0x00BBGGRR); brushes and pens
+    int32_t width = 0;   // Pen width, or font height in pixels
+    int32_t weight = 0;  // Font weight (400 normal, 700 bold)
+    char face[kMaxFaceLength + 1] = {}; // Font face, UTF-8, zero padded
+
+    static GdiResourceKey Brush(uint32_t color);
+    static GdiResourceKey Pen(uint32_t color, int width);
+    // Faces longer than kMaxFaceLength bytes are cut short
+    static GdiResourceKey Font(std::string_view face, int height, int weight = 400);
+
+    bool operator==(const GdiResourceKey& other) const;
+};
+
+uint64_t HashGdiResourceKey(const GdiResourceKey& key);
+
+// Creates and destroys the real objects; implemented per platform, and mocked by the benchmark
+class GdiAllocator {
+public:
+    virtual ~GdiAllocator() = default;
+    virtual GdiHandle Create(const GdiResourceKey& key) = 0; // 0 on failure
+    virtual void Destroy(GdiHandle handle) = 0;
+};
+
+class GdiResourceCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t created = 0;
+        uint64_t destroyed = 0;
+        uint64_t failures = 0;  // Allocator returned no object
+        size_t live = 0;        // Objects currently existing: referenced plus cached
+        size_t referenced = 0;  // Objects with at least one outstanding Acquire
+        size_t peakLive = 0;
+    };
+
+    // Released objects are kept while fewer than maxObjects exist in total; referenced objects are never
+    // destroyed, so live can only go over the bound while that many distinct objects are in use at once
+    explicit GdiResourceCache(GdiAllocator& allocator, size_t maxObjects = 32);
+    // Destroys every object, including any still referenced
+    ~GdiResourceCache();
+    GdiResourceCache(const GdiResourceCache&) = delete;
+    GdiResourceCache& operator=(const GdiResourceCache&) = delete;
+
+    // Shared object for key, created on a miss; every successful Acquire needs one Release. 0 on failure.
+    GdiHandle Acquire(const GdiResourceKey& key);
+    // Drop one reference; the object stays cached for the next Acquire. Unknown handles are ignored.
+    void Release(GdiHandle handle);
+
+    // Destroy every cached object nobody references
+    void Trim();
+
+    size_t References(GdiHandle handle) const;
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    struct Entry {
+        GdiResourceKey key;
+        GdiHandle handle = 0;
+        size_t references = 0;
+    };
+    using EntryList = std::list<Entry>;
+
+    void Destroy(EntryList::iterator it);
+    // Destroy the least recently released objects until at most limit exist (or none are idle)
+    void EvictTo(size_t limit);
+
+    GdiAllocator& allocator_;
+    size_t maxObjects_;
+    EntryList referenced_; // In use, in no particular order
+    EntryList idle_;       // Released, most recently released first
+    std::unordered_multimap<uint64_t, EntryList::iterator> byKey_; // Key hash to entry (in either list)
+    std::unordered_map<GdiHandle, EntryList::iterator> byHandle_;
+    Stats stats_;
+};
+
+// Holds one reference for the lifetime of a scope or an owner; movable, not copyable
+class GdiResource {
+public:
+    GdiResource() = default;
+    GdiResource(GdiResourceCache& cache, const GdiResourceKey& key) : cache_(&cache), handle_(cache.Acquire(key)) {}
+    ~GdiResource() { Reset(); }
+    GdiResource(GdiResource&& other) noexcept : cache_(other.cache_), handle_(other.handle_) { other.handle_ = 0; }
+    GdiResource& operator=(GdiResource&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            cache_ = other.cache_;
+            handle_ = other.handle_;
+            other.handle_ = 0;
+        }
+        return *this;
+    }
+    GdiResource(const GdiResource&) = delete;
+    GdiResource& operator=(const GdiResource&) = delete;
+
+    GdiHandle Get() const { return handle_; }
+    explicit operator bool() const { return handle_ != 0; }
+    void Reset() {
+        if (handle_ && cache_) cache_->Release(handle_);
+        handle_ = 0;
+    }
+
+private:
+    GdiResourceCache* cache_ = nullptr;
+    GdiHandle handle_ = 0;
+};
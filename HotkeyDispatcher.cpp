@@ -0,0 +1,94 @@
+// AdrixCH - Event-driven hotkey dispatcher sitting between a platform input source and the UI thread.
+
+#include "HotkeyDispatcher.h"
+
+bool HotkeyDispatcher::SetBindings(const HotkeyBinding* bindings, size_t count) {
+    if (count > kMaxBindings) return false;
+    for (size_t i = 0; i < count; i++) {
+        bindings_[i] = bindings[i];
+        held_[i] = false;
+        lastPressUs_[i] = 0;
+    }
+    bindingCount_ = count;
+    return true;
+}
+
+void HotkeyDispatcher::OnKeyEvent(const KeyEvent& event) {
+    for (size_t i = 0; i < bindingCount_; i++) {
+        const HotkeyBinding& binding = bindings_[i];
+        if (binding.key != event.key) continue;
+
+        if (!event.down) {
+            // Releases only count for presses we accepted, whatever the modifiers are by now
+            if (!held_[i]) continue;
+            held_[i] = false;
+            Deliver({ binding.action, false, event.timeUs });
+            continue;
+        }
+
+        if (binding.modifiers != event.modifiers) continue;
+        if (held_[i]) continue; // Auto-repeat while the key is held down
+        if (lastPressUs_[i] != 0 && event.timeUs - lastPressUs_[i] < debounceUs_) continue;
+
+        held_[i] = true;
+        lastPressUs_[i] = event.timeUs;
+        Deliver({ binding.action, true, event.timeUs });
+    }
+}
+
+void HotkeyDispatcher::Deliver(const HotkeyEvent& event) {
+    if (!queue_.Push(event)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (wake_) wake_(wakeContext_);
+}
+
+static char ToUpper(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+static bool EqualsNoCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (ToUpper(a[i]) != ToUpper(b[i])) return false;
+    }
+    return true;
+}
+
+static bool ParseKeyName(std::string_view name, uint16_t& key) {
+    if (name.size() == 1) {
+        const char c = ToUpper(name[0]);
+        if ((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) { key = static_cast<uint16_t>(c); return true; }
+        return false;
+    }
+    if (name.size() > 3 || ToUpper(name[0]) != 'F') return false;
+
+    int number = 0;
+    for (size_t i = 1; i < name.size(); i++) {
+        if (name[i] < '0' || name[i] > '9') return false;
+        number = number * 10 + (name[i] - '0');
+    }
+    if (number < 1 || number > 24) return false;
+    key = static_cast<uint16_t>(kKeyF1 + number - 1);
+    return true;
+}
+
+bool ParseHotkey(std::string_view text, uint16_t& key, uint8_t& modifiers) {
+    uint8_t mods = 0;
+    while (true) {
+        const size_t plus = text.find('+');
+        const std::string_view part = text.substr(0, plus);
+        if (plus == std::string_view::npos) {
+            if (!ParseKeyName(part, key)) return false;
+            modifiers = mods;
+            return true;
+        }
+
+        if (EqualsNoCase(part, "Ctrl")) mods |= kModCtrl;
+        else if (EqualsNoCase(part, "Shift")) mods |= kModShift;
+        else if (EqualsNoCase(part, "Alt")) mods |= kModAlt;
+        else return false;
+        text.remove_prefix(plus + 1);
+    }
+}
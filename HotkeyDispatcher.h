@@ -0,0 +1,107 @@
+// AdrixCH - Event-driven hotkey dispatcher sitting between a platform input source and the UI thread.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "SpscQueue.h"
+
+enum class HotkeyAction : uint8_t {
+    None,
+    OpenSettings,
+    NextProfile,
+    PreviousProfile,
+    SaveProfile,
+    DumpTrace,
+    AnimationHold, // Acts for as long as it is held, so its release matters too
+};
+
+// Modifier bits for HotkeyBinding::modifiers and KeyEvent::modifiers
+constexpr uint8_t kModCtrl = 1;
+constexpr uint8_t kModShift = 2;
+constexpr uint8_t kModAlt = 4;
+
+// Key codes use Windows virtual-key numbering on every platform
+constexpr uint16_t kKeyF1 = 0x70;
+constexpr uint16_t kKeyF12 = 0x7B;
+
+struct HotkeyBinding {
+    uint16_t key = 0;
+    uint8_t modifiers = 0;
+    HotkeyAction action = HotkeyAction::None;
+};
+
+// Raw key transition reported by an input source
+struct KeyEvent {
+    uint16_t key;
+    uint8_t modifiers;
+    bool down;
+    uint64_t timeUs; // Monotonic timestamp from the source
+};
+
+// Press or release of a bound hotkey, delivered to the UI thread
+struct HotkeyEvent {
+    HotkeyAction action;
+    bool pressed;
+    uint64_t timeUs;
+};
+
+class InputSink {
+public:
+    virtual void OnKeyEvent(const KeyEvent& event) = 0;
+
+protected:
+    ~InputSink() = default;
+};
+
+// Platform hook that reports key transitions to a sink from its own thread, without polling. The bindings let a
+// source watch only the keys that matter; the sink still does the matching.
+class InputSource {
+public:
+    virtual ~InputSource() = default;
+    virtual bool Start(InputSink& sink, const HotkeyBinding* bindings, size_t count) = 0;
+    virtual void Stop() = 0;
+};
+
+// Matches key events against the bindings, filters auto-repeat and bounces, and queues the
+// resulting hotkey events for the UI thread. OnKeyEvent runs on the input source thread and
+// Poll on the UI thread; bindings may only be changed while no source is running.
+class HotkeyDispatcher final : public InputSink {
+public:
+    static constexpr size_t kMaxBindings = 16;
+    using WakeCallback = void (*)(void* context);
+
+    bool SetBindings(const HotkeyBinding* bindings, size_t count);
+    void SetDebounceUs(uint64_t debounceUs) { debounceUs_ = debounceUs; }
+
+    // Called on the producer thread after an event was queued so the UI thread can wake up
+    void SetWakeCallback(WakeCallback callback, void* context) { wake_ = callback; wakeContext_ = context; }
+
+    void OnKeyEvent(const KeyEvent& event) override;
+
+    // Pop the next pending hotkey event; returns false when nothing is queued
+    bool Poll(HotkeyEvent& event) { return queue_.Pop(event); }
+
+    uint64_t DroppedEvents() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    void Deliver(const HotkeyEvent& event);
+
+    HotkeyBinding bindings_[kMaxBindings] = {};
+    size_t bindingCount_ = 0;
+    bool held_[kMaxBindings] = {};
+    uint64_t lastPressUs_[kMaxBindings] = {};
+    uint64_t debounceUs_ = 200000;
+
+    WakeCallback wake_ = nullptr;
+    void* wakeContext_ = nullptr;
+
+    SpscQueue<HotkeyEvent, 64> queue_;
+    std::atomic<uint64_t> dropped_{ 0 };
+};
+
+// Parse a binding such as "F12" or "Ctrl+Shift+F9" (case-insensitive). Accepts F1-F24, A-Z and 0-9.
+bool ParseHotkey(std::string_view text, uint16_t& key, uint8_t& modifiers);
@@ -0,0 +1,69 @@
+// AdrixCH - Linux file watcher backed by inotify.
+
+#include "InotifyFileWatcher.h"
+
+#include <cerrno>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+bool InotifyFileWatcher::Start(const std::filesystem::path& path, ChangeCallback callback, void* context) {
+    if (thread_.joinable() || !callback) return false;
+
+    std::filesystem::path directory = path.parent_path();
+    if (directory.empty()) directory = ".";
+    inotify_ = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (inotify_ < 0 || pipe(stopPipe_) != 0 ||
+        inotify_add_watch(inotify_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        Close();
+        return false;
+    }
+
+    name_ = path.filename().string();
+    callback_ = callback;
+    context_ = context;
+    thread_ = std::thread(&InotifyFileWatcher::Run, this);
+    return true;
+}
+
+void InotifyFileWatcher::Stop() {
+    if (thread_.joinable()) {
+        const char stop = 1;
+        while (write(stopPipe_[1], &stop, 1) < 0 && errno == EINTR) {}
+        thread_.join();
+    }
+    Close();
+}
+
+void InotifyFileWatcher::Close() {
+    for (int* fd : { &inotify_, &stopPipe_[0], &stopPipe_[1] }) {
+        if (*fd >= 0) close(*fd);
+        *fd = -1;
+    }
+}
+
+void InotifyFileWatcher::Run() {
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        pollfd fds[2] = { { inotify_, POLLIN, 0 }, { stopPipe_[0], POLLIN, 0 } };
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        if (fds[1].revents) return;
+
+        // Drain everything queued; one callback however many events named the file
+        bool changed = false;
+        ssize_t size;
+        while ((size = read(inotify_, buffer, sizeof(buffer))) > 0) {
+            for (char* at = buffer; at < buffer + size;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(at);
+                if (event->mask & IN_Q_OVERFLOW) changed = true; // Events were lost; ours may have been among them
+                else if (event->len && name_ == event->name) changed = true;
+                at += sizeof(inotify_event) + event->len;
+            }
+        }
+        if (changed) callback_(context_);
+    }
+}
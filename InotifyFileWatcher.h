@@ -0,0 +1,32 @@
+// AdrixCH - Linux file watcher backed by inotify.
+
+#pragma once
+
+#include <string>
+#include <thread>
+
+#include "FileWatcher.h"
+
+// Watches the file's directory for completed writes (IN_CLOSE_WRITE) and renames onto the file
+// (IN_MOVED_TO). The thread sleeps in poll() until inotify or Stop wakes it.
+class InotifyFileWatcher final : public FileWatcher {
+public:
+    InotifyFileWatcher() = default;
+    ~InotifyFileWatcher() override { Stop(); }
+    InotifyFileWatcher(const InotifyFileWatcher&) = delete;
+    InotifyFileWatcher& operator=(const InotifyFileWatcher&) = delete;
+
+    bool Start(const std::filesystem::path& path, ChangeCallback callback, void* context) override;
+    void Stop() override;
+
+private:
+    void Run();
+    void Close();
+
+    int inotify_ = -1;
+    int stopPipe_[2] = { -1, -1 };
+    std::string name_;
+    ChangeCallback callback_ = nullptr;
+    void* context_ = nullptr;
+    std::thread thread_;
+};
@@ -0,0 +1,32 @@
+// AdrixCH - Read-only memory mapping of a whole file (Win32 file mapping or POSIX mmap).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map the file read-only. An empty file opens successfully with Size() == 0.
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    bool IsOpen() const { return open_; }
+    const uint8_t* Data() const { return data_; }
+    size_t Size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+#ifdef _WIN32
+    void* file_ = nullptr;    // HANDLE
+    void* mapping_ = nullptr; // HANDLE
+#endif
+};
@@ -0,0 +1,156 @@
+// AdrixCH - Crosshair profile library: a fixed-record binary file that is memory-mapped at startup.
+
+#include "ProfileLibrary.h"
+
+#include <cstdio>
+#include <cstring>
+#include <system_error>
+
+static const char kMagic[4] = { 'A', 'X', 'P', 'L' };
+
+static FILE* OpenFile(const std::filesystem::path& path, const char* mode) {
+    FILE* file = nullptr;
+#ifdef _WIN32
+    wchar_t wideMode[8] = {};
+    for (size_t i = 0; mode[i] && i < 7; i++) wideMode[i] = (wchar_t)mode[i];
+    if (_wfopen_s(&file, path.c_str(), wideMode) != 0) file = nullptr;
+#else
+    file = std::fopen(path.c_str(), mode);
+#endif
+    return file;
+}
+
+static ProfileLibraryHeader MakeHeader(uint32_t count) {
+    ProfileLibraryHeader header = {};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = ProfileLibrary::kVersion;
+    header.recordSize = sizeof(ProfileRecord);
+    header.count = count;
+    return header;
+}
+
+bool ProfileLibrary::Open(const std::filesystem::path& path) {
+    Close();
+    if (!file_.Open(path) || file_.Size() < sizeof(ProfileLibraryHeader)) { Close(); return false; }
+
+    ProfileLibraryHeader header;
+    std::memcpy(&header, file_.Data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.recordSize != sizeof(ProfileRecord)) {
+        Close();
+        return false;
+    }
+
+    // Never trust the count beyond what is actually in the file (e.g. after an interrupted append)
+    const size_t available = (file_.Size() - sizeof(ProfileLibraryHeader)) / sizeof(ProfileRecord);
+    count_ = header.count < available ? header.count : available;
+    records_ = reinterpret_cast<const ProfileRecord*>(file_.Data() + sizeof(ProfileLibraryHeader));
+    return true;
+}
+
+void ProfileLibrary::Close() {
+    file_.Close();
+    records_ = nullptr;
+    count_ = 0;
+    nameIndex_.clear();
+    nameIndexBuilt_ = false;
+}
+
+const ProfileRecord* ProfileLibrary::Find(std::string_view name) const {
+    if (!nameIndexBuilt_) {
+        nameIndex_.reserve(count_);
+        for (size_t i = 0; i < count_; i++) nameIndex_.emplace(NameOf(records_[i]), (uint32_t)i);
+        nameIndexBuilt_ = true;
+    }
+    const auto found = nameIndex_.find(name);
+    return found != nameIndex_.end() ? records_ + found->second : nullptr;
+}
+
+bool ProfileLibrary::Append(const std::filesystem::path& path, std::string_view name, const CrosshairSettings& settings) {
+    // Unmap first: the header count changes underneath the view and Windows refuses to resize mapped files
+    Close();
+
+    const ProfileRecord record = MakeRecord(name, settings);
+    FILE* file = OpenFile(path, "r+b");
+    uint32_t count = 0;
+    if (file) {
+        ProfileLibraryHeader header;
+        if (std::fread(&header, sizeof(header), 1, file) != 1 || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+            header.version != kVersion || header.recordSize != sizeof(ProfileRecord) || std::fseek(file, 0, SEEK_END) != 0) {
+            std::fclose(file);
+            return false;
+        }
+        // Same rule as Open: a record only counts if it is completely in the file
+        const long size = std::ftell(file);
+        const uint32_t available = size > (long)sizeof(header) ? (uint32_t)((size - (long)sizeof(header)) / (long)sizeof(ProfileRecord)) : 0;
+        count = header.count < available ? header.count : available;
+    }
+    else {
+        file = OpenFile(path, "w+b");
+        if (!file) return false;
+    }
+
+    const ProfileLibraryHeader header = MakeHeader(count + 1);
+    bool ok = std::fseek(file, (long)(sizeof(ProfileLibraryHeader) + (size_t)count * sizeof(ProfileRecord)), SEEK_SET) == 0 &&
+        std::fwrite(&record, sizeof(record), 1, file) == 1;
+    // The count is only bumped after the record is in place
+    ok = ok && std::fflush(file) == 0 && std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = (std::fclose(file) == 0) && ok;
+    return Open(path) && ok;
+}
+
+bool ProfileLibrary::Write(const std::filesystem::path& path, const ProfileRecord* records, size_t count) {
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+    FILE* file = OpenFile(temp, "wb");
+    if (!file) return false;
+
+    const ProfileLibraryHeader header = MakeHeader((uint32_t)count);
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+        (count == 0 || std::fwrite(records, sizeof(ProfileRecord), count, file) == count);
+    ok = (std::fclose(file) == 0) && ok;
+
+    std::error_code ec;
+    if (ok) std::filesystem::rename(temp, path, ec);
+    if (!ok || ec) { std::filesystem::remove(temp, ec); return false; }
+    return true;
+}
+
+ProfileRecord ProfileLibrary::MakeRecord(std::string_view name, const CrosshairSettings& settings) {
+    ProfileRecord record = {};
+    std::memcpy(record.name, name.data(), name.size() < kMaxNameLength ? name.size() : kMaxNameLength);
+    record.len = (uint8_t)settings.len;
+    record.gap = (uint8_t)settings.gap;
+    record.thickness = (uint8_t)settings.thickness;
+    record.outlineThickness = (uint8_t)settings.outlineThickness;
+    record.centerDot = settings.centerDot ? 1 : 0;
+    record.fillColor = settings.fillColor & 0xFFFFFF;
+    record.outlineColor = settings.outlineColor & 0xFFFFFF;
+    record.rotation = (uint16_t)settings.rotation;
+    record.tStyle = settings.tStyle ? 1 : 0;
+    record.circleRadius = (uint8_t)settings.circleRadius;
+    return record;
+}
+
+std::string_view ProfileLibrary::NameOf(const ProfileRecord& record) {
+    size_t length = 0;
+    while (length < kMaxNameLength && record.name[length]) length++;
+    return std::string_view(record.name, length);
+}
+
+bool ProfileLibrary::ToSettings(const ProfileRecord& record, CrosshairSettings& settings) {
+    CrosshairSettings decoded = settings;
+    decoded.len = record.len;
+    decoded.gap = record.gap;
+    decoded.thickness = record.thickness;
+    decoded.outlineThickness = record.outlineThickness;
+    decoded.centerDot = record.centerDot != 0;
+    decoded.fillColor = record.fillColor;
+    decoded.outlineColor = record.outlineColor;
+    decoded.rotation = record.rotation;
+    decoded.tStyle = record.tStyle != 0;
+    decoded.circleRadius = record.circleRadius;
+    if (!IsCrosshairSettingsInRange(decoded)) return false;
+    settings = decoded;
+    return true;
+}
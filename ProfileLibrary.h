@@ -0,0 +1,80 @@
+// AdrixCH - Crosshair profile library: a fixed-record binary file that is memory-mapped at startup.
+//
+// Layout (little-endian): a 32-byte header followed by 64-byte records. Opening only maps the file and
+// checks the header, so startup cost does not depend on the number of profiles; a slot lookup is pointer
+// arithmetic and the name index is built on the first lookup by name.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "CrosshairSettings.h"
+#include "MappedFile.h"
+
+struct ProfileLibraryHeader {
+    char magic[4];       // "AXPL"
+    uint16_t version;    // 1
+    uint16_t recordSize; // sizeof(ProfileRecord)
+    uint32_t count;
+    uint32_t reserved[5];
+};
+
+struct ProfileRecord {
+    char name[32]; // UTF-8, NUL-padded, not necessarily terminated
+    uint8_t len;
+    uint8_t gap;
+    uint8_t thickness;
+    uint8_t outlineThickness;
+    uint8_t centerDot;
+    uint8_t tStyle;       // Zero in files written before these fields existed, which is the default
+    uint8_t circleRadius;
+    uint8_t reserved0;
+    uint32_t fillColor;
+    uint32_t outlineColor;
+    uint16_t rotation;
+    uint8_t reserved1[14];
+};
+
+static_assert(sizeof(ProfileLibraryHeader) == 32, "ProfileLibraryHeader is part of the file format");
+static_assert(sizeof(ProfileRecord) == 64, "ProfileRecord is part of the file format");
+
+class ProfileLibrary {
+public:
+    static constexpr uint16_t kVersion = 1;
+    static constexpr size_t kMaxNameLength = sizeof(ProfileRecord::name);
+
+    // Map an existing library. Fails if the file is missing or its header is not a version-1 library.
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    size_t Count() const { return count_; }
+    const ProfileRecord* At(size_t slot) const { return slot < count_ ? records_ + slot : nullptr; }
+
+    // First record with this exact name, or nullptr
+    const ProfileRecord* Find(std::string_view name) const;
+    size_t SlotOf(const ProfileRecord* record) const { return (size_t)(record - records_); }
+
+    // Append a profile to the file behind this library (creating it if needed) and remap it
+    bool Append(const std::filesystem::path& path, std::string_view name, const CrosshairSettings& settings);
+
+    // Write a complete library in one go, replacing any existing file
+    static bool Write(const std::filesystem::path& path, const ProfileRecord* records, size_t count);
+
+    static ProfileRecord MakeRecord(std::string_view name, const CrosshairSettings& settings);
+    static std::string_view NameOf(const ProfileRecord& record);
+
+    // Returns false if the record holds values outside the slider ranges
+    static bool ToSettings(const ProfileRecord& record, CrosshairSettings& settings);
+
+private:
+    MappedFile file_;
+    const ProfileRecord* records_ = nullptr;
+    size_t count_ = 0;
+    mutable std::unordered_map<std::string_view, uint32_t> nameIndex_; // Views into the mapping
+    mutable bool nameIndexBuilt_ = false;
+};
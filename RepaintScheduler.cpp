@@ -0,0 +1,32 @@
+// AdrixCH - Coalesces settings changes into at most one overlay and UI update per display refresh.
+
+#include "RepaintScheduler.h"
+
+bool RepaintScheduler::MarkChanged(uint32_t fields) {
+    fields &= kAllCrosshairFields;
+    if (!fields) return false;
+    stats_.changes++;
+    if (pending_) {
+        stats_.merged++;
+        pending_ |= fields;
+        return false;
+    }
+    pending_ = fields;
+    return true;
+}
+
+uint64_t RepaintScheduler::DelayUs() const {
+    if (!pending_ || !updated_) return 0;
+    const uint64_t elapsed = clock_.NowUs() - lastUpdateUs_;
+    return elapsed >= intervalUs_ ? 0 : intervalUs_ - elapsed;
+}
+
+uint32_t RepaintScheduler::TakeDue() {
+    if (!pending_ || DelayUs() != 0) return 0;
+    const uint32_t fields = pending_;
+    pending_ = 0;
+    lastUpdateUs_ = clock_.NowUs();
+    updated_ = true;
+    stats_.updates++;
+    return fields;
+}
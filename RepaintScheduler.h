@@ -0,0 +1,67 @@
+// AdrixCH - Coalesces settings changes into at most one overlay and UI update per display refresh.
+//
+// Changes are recorded as a set of CrosshairField bits. The first change after an idle period is due
+// immediately; changes arriving within one refresh interval of the last update are merged and become
+// due when that interval ends. The caller owns the timer: it asks when the next update is due and
+// collects the merged field set once it is.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "CrosshairSettings.h"
+
+// Monotonic time source, replaceable so scheduling can be driven by a fake clock
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual uint64_t NowUs() const = 0;
+};
+
+class SteadyClock final : public Clock {
+public:
+    uint64_t NowUs() const override {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+struct RepaintSchedulerStats {
+    uint64_t changes = 0; // MarkChanged calls
+    uint64_t updates = 0; // Field sets handed out by TakeDue
+    uint64_t merged = 0;  // Changes that joined an update already pending
+};
+
+class RepaintScheduler {
+public:
+    static constexpr uint64_t kDefaultIntervalUs = 16667; // 60 Hz
+
+    explicit RepaintScheduler(const Clock& clock) : clock_(clock) {}
+
+    // Refresh interval, e.g. from the display's refresh rate; 0 disables merging
+    void SetIntervalUs(uint64_t intervalUs) { intervalUs_ = intervalUs; }
+    uint64_t IntervalUs() const { return intervalUs_; }
+
+    // Record changed fields. Returns true if this starts a new pending update, i.e. the caller should
+    // arrange to call TakeDue after DelayUs(); further changes before then are merged into it.
+    bool MarkChanged(uint32_t fields);
+
+    bool Pending() const { return pending_ != 0; }
+    uint32_t PendingFields() const { return pending_; }
+
+    // Microseconds until the pending update is due; 0 if it is due now or nothing is pending
+    uint64_t DelayUs() const;
+
+    // The merged field set if an update is due (and clears it), otherwise 0
+    uint32_t TakeDue();
+
+    const RepaintSchedulerStats& GetStats() const { return stats_; }
+
+private:
+    const Clock& clock_;
+    uint64_t intervalUs_ = kDefaultIntervalUs;
+    uint64_t lastUpdateUs_ = 0;
+    bool updated_ = false; // lastUpdateUs_ is meaningful
+    uint32_t pending_ = 0;
+    RepaintSchedulerStats stats_;
+};
@@ -0,0 +1,64 @@
+// AdrixCH - Sequence lock for publishing small immutable snapshots to lock-free readers.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// One writer publishes whole values of T; any number of readers copy the latest one without locks and
+// without ever seeing a mix of two publications. The value is kept as relaxed atomic words, so a reader
+// racing a writer copies garbage it then throws away instead of causing a data race. Readers retry while
+// a publication is in progress, which takes a handful of stores.
+template <typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable_v<T>, "Seqlock values are copied word by word");
+
+public:
+    Seqlock() { Publish(T{}); }
+    explicit Seqlock(const T& value) { Publish(value); }
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+
+    // Writer side; only one thread may publish at a time
+    void Publish(const T& value) {
+        uint64_t words[kWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed); // Odd: readers retry
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; i++) words_[i].store(words[i], std::memory_order_relaxed);
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Reader side: the most recently published value
+    T Read() const {
+        T value;
+        while (!TryRead(value)) {}
+        return value;
+    }
+
+    // One attempt; false if a publication overlapped the copy
+    bool TryRead(T& value) const {
+        const uint64_t before = sequence_.load(std::memory_order_acquire);
+        if (before & 1) return false;
+        uint64_t words[kWords];
+        for (size_t i = 0; i < kWords; i++) words[i] = words_[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) != before) return false;
+        std::memcpy(&value, words, sizeof(T));
+        return true;
+    }
+
+    // Number of completed publications; lets readers skip work when nothing changed
+    uint64_t Version() const { return sequence_.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    alignas(64) std::atomic<uint64_t> sequence_{ 0 };
+    std::atomic<uint64_t> words_[kWords] = {};
+};
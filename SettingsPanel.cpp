@@ -0,0 +1,60 @@
+// AdrixCH - Text of the settings window controls, kept in fixed buffers with change detection.
+
+#include "SettingsPanel.h"
+
+#include <cwchar>
+
+uint32_t SettingsPanelText::Update(const CrosshairSettings& settings, uint32_t fields) {
+    if (!fields) return 0;
+
+    struct { SettingsControl control; CrosshairField field; const wchar_t* format; int value; } const labels[] = {
+        { SettingsControl::LengthLabel, CrosshairField::Length, L"Length: %d", settings.len },
+        { SettingsControl::ThicknessLabel, CrosshairField::Thickness, L"Thickness: %d", settings.thickness },
+        { SettingsControl::OutlineLabel, CrosshairField::OutlineThickness, L"Outline: %d", settings.outlineThickness },
+        { SettingsControl::GapLabel, CrosshairField::GapSize, L"Gap: %d", settings.gap },
+        { SettingsControl::RotationLabel, CrosshairField::Rotation, L"Rotation: %d", settings.rotation },
+        { SettingsControl::CircleLabel, CrosshairField::CircleRadius, L"Circle: %d", settings.circleRadius },
+    };
+    struct { SettingsControl control; CrosshairField field; const wchar_t* format; bool on; } const toggles[] = {
+        { SettingsControl::CenterDotButton, CrosshairField::CenterDot, L"Toggle Center Dot: %ls", settings.centerDot },
+        { SettingsControl::TStyleButton, CrosshairField::TStyle, L"T-Style: %ls", settings.tStyle },
+    };
+
+    // A control whose value is the one it already shows is neither formatted nor reported
+    uint32_t changed = 0;
+    auto stale = [&](SettingsControl control, int value) {
+        const size_t i = static_cast<size_t>(control);
+        if (shown_[i] && values_[i] == value) { skipped_++; return false; }
+        shown_[i] = true;
+        values_[i] = value;
+        changed |= SettingsControlBit(control);
+        updates_++;
+        return true;
+    };
+
+    for (const auto& label : labels) {
+        if (!(fields & CrosshairFieldBit(label.field)) || !stale(label.control, label.value)) continue;
+        std::swprintf(text_[static_cast<size_t>(label.control)], kTextCapacity, label.format, label.value);
+    }
+    for (const auto& toggle : toggles) {
+        if (!(fields & CrosshairFieldBit(toggle.field)) || !stale(toggle.control, toggle.on)) continue;
+        std::swprintf(text_[static_cast<size_t>(toggle.control)], kTextCapacity, toggle.format, toggle.on ? L"ON" : L"OFF");
+    }
+
+    // The code box shows every field; settings that differ only outside the slider ranges can still share a code
+    const size_t code = static_cast<size_t>(SettingsControl::CodeBox);
+    if (shown_[code] && settings == codeSettings_) { skipped_++; return changed; }
+    wchar_t scratch[kTextCapacity];
+    scratch[EncodeCrosshairCode(settings, scratch, kTextCapacity)] = L'\0';
+    codeSettings_ = settings;
+    if (shown_[code] && std::wcscmp(text_[code], scratch) == 0) { skipped_++; return changed; }
+    std::wcscpy(text_[code], scratch);
+    shown_[code] = true;
+    changed |= SettingsControlBit(SettingsControl::CodeBox);
+    updates_++;
+    return changed;
+}
+
+void SettingsPanelText::Reset() {
+    for (bool& shown : shown_) shown = false;
+}
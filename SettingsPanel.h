@@ -0,0 +1,57 @@
+// AdrixCH - Text of the settings window controls, kept in fixed buffers with change detection.
+//
+// Every label, toggle button caption and the code box is formatted from the crosshair settings into a buffer
+// of its own, and Update reports which of them actually read differently than before. The window only pushes
+// those to its controls, so a slider tick sets one label and the code box instead of every control, and nothing
+// along the way allocates.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "CrosshairCode.h"
+#include "CrosshairSettings.h"
+
+enum class SettingsControl : uint8_t {
+    LengthLabel,
+    ThicknessLabel,
+    OutlineLabel,
+    GapLabel,
+    RotationLabel,
+    CircleLabel,
+    CenterDotButton,
+    TStyleButton,
+    CodeBox,
+    Count
+};
+
+constexpr size_t kSettingsControlCount = static_cast<size_t>(SettingsControl::Count);
+
+// Sets of controls, one bit per SettingsControl
+constexpr uint32_t SettingsControlBit(SettingsControl control) { return 1u << static_cast<uint32_t>(control); }
+
+class SettingsPanelText {
+public:
+    static constexpr size_t kTextCapacity = kCrosshairCodeBufferSize; // Longest text plus terminator
+
+    // Bring every control that shows one of fields up to date (the code box shows them all) and return the
+    // controls whose text changed, as SettingsControlBit flags
+    uint32_t Update(const CrosshairSettings& settings, uint32_t fields = kAllCrosshairFields);
+
+    // Forget what the controls show, e.g. for a newly created window, so the next Update reports each control it formats
+    void Reset();
+
+    const wchar_t* Text(SettingsControl control) const { return text_[static_cast<size_t>(control)]; }
+
+    uint64_t Updates() const { return updates_; } // Controls reported changed so far
+    uint64_t Skipped() const { return skipped_; } // Controls left alone because their text would not change
+
+private:
+    wchar_t text_[kSettingsControlCount][kTextCapacity] = {};
+    int values_[kSettingsControlCount] = {};  // Value each label or toggle text was formatted from
+    bool shown_[kSettingsControlCount] = {};  // Whether the control shows text_ at all
+    CrosshairSettings codeSettings_;          // Settings the code box text was encoded from
+    uint64_t updates_ = 0;
+    uint64_t skipped_ = 0;
+};
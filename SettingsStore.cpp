@@ -0,0 +1,320 @@
+// AdrixCH - In-memory settings store for crosshair_settings.ini.
+
+#include "SettingsStore.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <system_error>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static bool EqualsNoCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        char x = a[i], y = b[i];
+        if (x >= 'a' && x <= 'z') x = (char)(x - 'a' + 'A');
+        if (y >= 'a' && y <= 'z') y = (char)(y - 'a' + 'A');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+// FNV-1a over the raw file bytes; continues from hash so a file can be hashed chunk by chunk
+static constexpr uint64_t kEmptyContentHash = 0xCBF29CE484222325ull;
+static uint64_t HashContent(uint64_t hash, const char* data, size_t size) {
+    for (size_t i = 0; i < size; i++) hash = (hash ^ (uint8_t)data[i]) * 0x100000001B3ull;
+    return hash;
+}
+
+static std::string_view Trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) text.remove_suffix(1);
+    return text;
+}
+
+void IniParser::Feed(const char* data, size_t size) {
+    for (size_t i = 0; i < size; i++) PutByte((uint8_t)data[i]);
+}
+
+void IniParser::PutByte(uint8_t byte) {
+    if (encoding_ == Encoding::Unknown) {
+        // Decide the encoding from the first bytes: FF FE = UTF-16LE, EF BB BF = UTF-8 BOM
+        pending_[pendingCount_++] = byte;
+        if (pendingCount_ == 2 && pending_[0] == 0xFF && pending_[1] == 0xFE) {
+            encoding_ = Encoding::Utf16;
+            pendingCount_ = 0;
+            return;
+        }
+        if (pending_[0] == 0xEF && pendingCount_ < 3 && (pendingCount_ == 1 || pending_[1] == 0xBB)) return;
+        if (pending_[0] == 0xFF && pendingCount_ < 2) return;
+
+        encoding_ = Encoding::Utf8;
+        const bool bom = pendingCount_ == 3 && pending_[0] == 0xEF && pending_[1] == 0xBB && pending_[2] == 0xBF;
+        const size_t held = pendingCount_;
+        pendingCount_ = 0;
+        if (!bom) for (size_t i = 0; i < held; i++) PutCodeUnit(pending_[i]);
+        return;
+    }
+
+    if (encoding_ == Encoding::Utf8) { PutCodeUnit(byte); return; }
+
+    // UTF-16LE: pair bytes into code units, then surrogates into code points, and re-encode as UTF-8
+    pending_[pendingCount_++] = byte;
+    if (pendingCount_ < 2) return;
+    pendingCount_ = 0;
+    uint32_t unit = pending_[0] | ((uint32_t)pending_[1] << 8);
+    if (unit >= 0xD800 && unit < 0xDC00) { highSurrogate_ = unit; return; }
+    if (unit >= 0xDC00 && unit < 0xE000 && highSurrogate_) unit = 0x10000 + ((highSurrogate_ - 0xD800) << 10) + (unit - 0xDC00);
+    highSurrogate_ = 0;
+
+    if (unit < 0x80) PutCodeUnit(unit);
+    else if (unit < 0x800) { PutCodeUnit(0xC0 | (unit >> 6)); PutCodeUnit(0x80 | (unit & 0x3F)); }
+    else if (unit < 0x10000) { PutCodeUnit(0xE0 | (unit >> 12)); PutCodeUnit(0x80 | ((unit >> 6) & 0x3F)); PutCodeUnit(0x80 | (unit & 0x3F)); }
+    else {
+        PutCodeUnit(0xF0 | (unit >> 18)); PutCodeUnit(0x80 | ((unit >> 12) & 0x3F));
+        PutCodeUnit(0x80 | ((unit >> 6) & 0x3F)); PutCodeUnit(0x80 | (unit & 0x3F));
+    }
+}
+
+void IniParser::PutCodeUnit(uint32_t unit) {
+    if (unit == '\n') { EndLine(); return; }
+    line_.push_back((char)unit);
+}
+
+void IniParser::Finish() {
+    // A file shorter than its BOM probe still has to reach the line buffer
+    if (encoding_ == Encoding::Unknown) {
+        encoding_ = Encoding::Utf8;
+        const size_t held = pendingCount_;
+        pendingCount_ = 0;
+        for (size_t i = 0; i < held; i++) PutCodeUnit(pending_[i]);
+    }
+    if (!line_.empty()) EndLine();
+}
+
+void IniParser::EndLine() {
+    const std::string_view line = Trim(line_);
+    if (line.empty() || line.front() == ';' || line.front() == '#') {
+        // Blank line or comment
+    }
+    else if (line.front() == '[') {
+        const size_t close = line.find(']');
+        if (close == std::string_view::npos) handler_.OnMalformedLine(line);
+        else section_.assign(Trim(line.substr(1, close - 1)));
+    }
+    else {
+        const size_t equals = line.find('=');
+        if (equals == std::string_view::npos || equals == 0) handler_.OnMalformedLine(line);
+        else handler_.OnValue(section_, Trim(line.substr(0, equals)), Trim(line.substr(equals + 1)));
+    }
+    line_.clear();
+}
+
+// Collects parser output into the store. A key repeated in the file keeps its last value.
+class SettingsStore::Loader final : public IniParser::Handler {
+public:
+    explicit Loader(SettingsStore& store) : store_(store) {}
+
+    void OnValue(std::string_view section, std::string_view key, std::string_view value) override {
+        if (Entry* entry = store_.Find(section, key)) entry->value.assign(value);
+        else store_.entries_.push_back({ std::string(section), std::string(key), std::string(value) });
+    }
+    void OnMalformedLine(std::string_view) override { store_.malformed_++; }
+
+private:
+    SettingsStore& store_;
+};
+
+void SettingsStore::Reset() {
+    entries_.clear();
+    crosshair_ = CrosshairSettings();
+    malformed_ = 0;
+    dirty_ = false;
+    contentHash_ = kEmptyContentHash;
+}
+
+bool SettingsStore::Load(const std::filesystem::path& path) {
+    Reset();
+    FILE* file = nullptr;
+#ifdef _WIN32
+    if (_wfopen_s(&file, path.c_str(), L"rb") != 0) file = nullptr;
+#else
+    file = std::fopen(path.c_str(), "rb");
+#endif
+    if (!file) {
+        std::error_code ec;
+        return !std::filesystem::exists(path, ec);
+    }
+
+    Loader loader(*this);
+    IniParser parser(loader);
+    char chunk[4096];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        parser.Feed(chunk, read);
+        contentHash_ = HashContent(contentHash_, chunk, read);
+    }
+    const bool ok = !std::ferror(file);
+    std::fclose(file);
+    parser.Finish();
+    ParseCrosshair();
+    return ok;
+}
+
+void SettingsStore::LoadFromString(std::string_view text) {
+    Reset();
+    Loader loader(*this);
+    IniParser parser(loader);
+    parser.Feed(text.data(), text.size());
+    parser.Finish();
+    ParseCrosshair();
+    contentHash_ = HashContent(kEmptyContentHash, text.data(), text.size());
+}
+
+bool SettingsStore::Reload(const std::filesystem::path& path, uint32_t& changedFields) {
+    changedFields = 0;
+    FILE* file = nullptr;
+#ifdef _WIN32
+    if (_wfopen_s(&file, path.c_str(), L"rb") != 0) file = nullptr;
+#else
+    file = std::fopen(path.c_str(), "rb");
+#endif
+    if (!file) return false; // Gone, or held open by the writer; the next change notification tries again
+
+    std::string text;
+    char chunk[4096];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) text.append(chunk, read);
+    const bool ok = !std::ferror(file);
+    std::fclose(file);
+    if (!ok || HashContent(kEmptyContentHash, text.data(), text.size()) == contentHash_) return false;
+
+    const CrosshairSettings previous = crosshair_;
+    LoadFromString(text);
+    changedFields = DiffCrosshairSettings(previous, crosshair_);
+    return true;
+}
+
+// Type the crosshair fields once after loading; malformed values keep their defaults
+void SettingsStore::ParseCrosshair() {
+    for (size_t i = 0; i < kCrosshairFieldCount; i++) {
+        const CrosshairField field = static_cast<CrosshairField>(i);
+        const Entry* entry = Find(kCrosshairSection, CrosshairFieldKey(field));
+        if (entry && !ParseCrosshairField(crosshair_, field, entry->value)) malformed_++;
+    }
+}
+
+SettingsStore::Entry* SettingsStore::Find(std::string_view section, std::string_view key) {
+    for (Entry& entry : entries_) {
+        if (EqualsNoCase(entry.key, key) && EqualsNoCase(entry.section, section)) return &entry;
+    }
+    return nullptr;
+}
+
+const SettingsStore::Entry* SettingsStore::Find(std::string_view section, std::string_view key) const {
+    return const_cast<SettingsStore*>(this)->Find(section, key);
+}
+
+std::string_view SettingsStore::Get(std::string_view section, std::string_view key, std::string_view fallback) const {
+    const Entry* entry = Find(section, key);
+    return entry ? std::string_view(entry->value) : fallback;
+}
+
+bool SettingsStore::GetFlag(std::string_view section, std::string_view key, bool fallback) const {
+    const std::string_view value = Get(section, key);
+    if (value == "1") return true;
+    if (value == "0") return false;
+    return fallback;
+}
+
+int SettingsStore::GetInt(std::string_view section, std::string_view key, int fallback, int min, int max) const {
+    long long value = 0;
+    if (!ParseSettingsInteger(Get(section, key), value)) return fallback;
+    return (int)std::max<long long>(min, std::min<long long>(max, value));
+}
+
+bool SettingsStore::Set(std::string_view section, std::string_view key, std::string_view value) {
+    Entry* entry = Find(section, key);
+    if (entry && entry->value == value) return false;
+
+    if (entry) {
+        entry->value.assign(value);
+    }
+    else {
+        // Keep new keys next to the rest of their section so the file stays readable
+        size_t insertAt = entries_.size();
+        for (size_t i = entries_.size(); i-- > 0;) {
+            if (EqualsNoCase(entries_[i].section, section)) { insertAt = i + 1; break; }
+        }
+        entries_.insert(entries_.begin() + insertAt, { std::string(section), std::string(key), std::string(value) });
+    }
+    dirty_ = true;
+    return true;
+}
+
+void SettingsStore::SetCrosshair(const CrosshairSettings& settings) {
+    char value[16];
+    for (size_t i = 0; i < kCrosshairFieldCount; i++) {
+        const CrosshairField field = static_cast<CrosshairField>(i);
+        FormatCrosshairField(settings, field, value, sizeof(value));
+        Set(kCrosshairSection, CrosshairFieldKey(field), value);
+    }
+    crosshair_ = settings;
+}
+
+std::string SettingsStore::Serialize() const {
+    std::string out;
+    const std::string* section = nullptr;
+    for (const Entry& entry : entries_) {
+        if (!section || !EqualsNoCase(*section, entry.section)) {
+            if (section) out += "\r\n";
+            section = &entry.section;
+            if (!section->empty()) { out += '['; out += *section; out += "]\r\n"; }
+        }
+        out += entry.key;
+        out += '=';
+        out += entry.value;
+        out += "\r\n";
+    }
+    return out;
+}
+
+bool SettingsStore::Save(const std::filesystem::path& path) {
+    if (!dirty_) return true;
+
+    const std::string text = Serialize();
+    std::filesystem::path temp = path;
+    temp += ".tmp";
+
+    FILE* file = nullptr;
+#ifdef _WIN32
+    if (_wfopen_s(&file, temp.c_str(), L"wb") != 0) file = nullptr;
+#else
+    file = std::fopen(temp.c_str(), "wb");
+#endif
+    if (!file) return false;
+    bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size() && std::fflush(file) == 0;
+
+    // The new contents must be on disk before the rename makes them the settings file, or a crash in between
+    // can leave an empty file in its place (_commit is FlushFileBuffers on the underlying handle)
+#ifdef _WIN32
+    written = written && _commit(_fileno(file)) == 0;
+#else
+    written = written && fsync(fileno(file)) == 0;
+#endif
+    written = (std::fclose(file) == 0) && written;
+
+    // rename replaces the destination in one step (MoveFileEx with MOVEFILE_REPLACE_EXISTING on Windows)
+    std::error_code ec;
+    if (written) std::filesystem::rename(temp, path, ec);
+    if (!written || ec) {
+        std::filesystem::remove(temp, ec);
+        return false;
+    }
+    dirty_ = false;
+    contentHash_ = HashContent(kEmptyContentHash, text.data(), text.size()); // So Reload recognizes our own write
+    return true;
+}
@@ -0,0 +1,106 @@
+// AdrixCH - In-memory settings store for crosshair_settings.ini.
+//
+// The file is read at startup with a streaming parser (and again when it changes on disk), values
+// are kept in memory (the crosshair fields typed, everything else as text) and written back with a
+// single atomic replace, only when something actually changed. Malformed lines or values are
+// counted and skipped, never thrown.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CrosshairSettings.h"
+
+// Incremental INI tokenizer: feed it arbitrary chunks, it reports complete key/value pairs.
+// Handles UTF-8 (with or without BOM) and UTF-16LE files as written by the Win32 profile APIs.
+class IniParser {
+public:
+    class Handler {
+    public:
+        virtual void OnValue(std::string_view section, std::string_view key, std::string_view value) = 0;
+        virtual void OnMalformedLine(std::string_view line) = 0;
+
+    protected:
+        ~Handler() = default;
+    };
+
+    explicit IniParser(Handler& handler) : handler_(handler) {}
+
+    void Feed(const char* data, size_t size);
+    void Finish(); // Flush a last line without a line break
+
+private:
+    void PutByte(uint8_t byte);
+    void PutCodeUnit(uint32_t unit);
+    void EndLine();
+
+    enum class Encoding : uint8_t { Unknown, Utf8, Utf16 };
+
+    Handler& handler_;
+    Encoding encoding_ = Encoding::Unknown;
+    uint8_t pending_[3] = {};     // Bytes held back while detecting the BOM or pairing UTF-16 units
+    size_t pendingCount_ = 0;
+    uint32_t highSurrogate_ = 0;
+    std::string line_;
+    std::string section_;
+};
+
+class SettingsStore {
+public:
+    // Read and parse the whole file in one streaming pass. A missing file counts as empty.
+    // Returns false only if the file exists but could not be read.
+    bool Load(const std::filesystem::path& path);
+    void LoadFromString(std::string_view text);
+
+    // Re-read the file after a change notification. If its bytes differ from what was last loaded or saved,
+    // the store is replaced with the new contents and changedFields gets the crosshair fields whose values
+    // differ; returns false (changing nothing) for an identical file, such as one we just saved ourselves,
+    // or one that cannot be read right now.
+    bool Reload(const std::filesystem::path& path, uint32_t& changedFields);
+
+    // Raw value lookup (section and key are case-insensitive, like the Win32 profile APIs)
+    std::string_view Get(std::string_view section, std::string_view key, std::string_view fallback = {}) const;
+    bool GetFlag(std::string_view section, std::string_view key, bool fallback) const;
+    // Integer value clamped to [min, max]; fallback if missing or not a number
+    int GetInt(std::string_view section, std::string_view key, int fallback, int min, int max) const;
+
+    // Returns true if the stored value changed (and the store became dirty)
+    bool Set(std::string_view section, std::string_view key, std::string_view value);
+
+    const CrosshairSettings& Crosshair() const { return crosshair_; }
+    void SetCrosshair(const CrosshairSettings& settings);
+
+    bool IsDirty() const { return dirty_; }
+    size_t MalformedCount() const { return malformed_; }
+
+    // Write the document to a temporary file next to path, flush it to disk and rename it over path.
+    // Does nothing (and succeeds) if nothing changed since the last Load or Save.
+    bool Save(const std::filesystem::path& path);
+    std::string Serialize() const;
+
+    static constexpr const char* kCrosshairSection = "Crosshair";
+
+private:
+    struct Entry {
+        std::string section;
+        std::string key;
+        std::string value;
+    };
+
+    class Loader;
+    Entry* Find(std::string_view section, std::string_view key);
+    const Entry* Find(std::string_view section, std::string_view key) const;
+    void Reset();
+    void ParseCrosshair();
+
+    std::vector<Entry> entries_; // File order
+    CrosshairSettings crosshair_;
+    size_t malformed_ = 0;
+    bool dirty_ = false;
+    uint64_t contentHash_ = 0; // Of the file bytes last loaded or saved
+};
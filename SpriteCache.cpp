@@ -0,0 +1,77 @@
+// AdrixCH - Bounded LRU cache of rendered crosshair sprites keyed by the settings tuple.
+
+#include "SpriteCache.h"
+
+#include <iterator>
+
+SpriteCache::SpriteCache(size_t maxBytes, size_t maxEntries)
+    : maxBytes_(maxBytes), maxEntries_(maxEntries > 0 ? maxEntries : 1) {
+    index_.reserve(maxEntries_);
+}
+
+const CrosshairSprite& SpriteCache::Get(const CrosshairSettings& settings) {
+    const uint64_t key = HashCrosshairSettings(settings);
+
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+        EntryList::iterator it = found->second;
+        if (it->settings == settings) {
+            stats_.hits++;
+            entries_.splice(entries_.begin(), entries_, it);
+            return it->sprite;
+        }
+        // Hash collision: the slot belongs to other settings, replace it below
+        stats_.bytes -= SpriteBytes(it->sprite);
+        entries_.erase(it);
+        index_.erase(found);
+        stats_.evictions++;
+    }
+    stats_.misses++;
+
+    // Recycle the least recently used entry when full so its pixel buffer is reused
+    if (entries_.size() >= maxEntries_) {
+        EntryList::iterator last = std::prev(entries_.end());
+        index_.erase(last->key);
+        stats_.bytes -= SpriteBytes(last->sprite);
+        stats_.evictions++;
+        entries_.splice(entries_.begin(), entries_, last);
+    }
+    else {
+        entries_.emplace_front();
+    }
+
+    Entry& entry = entries_.front();
+    entry.key = key;
+    entry.settings = settings;
+    RasterizeCrosshair(settings, entry.sprite);
+    stats_.bytes += SpriteBytes(entry.sprite);
+    index_[key] = entries_.begin();
+
+    EvictToLimits();
+    stats_.entries = entries_.size();
+    return entry.sprite;
+}
+
+void SpriteCache::Invalidate() {
+    entries_.clear();
+    index_.clear();
+    stats_.entries = 0;
+    stats_.bytes = 0;
+}
+
+void SpriteCache::SetLimits(size_t maxBytes, size_t maxEntries) {
+    maxBytes_ = maxBytes;
+    maxEntries_ = maxEntries > 0 ? maxEntries : 1;
+    EvictToLimits();
+    stats_.entries = entries_.size();
+}
+
+void SpriteCache::EvictToLimits() {
+    while (entries_.size() > 1 && (stats_.bytes > maxBytes_ || entries_.size() > maxEntries_)) {
+        Entry& last = entries_.back();
+        index_.erase(last.key);
+        stats_.bytes -= SpriteBytes(last.sprite);
+        stats_.evictions++;
+        entries_.pop_back();
+    }
+}
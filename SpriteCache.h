@@ -0,0 +1,53 @@
+// AdrixCH - Bounded LRU cache of rendered crosshair sprites keyed by the settings tuple.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+#include "CrosshairRaster.h"
+#include "CrosshairSettings.h"
+
+class SpriteCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0; // Pixel memory currently held
+    };
+
+    explicit SpriteCache(size_t maxBytes = 4u << 20, size_t maxEntries = 64);
+
+    // Return the sprite for settings, rasterizing it on a miss. The reference stays valid until the
+    // next call to Get, SetLimits or Invalidate.
+    const CrosshairSprite& Get(const CrosshairSettings& settings);
+
+    // Drop every sprite, e.g. when the rasterizer output for the same settings changes
+    void Invalidate();
+
+    // Change the caps; entries over the new limits are evicted immediately (the newest always stays)
+    void SetLimits(size_t maxBytes, size_t maxEntries);
+
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    struct Entry {
+        uint64_t key;
+        CrosshairSettings settings;
+        CrosshairSprite sprite;
+    };
+    using EntryList = std::list<Entry>;
+
+    static size_t SpriteBytes(const CrosshairSprite& sprite) { return sprite.pixels.capacity() * sizeof(uint32_t); }
+    void EvictToLimits();
+
+    EntryList entries_; // Most recently used first
+    std::unordered_map<uint64_t, EntryList::iterator> index_;
+    size_t maxBytes_;
+    size_t maxEntries_;
+    Stats stats_;
+};
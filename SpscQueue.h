@@ -0,0 +1,42 @@
+// AdrixCH - Lock-free single-producer/single-consumer ring buffer.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Fixed-capacity queue for handing values from exactly one producer thread to exactly one
+// consumer thread without locks. Capacity must be a power of two; one slot is never used.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side. Returns false if the queue is full.
+    bool Push(const T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t next = (head + 1) & (Capacity - 1);
+        if (next == tail_.load(std::memory_order_acquire)) return false;
+        slots_[head] = value;
+        head_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the queue is empty.
+    bool Pop(T& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) return false;
+        value = slots_[tail];
+        tail_.store((tail + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const {
+        return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+    }
+
+private:
+    T slots_[Capacity] = {};
+    alignas(64) std::atomic<size_t> head_{ 0 }; // Written by the producer
+    alignas(64) std::atomic<size_t> tail_{ 0 }; // Written by the consumer
+};
@@ -0,0 +1,184 @@
+// AdrixCH - Inputs and stand-ins shared by the tests and the benchmarks.
+
+#include "TestSupport.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <unordered_set>
+
+#include "CrosshairShapes.h"
+
+std::vector<CrosshairSettings> SliderRange() {
+    std::vector<CrosshairSettings> all;
+    all.reserve(49 * 20 * 11 * 51);
+    CrosshairSettings s;
+    for (s.len = 2; s.len <= 50; s.len++)
+        for (s.thickness = 1; s.thickness <= 20; s.thickness++)
+            for (s.outlineThickness = 0; s.outlineThickness <= 10; s.outlineThickness++)
+                for (s.gap = 0; s.gap <= 50; s.gap++) {
+                    s.centerDot = (s.gap & 1) != 0;
+                    s.fillColor = (uint32_t)(s.len * 0x050301 + s.gap) & 0xFFFFFF;
+                    s.outlineColor = (uint32_t)(s.thickness * 0x010507) & 0xFFFFFF;
+                    all.push_back(s);
+                }
+    return all;
+}
+
+std::vector<CrosshairSettings> ShapeRange() {
+    std::vector<CrosshairSettings> all;
+    CrosshairSettings s;
+    for (s.rotation = 0; s.rotation < 360; s.rotation += 5)
+        for (int variant = 0; variant < 12; variant++) {
+            s.tStyle = (variant & 1) != 0;
+            s.circleRadius = (variant >> 1) % 3 * 9;
+            s.len = 4 + variant * 3;
+            s.gap = variant % 5;
+            s.thickness = 1 + variant % 4;
+            s.outlineThickness = variant % 3;
+            s.centerDot = (variant & 2) != 0;
+            s.fillColor = (uint32_t)(0x00FF80 + variant * 0x100507) & 0xFFFFFF;
+            s.outlineColor = (uint32_t)(0x200000 + variant * 0x030201) & 0xFFFFFF;
+            if (UsesShapeEngine(s)) all.push_back(s);
+        }
+    return all;
+}
+
+CrosshairSettings CounterSettings(uint32_t k) {
+    CrosshairSettings s;
+    s.len = (int)(k % 49);
+    s.gap = (int)(k % 51);
+    s.thickness = (int)(k % 20);
+    s.outlineThickness = (int)(k % 11);
+    s.centerDot = (k & 1) != 0;
+    s.fillColor = k & 0xFFFFFF;
+    s.outlineColor = (k * 0x9E3779B1u) & 0xFFFFFF;
+    s.rotation = (int)(k % 360);
+    s.tStyle = (k & 2) != 0;
+    s.circleRadius = (int)(k % 50);
+    return s;
+}
+
+CrosshairSettings RandomSettings(uint64_t& state) {
+    auto next = [&](int range) {
+        state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+        return (int)((state >> 16) % (uint64_t)range);
+    };
+    CrosshairSettings s;
+    s.len = kLengthMin + next(kLengthMax - kLengthMin + 1);
+    s.gap = kGapMin + next(kGapMax - kGapMin + 1);
+    s.thickness = kThicknessMin + next(kThicknessMax - kThicknessMin + 1);
+    s.outlineThickness = kOutlineMin + next(kOutlineMax - kOutlineMin + 1);
+    s.centerDot = next(2) != 0;
+    s.fillColor = (uint32_t)next(1 << 24);
+    s.outlineColor = (uint32_t)next(1 << 24);
+    // Half of them stay version 1 crosshairs
+    if (next(2)) {
+        s.rotation = kRotationMin + next(kRotationMax - kRotationMin + 1);
+        s.tStyle = next(2) != 0;
+        s.circleRadius = kCircleRadiusMin + next(kCircleRadiusMax - kCircleRadiusMin + 1);
+    }
+    return s;
+}
+
+size_t CodeListText(size_t lines, uint64_t seed, std::string& text, size_t& badLines) {
+    std::unordered_set<uint64_t> distinct;
+    std::vector<CrosshairSettings> recent;
+    uint64_t state = seed * 0x9E3779B97F4A7C15ull + 1;
+    text = "# AdrixCH team crosshairs\n";
+    badLines = 0;
+    char code[kCrosshairCodeBufferSize];
+    for (size_t i = 0; i < lines; i++) {
+        if (i % 1000 == 999) { text += "NOT-A-CODE\n"; badLines++; continue; }
+        if (i % 500 == 250) { text += "\n"; continue; }
+        CrosshairSettings s = RandomSettings(state);
+        if (i % 20 == 7 && !recent.empty()) s = recent[(state >> 8) % recent.size()]; // Someone pasted it twice
+        if (recent.size() < 4096) recent.push_back(s); else recent[i % 4096] = s;
+        distinct.insert(HashCrosshairSettings(s));
+
+        if (i % 10 == 3 && s.rotation == 0 && !s.tStyle && s.circleRadius == 0) {
+            std::snprintf(code, sizeof(code), "%02d%02d%02d%02d%d-%06X-%06X", s.len, s.gap, s.thickness, s.outlineThickness,
+                s.centerDot ? 1 : 0, s.fillColor, s.outlineColor);
+            text += code;
+        }
+        else {
+            text.append(code, EncodeCrosshairCode(s, code, sizeof(code)));
+        }
+        text += i % 3 ? "\n" : "\r\n";
+    }
+    return distinct.size();
+}
+
+std::vector<uint32_t> SyntheticFrame(int width, int height, uint32_t rgb, int noise, uint32_t seed) {
+    std::vector<uint32_t> frame((size_t)width * height);
+    uint32_t state = seed * 2654435761u + 1;
+    for (uint32_t& pixel : frame) {
+        pixel = 0xFF000000u;
+        for (int shift = 0; shift < 24; shift += 8) {
+            state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+            const int offset = noise ? (int)(state % (uint32_t)(2 * noise + 1)) - noise : 0;
+            const int channel = std::clamp((int)((rgb >> shift) & 0xFF) + offset, 0, 255);
+            pixel |= (uint32_t)channel << shift;
+        }
+    }
+    return frame;
+}
+
+BackgroundStats FrameStats(const std::vector<uint32_t>& frame, int size) {
+    BackgroundSums sums;
+    SumBackground(frame.data(), size, size, (size_t)size, sums);
+    return ComputeBackgroundStats(sums);
+}
+
+bool WriteTextFile(const std::filesystem::path& path, std::string_view text) {
+    FILE* file = std::fopen(path.string().c_str(), "wb");
+    if (!file) return false;
+    const bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    return std::fclose(file) == 0 && written;
+}
+
+GdiHandle MockGdiAllocator::Create(const GdiResourceKey&) {
+    if (failNext) { failNext = false; return 0; }
+    live++;
+    return next++;
+}
+
+void MockGdiAllocator::Destroy(GdiHandle handle) {
+    if (handle == 0 || handle >= next || destroyed[handle]) { badFrees++; return; }
+    destroyed[handle] = true;
+    live--;
+}
+
+SteadyStateOverlay::SteadyStateOverlay(const std::vector<CrosshairSettings>& range)
+    : screens_({ { { 0, 0, 1920, 1080 }, 96, true }, { { 1920, 0, 4480, 1440 }, 144, false } }),
+      display_(screens_),
+      repaints_(clock_),
+      sprites_(16u << 20, 128) { // Room for every look a test or benchmark goes through: misses are not the steady state
+    for (size_t i = 0; i < kCodeCount; i++) EncodeCrosshairCode(range[i * 7919 % range.size()], codes_[i], kCrosshairCodeBufferSize);
+}
+
+uint64_t SteadyStateOverlay::Update(uint32_t fields) {
+    clock_.now += 20000; // Each change on a refresh of its own
+    repaints_.MarkChanged(fields);
+    const uint32_t due = repaints_.TakeDue();
+    published_.Publish(edited);
+    const CrosshairSettings drawn = published_.Read();
+    display_.Place(drawn, kAllMonitors, true, placed_);
+    BuildAnimationFrames(drawn, still_, animationFrames_);
+    changedControls = panel.Update(edited, due);
+    return Paint();
+}
+
+uint64_t SteadyStateOverlay::Paint() {
+    uint64_t pixels = 0;
+    for (const CrosshairPlacement& placement : placed_) pixels += sprites_.Get(placement.settings).pixels.size();
+    return pixels;
+}
+
+uint64_t SteadyStateOverlay::Slide(int gap) {
+    edited.gap = gap;
+    return Update(CrosshairFieldBit(CrosshairField::GapSize));
+}
+
+uint64_t SteadyStateOverlay::LoadCode(size_t i) {
+    return DecodeCrosshairCode(std::wstring_view(codes_[i % kCodeCount]), edited) == CrosshairCodeStatus::Ok ? Update(kAllCrosshairFields) : 0;
+}
@@ -0,0 +1,106 @@
+// AdrixCH - Inputs and stand-ins shared by the tests and the benchmarks.
+//
+// Crosshair sweeps, generated code lists and screen frames, and fakes for the platform pieces (monitors, clock,
+// GDI), so the tests check exactly what the benchmarks time. SteadyStateOverlay strings the overlay thread's
+// work for one settings change together the way AdrixCH.cpp does, minus the Win32 calls.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "AdaptiveContrast.h"
+#include "CrosshairAnimation.h"
+#include "CrosshairCode.h"
+#include "CrosshairSettings.h"
+#include "DisplayLayout.h"
+#include "GdiResourceCache.h"
+#include "RepaintScheduler.h"
+#include "Seqlock.h"
+#include "SettingsPanel.h"
+#include "SpriteCache.h"
+
+// Every combination the settings sliders allow: len 2-50, thickness 1-20, outline 0-10, gap 0-50
+std::vector<CrosshairSettings> SliderRange();
+// Crosshairs that need the shape engine: every 5 degrees, with and without T-style and ring, a few sizes
+std::vector<CrosshairSettings> ShapeRange();
+// Every field derived from one counter, so a mix of two of these is never equal to any one of them
+CrosshairSettings CounterSettings(uint32_t k);
+// Any crosshair the sliders allow, from a 64-bit random state
+CrosshairSettings RandomSettings(uint64_t& state);
+
+// A shared code list as teams write them: a header comment, mostly current codes with some legacy ones, repeats,
+// blank lines, Windows line endings, and every 1000th line garbage. Returns the number of distinct crosshairs.
+size_t CodeListText(size_t lines, uint64_t seed, std::string& text, size_t& badLines);
+
+// Synthetic screen content in BGRA: a flat color, or that color with per-pixel noise of the given amplitude
+std::vector<uint32_t> SyntheticFrame(int width, int height, uint32_t rgb, int noise, uint32_t seed);
+BackgroundStats FrameStats(const std::vector<uint32_t>& frame, int size);
+
+bool WriteTextFile(const std::filesystem::path& path, std::string_view text);
+
+// Hands out fake handles and counts the objects that would exist; double or unknown frees are counted too
+class MockGdiAllocator final : public GdiAllocator {
+public:
+    GdiHandle Create(const GdiResourceKey&) override;
+    void Destroy(GdiHandle handle) override;
+
+    GdiHandle next = 1;
+    size_t live = 0;
+    uint64_t badFrees = 0;
+    bool failNext = false;
+    std::vector<bool> destroyed = std::vector<bool>(1 << 20);
+};
+
+// Fixed monitor list standing in for the real displays
+class SyntheticTopology final : public DisplayTopologySource {
+public:
+    explicit SyntheticTopology(std::vector<MonitorInfo> monitors) : monitors_(std::move(monitors)) {}
+    void Enumerate(std::vector<MonitorInfo>& monitors) override { monitors = monitors_; }
+
+private:
+    std::vector<MonitorInfo> monitors_;
+};
+
+// Time only moves when the caller says so
+class FakeClock final : public Clock {
+public:
+    uint64_t NowUs() const override { return now; }
+    uint64_t now = 1;
+};
+
+// The overlay thread's path for one change, on two monitors: merge it, publish, place, animate, update the
+// settings window text and paint. Each call returns the painted pixel count so the work stays observable.
+class SteadyStateOverlay {
+public:
+    // Load codes are taken from range, the way they would come out of the edit box: a fixed buffer per code
+    explicit SteadyStateOverlay(const std::vector<CrosshairSettings>& range);
+
+    uint64_t Update(uint32_t fields);
+    uint64_t Paint();
+    uint64_t Slide(int gap);
+    uint64_t LoadCode(size_t i);
+
+    CrosshairSettings edited;
+    SettingsPanelText panel;
+    uint32_t changedControls = 0; // Reported by the panel on the last Update
+
+private:
+    static constexpr size_t kCodeCount = 16;
+
+    SyntheticTopology screens_;
+    DisplayLayout display_;
+    FakeClock clock_;
+    RepaintScheduler repaints_;
+    Seqlock<CrosshairSettings> published_;
+    SpriteCache sprites_;
+    std::vector<CrosshairPlacement> placed_;
+    std::vector<CrosshairSettings> animationFrames_;
+    AnimationSettings still_; // No animation: one frame per change
+    wchar_t codes_[kCodeCount][kCrosshairCodeBufferSize];
+};
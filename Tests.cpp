@@ -0,0 +1,1289 @@
+// AdrixCH - Correctness tests for the portable core, one function per module.
+// Usage: adrixch_tests [filter]   (runs every test whose name contains filter)
+//
+// Each test prints what went wrong and returns false; the others still run, and the exit code is non-zero if
+// any of them failed. The benchmarks time the same inputs (TestSupport.h) without checking them.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AdaptiveContrast.h"
+#include "AllocationTracking.h"
+#include "CodeLibrary.h"
+#include "ControlChannel.h"
+#include "CrosshairAnimation.h"
+#include "CrosshairCode.h"
+#include "CrosshairGeometry.h"
+#include "CrosshairRaster.h"
+#include "CrosshairSettings.h"
+#include "CrosshairShapes.h"
+#include "DisplayLayout.h"
+#include "FakeInputSource.h"
+#include "GdiResourceCache.h"
+#include "HotkeyDispatcher.h"
+#ifdef __linux__
+#include "InotifyFileWatcher.h"
+#endif
+#include "ProfileLibrary.h"
+#include "RepaintScheduler.h"
+#include "Seqlock.h"
+#include "SettingsPanel.h"
+#include "SettingsStore.h"
+#include "SpriteCache.h"
+#include "TestSupport.h"
+#include "Trace.h"
+
+// The slider sweep, built once and shared by every test that needs real crosshairs
+static const std::vector<CrosshairSettings>& Range() {
+    static const std::vector<CrosshairSettings> range = SliderRange();
+    return range;
+}
+
+static std::string NarrowCode(const CrosshairSettings& settings) {
+    char code[kCrosshairCodeBufferSize];
+    return std::string(code, EncodeCrosshairCode(settings, code, sizeof(code)));
+}
+
+// Largest per-channel difference between two sprites of the same layout, or 256 if the layouts differ
+static int SpriteDifference(const CrosshairSprite& a, const CrosshairSprite& b, double* meanAlpha = nullptr) {
+    if (a.width != b.width || a.height != b.height || a.originX != b.originX || a.originY != b.originY) return 256;
+    int worst = 0;
+    double alphaSum = 0;
+    for (size_t i = 0; i < a.pixels.size(); i++) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            const int d = std::abs((int)((a.pixels[i] >> shift) & 0xFF) - (int)((b.pixels[i] >> shift) & 0xFF));
+            worst = std::max(worst, d);
+            if (shift == 24) alphaSum += d;
+        }
+    }
+    if (meanAlpha) *meanAlpha = a.pixels.empty() ? 0 : alphaSum / (double)a.pixels.size() / 255.0;
+    return worst;
+}
+
+static float Luma(uint32_t colorRef) {
+    return 0.2126f * (float)(colorRef & 0xFF) + 0.7152f * (float)((colorRef >> 8) & 0xFF) + 0.0722f * (float)((colorRef >> 16) & 0xFF);
+}
+
+// Every crosshair the sliders allow must round-trip through a current and a legacy code, and one corrupted
+// character per code must never be accepted as some other crosshair
+static bool TestCodes() {
+    const std::vector<CrosshairSettings>& range = Range();
+    for (const CrosshairSettings& s : range) {
+        const std::wstring code = GetCrosshairCode(s);
+        wchar_t legacy[32];
+        swprintf(legacy, 32, L"%02d%02d%02d%02d%d-%06X-%06X", s.len, s.gap, s.thickness, s.outlineThickness,
+            s.centerDot ? 1 : 0, s.fillColor, s.outlineColor);
+
+        CrosshairSettings current, old;
+        if (DecodeCrosshairCode(code, current) != CrosshairCodeStatus::Ok || !(current == s) ||
+            DecodeCrosshairCode(std::wstring_view(legacy), old) != CrosshairCodeStatus::Ok || !(old == s)) {
+            std::printf("code round-trip failed for %ls\n", code.c_str());
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < range.size(); i++) {
+        std::string code = NarrowCode(range[i]);
+        code[i % kCrosshairCodeLength] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ"[(i * 7) & 31];
+        CrosshairSettings s = range[i];
+        if (DecodeCrosshairCode(std::string_view(code), s) == CrosshairCodeStatus::Ok && !(s == range[i])) {
+            std::printf("code %s was accepted as another crosshair\n", code.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// Three monitors, two at 150% and a primary at 100%, listed out of order
+static bool TestDisplayLayout() {
+    SyntheticTopology topology({
+        { { 1920, 0, 4480, 1440 }, 144, false },
+        { { 0, 0, 1920, 1080 }, 96, true },
+        { { -2560, -200, 0, 1240 }, 144, false },
+    });
+    const std::vector<CrosshairSettings>& range = Range();
+    DisplayLayout layout(topology);
+    std::vector<CrosshairPlacement> placements;
+    layout.Place(range[0], kAllMonitors, true, placements);
+    SpriteCache shared;
+    if (placements.size() != 3 || placements[1].monitor != 1 || placements[1].centerX != 960 ||
+        &shared.Get(placements[0].settings) != &shared.Get(placements[2].settings)) {
+        std::printf("display layout check failed\n");
+        return false;
+    }
+
+    // The topology is enumerated once, however often crosshairs are placed, until it is invalidated
+    for (size_t i = 0; i < 1000; i++) layout.Place(range[i * 37 % range.size()], i & 1 ? kAllMonitors : kPrimaryMonitorOnly, true, placements);
+    const uint64_t beforeInvalidate = layout.Enumerations();
+    layout.Invalidate();
+    layout.Place(range[1], kAllMonitors, true, placements);
+    if (beforeInvalidate != 1 || layout.Enumerations() != 2 || placements.size() != 3) {
+        std::printf("display topology enumerated %llu times\n", (unsigned long long)layout.Enumerations());
+        return false;
+    }
+    return true;
+}
+
+// Histogram percentiles must stay within one sub-bucket (~3%) of the exact value
+static bool TestHistogram() {
+    LatencyHistogram histogram;
+    for (uint64_t ns = 1; ns <= 1000000; ns++) histogram.Record(ns);
+    for (double percentile : { 50.0, 90.0, 99.0, 99.9 }) {
+        const double exact = percentile / 100.0 * 1000000.0;
+        const double error = ((double)histogram.Percentile(percentile) - exact) / exact;
+        if (error < 0 || error > 1.0 / LatencyHistogram::kSubBucketCount) {
+            std::printf("histogram p%g is %llu\n", percentile, (unsigned long long)histogram.Percentile(percentile));
+            return false;
+        }
+    }
+    return true;
+}
+
+// A one-second slider drag with a move every 2 ms: the first move goes out at once, then one update per
+// 60 Hz refresh, with the last move always delivered
+static bool TestRepaintScheduler() {
+    FakeClock clock;
+    RepaintScheduler scheduler(clock);
+    uint64_t updates = 0, dueAt = 0;
+    for (uint64_t move = 0; move < 500; move++) {
+        const uint64_t moveAt = 1 + move * 2000;
+        if (scheduler.Pending() && dueAt <= moveAt) { // The timer fires first
+            clock.now = dueAt;
+            if (scheduler.TakeDue()) updates++;
+        }
+        clock.now = moveAt;
+        if (!scheduler.MarkChanged(CrosshairFieldBit(CrosshairField::Length))) continue;
+        dueAt = clock.now + scheduler.DelayUs();
+        if (dueAt == clock.now && scheduler.TakeDue()) updates++;
+    }
+    clock.now = dueAt;
+    if (scheduler.TakeDue()) updates++;
+    const RepaintSchedulerStats& stats = scheduler.GetStats();
+    if (scheduler.Pending() || updates < 59 || updates > 62 || stats.changes != 500 || stats.merged != 500 - updates) {
+        std::printf("repaint scheduler check failed: %llu updates\n", (unsigned long long)updates);
+        return false;
+    }
+    return true;
+}
+
+// Readers racing a writer on other threads must only ever see whole publications
+static bool TestSeqlock() {
+    Seqlock<CrosshairSettings> snapshot(CounterSettings(0));
+    constexpr uint32_t kPublications = 1u << 18;
+    constexpr int kReaders = 3;
+    std::atomic<bool> done{ false };
+    std::atomic<int> started{ 0 };
+    std::atomic<uint64_t> reads{ 0 }, torn{ 0 }, changes{ 0 }, retries{ 0 };
+    std::vector<std::thread> readers;
+    for (int r = 0; r < kReaders; r++) {
+        readers.emplace_back([&] {
+            uint64_t localReads = 0, localTorn = 0, localChanges = 0, localRetries = 0;
+            uint32_t last = 0;
+            CrosshairSettings seen;
+            started++;
+            while (!done.load(std::memory_order_relaxed)) {
+                if (!snapshot.TryRead(seen)) { localRetries++; continue; }
+                const uint32_t k = seen.fillColor;
+                if (!(seen == CounterSettings(k))) localTorn++;
+                if (k != last) localChanges++;
+                last = k;
+                if ((++localReads & 1023) == 0) std::this_thread::yield();
+            }
+            reads += localReads; torn += localTorn; changes += localChanges; retries += localRetries;
+        });
+    }
+    while (started.load() < kReaders) std::this_thread::yield();
+    for (uint32_t k = 1; k <= kPublications; k++) {
+        snapshot.Publish(CounterSettings(k & 0xFFFFFF));
+        if ((k & 127) == 0) std::this_thread::yield(); // Interleave with the readers even on a single core
+    }
+    done = true;
+    for (std::thread& reader : readers) reader.join();
+
+    std::printf("seqlock stress: %llu reads, %llu distinct values seen, %llu retries, %llu torn\n", (unsigned long long)reads.load(),
+        (unsigned long long)changes.load(), (unsigned long long)retries.load(), (unsigned long long)torn.load());
+    if (changes.load() < 100) {
+        std::printf("seqlock stress: readers never overlapped the writer\n");
+        return false;
+    }
+    if (torn.load() != 0 || snapshot.Read() != CounterSettings(kPublications & 0xFFFFFF) || snapshot.Version() != kPublications + 1) {
+        std::printf("seqlock published a torn or stale snapshot\n");
+        return false;
+    }
+    return true;
+}
+
+// The background kernel must give exactly the reference sums, for any width and row stride, and the
+// picker must choose readable colors and hold them on a background that only changes in detail
+static bool TestAdaptiveContrast() {
+    const struct { int width, height; size_t stride; } shapes[] = { { 64, 64, 64 }, { 61, 37, 64 }, { 3, 5, 7 }, { 256, 256, 256 }, { 1, 1, 1 } };
+    for (const auto& shape : shapes) {
+        const std::vector<uint32_t> frame = SyntheticFrame((int)shape.stride, shape.height, 0x4080C0, 127, (uint32_t)shape.width);
+        BackgroundSums fast, reference;
+        SumBackground(frame.data(), shape.width, shape.height, shape.stride, fast);
+        SumBackgroundReference(frame.data(), shape.width, shape.height, shape.stride, reference);
+        if (fast.red != reference.red || fast.green != reference.green || fast.blue != reference.blue || fast.luma != reference.luma ||
+            fast.lumaSquared != reference.lumaSquared || fast.pixels != reference.pixels) {
+            std::printf("background kernel disagrees with the reference at %dx%d\n", shape.width, shape.height);
+            return false;
+        }
+    }
+
+    const BackgroundStats grey = FrameStats(SyntheticFrame(64, 64, 0x808080, 0, 1), 64);
+    const BackgroundStats red = FrameStats(SyntheticFrame(64, 64, 0xFF0000, 0, 1), 64);
+    const BackgroundStats blue = FrameStats(SyntheticFrame(64, 64, 0x0000FF, 0, 1), 64);
+    if (grey.meanLuma != 128.0f || grey.lumaDeviation != 0.0f || grey.chroma != 0.0f || red.hue != 0.0f || red.chroma != 255.0f || blue.hue != 240.0f) {
+        std::printf("background statistics are wrong\n");
+        return false;
+    }
+
+    // Backgrounds as BGRA 0xRRGGBB; the chosen fill (COLORREF) must stand well apart from each
+    const struct { const char* name; uint32_t rgb; } backgrounds[] = {
+        { "yellow", 0xFFFF00 }, { "white", 0xFFFFFF }, { "black", 0x000000 }, { "green", 0x30C030 }, { "sky", 0x80B0F0 }, { "grey", 0x808080 },
+    };
+    for (const auto& background : backgrounds) {
+        AdaptiveContrast picker;
+        const BackgroundStats stats = FrameStats(SyntheticFrame(64, 64, background.rgb, 12, 7), 64);
+        picker.Update(stats);
+        const uint32_t fill = picker.Current().fill;
+        const float fillR = (float)(fill & 0xFF), fillG = (float)((fill >> 8) & 0xFF), fillB = (float)((fill >> 16) & 0xFF);
+        const float distance = std::sqrt((fillR - stats.meanRed) * (fillR - stats.meanRed) + (fillG - stats.meanGreen) * (fillG - stats.meanGreen) +
+            (fillB - stats.meanBlue) * (fillB - stats.meanBlue));
+        if (distance < 150.0f || (background.rgb == 0xFFFFFF && Luma(fill) > 128) || (background.rgb == 0x000000 && Luma(fill) < 128)) {
+            std::printf("adaptive contrast picked %06X on a %s background\n", fill, background.name);
+            return false;
+        }
+    }
+
+    // Noisy frames of one scene: one pick, then no flicker; a real scene change is followed after the hold
+    AdaptiveContrast picker;
+    for (uint32_t i = 0; i < 1000; i++) picker.Update(FrameStats(SyntheticFrame(64, 64, 0x303830, 48, i), 64));
+    const size_t before = picker.CurrentIndex();
+    const BackgroundStats white = FrameStats(SyntheticFrame(64, 64, 0xFFFFFF, 0, 1), 64);
+    int samples = 0;
+    while (picker.CurrentIndex() == before && samples < 10) { picker.Update(white); samples++; }
+    if (picker.Switches() != 1 || samples != AdaptiveContrast::kDefaultHoldSamples) {
+        std::printf("adaptive contrast hysteresis: %llu switches in all, %d samples to follow a scene change\n",
+            (unsigned long long)picker.Switches(), samples);
+        return false;
+    }
+    return true;
+}
+
+// Bulk code import: a list fed in awkward chunk sizes must import exactly like one fed at once, a million-line
+// file must stream in with every repeat and bad line accounted for, and the nearest-match tree must agree with
+// a brute-force scan
+static bool TestCodeLibrary() {
+    std::string text;
+    size_t badLines = 0;
+    const size_t distinct = CodeListText(20000, 1, text, badLines);
+    CrosshairCodeLibrary whole;
+    CrosshairCodeImporter wholeImporter(whole);
+    wholeImporter.Feed(text);
+    wholeImporter.Finish();
+    const CodeImportStats expected = wholeImporter.Stats();
+    if (whole.Size() != distinct || expected.rejected != badLines || expected.added + expected.duplicates + expected.rejected != expected.codes ||
+        expected.firstRejectedLine != 1001 || expected.firstRejectedStatus != CrosshairCodeStatus::UnknownVersion) {
+        std::printf("code import kept %zu of %zu crosshairs, rejected %llu of %zu bad lines\n", whole.Size(), distinct,
+            (unsigned long long)expected.rejected, badLines);
+        return false;
+    }
+    for (size_t chunk : { (size_t)1, (size_t)7, (size_t)22, (size_t)4096 }) {
+        CrosshairCodeLibrary pieces;
+        CrosshairCodeImporter importer(pieces);
+        for (size_t at = 0; at < text.size(); at += chunk) importer.Feed(std::string_view(text).substr(at, chunk));
+        importer.Finish();
+        const CodeImportStats& stats = importer.Stats();
+        if (pieces.Size() != whole.Size() || stats.lines != expected.lines || stats.duplicates != expected.duplicates ||
+            stats.rejected != expected.rejected || !(pieces.At(pieces.Size() - 1) == whole.At(whole.Size() - 1))) {
+            std::printf("code import in %zu-byte chunks differs from a single chunk\n", chunk);
+            return false;
+        }
+    }
+
+    // A line far too long for a code is rejected even when it spans chunks, and the next line still imports
+    CrosshairCodeLibrary edge;
+    CrosshairCodeImporter edgeImporter(edge);
+    const std::string longLine(1000, 'A');
+    char code[kCrosshairCodeBufferSize];
+    const CrosshairSettings& listed = Range()[42];
+    const std::string valid(code, EncodeCrosshairCode(listed, code, sizeof(code)));
+    edgeImporter.Feed(longLine.substr(0, 600));
+    edgeImporter.Feed(longLine.substr(600) + "\n" + valid.substr(0, 5));
+    edgeImporter.Feed(valid.substr(5));
+    edgeImporter.Finish();
+    if (edge.Size() != 1 || !(edge.At(0) == listed) || edgeImporter.Stats().rejected != 1 || edgeImporter.Stats().firstRejectedLine != 1 ||
+        edgeImporter.Stats().lines != 2) {
+        std::printf("code import mishandles long or unterminated lines\n");
+        return false;
+    }
+
+    const size_t corpusDistinct = CodeListText(1000000, 2, text, badLines);
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "adrixch_tests_codes.txt";
+    if (!WriteTextFile(path, text)) {
+        std::printf("cannot write %s\n", path.string().c_str());
+        return false;
+    }
+    CrosshairCodeLibrary corpus;
+    CodeImportStats stats;
+    const bool imported = ImportCrosshairCodes(path, corpus, stats);
+
+    // The same list imported on the job's worker thread: one import at a time, the callback fires once the
+    // library is indexed, and a cancelled import returns promptly without calling back
+    CrosshairCodeImportJob job;
+    std::atomic<int> jobDone{ 0 };
+    const auto onDone = [](void* context) { static_cast<std::atomic<int>*>(context)->fetch_add(1); };
+    const bool jobStarted = job.Start(path, onDone, &jobDone);
+    const bool jobRefused = !job.Start(path, onDone, &jobDone);
+    while (jobStarted && jobDone.load() == 0) std::this_thread::yield();
+    CrosshairCodeLibrary background;
+    CodeImportStats backgroundStats;
+    const bool backgroundComplete = job.Finish(background, backgroundStats);
+    job.Start(path, onDone, &jobDone);
+    job.Cancel();
+    std::filesystem::remove(path);
+    if (!imported || corpus.Size() != corpusDistinct || stats.rejected != badLines || stats.added + stats.duplicates + stats.rejected != stats.codes) {
+        std::printf("million-code import kept %zu of %zu crosshairs\n", corpus.Size(), corpusDistinct);
+        return false;
+    }
+    if (!jobStarted || !jobRefused || !backgroundComplete || jobDone.load() != 1 || job.Running() ||
+        background.Size() != corpus.Size() || backgroundStats.rejected != stats.rejected || background.Nearest(corpus.At(777)) != 777) {
+        std::printf("background import kept %zu of %zu crosshairs, %d callbacks\n", background.Size(), corpus.Size(), jobDone.load());
+        return false;
+    }
+
+    uint64_t state = 12345;
+    for (int q = 0; q < 8; q++) {
+        const CrosshairSettings query = RandomSettings(state);
+        float distance = 0;
+        const size_t nearest = corpus.Nearest(query, &distance);
+        float bruteForce = INFINITY;
+        for (size_t i = 0; i < corpus.Size(); i++) bruteForce = std::min(bruteForce, CrosshairCodeLibrary::Distance(query, corpus.At(i)));
+        if (nearest == CrosshairCodeLibrary::npos || std::fabs(distance - bruteForce) > 1e-3f ||
+            std::fabs(CrosshairCodeLibrary::Distance(query, corpus.At(nearest)) - distance) > 1e-3f) {
+            std::printf("nearest match %.3f, brute force %.3f\n", distance, bruteForce);
+            return false;
+        }
+    }
+    float self = 1;
+    if (corpus.Nearest(corpus.At(777), &self) != 777 || self != 0) {
+        std::printf("nearest match misses an exact entry\n");
+        return false;
+    }
+    return true;
+}
+
+// Shared GDI objects: equal keys share one object, released ones are reused, the idle set stays bounded, and a
+// settings window opened and painted over and over never creates anything after the first time
+static bool TestGdiCache() {
+    MockGdiAllocator allocator;
+    {
+        GdiResourceCache cache(allocator, 8);
+        const GdiHandle a = cache.Acquire(GdiResourceKey::Brush(0x1E1E1E));
+        const GdiHandle b = cache.Acquire(GdiResourceKey::Brush(0x1E1E1E));
+        const GdiHandle font = cache.Acquire(GdiResourceKey::Font("Segoe UI", 18));
+        const GdiHandle pen = cache.Acquire(GdiResourceKey::Pen(0x1E1E1E, 1));
+        if (a != b || a == font || a == pen || cache.References(a) != 2 || allocator.live != 3) {
+            std::printf("gdi cache does not share equal keys\n");
+            return false;
+        }
+        cache.Release(a);
+        cache.Release(b);
+        cache.Release(b); // One release too many is ignored
+        if (cache.References(a) != 0 || cache.Acquire(GdiResourceKey::Brush(0x1E1E1E)) != a || cache.GetStats().created != 3) {
+            std::printf("gdi cache does not reuse released objects\n");
+            return false;
+        }
+        cache.Release(a);
+
+        // Many distinct colors: referenced objects survive, idle ones are evicted down to the bound
+        for (uint32_t i = 0; i < 1000; i++) cache.Release(cache.Acquire(GdiResourceKey::Brush(i)));
+        if (allocator.live != 8 || cache.GetStats().live != 8 || cache.GetStats().peakLive > 8 || cache.References(font) != 1 ||
+            cache.References(pen) != 1) {
+            std::printf("gdi cache holds %zu objects, bound is 8\n", allocator.live);
+            return false;
+        }
+        allocator.failNext = true;
+        if (cache.Acquire(GdiResourceKey::Brush(0xABCDEF)) != 0 || cache.GetStats().failures != 1) {
+            std::printf("gdi cache hides an allocation failure\n");
+            return false;
+        }
+        cache.Release(font);
+        cache.Release(pen);
+        cache.Trim();
+        if (allocator.live != 0 || cache.GetStats().live != 0) {
+            std::printf("gdi cache trim left %zu objects\n", allocator.live);
+            return false;
+        }
+
+        // The settings window's lifetime pattern: class brush held, font and button brush per window, one brush
+        // per label and per button paint
+        GdiResource background(cache, GdiResourceKey::Brush(0x000000));
+        for (int open = 0; open < 10000; open++) {
+            GdiResource windowFont(cache, GdiResourceKey::Font("Segoe UI", 18, 400));
+            GdiResource buttonBrush(cache, GdiResourceKey::Brush(0x1E1E1E));
+            for (int paint = 0; paint < 20; paint++) {
+                GdiResource label(cache, GdiResourceKey::Brush(0x000000));
+                if (label.Get() != background.Get()) { std::printf("gdi cache label brush is not shared\n"); return false; }
+            }
+        }
+        if (allocator.live != 3 || cache.GetStats().created != 1003 + 3) {
+            std::printf("gdi objects grew while reopening the settings window: %zu live\n", allocator.live);
+            return false;
+        }
+        (void)cache.Acquire(GdiResourceKey::Pen(0xFFFFFF, 2)); // Leaked reference: the cache still frees it
+    }
+    if (allocator.live != 0 || allocator.badFrees != 0) {
+        std::printf("gdi cache teardown: %zu objects left, %llu bad frees\n", allocator.live, (unsigned long long)allocator.badFrees);
+        return false;
+    }
+    return true;
+}
+
+// Settings hot reload: a changed file yields exactly the fields it changed, an identical rewrite and our own
+// save yield nothing, and the watcher reports writes and renames onto the file but not its neighbours
+static bool TestSettingsReload() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path();
+    const std::filesystem::path ini = dir / "adrixch_tests_reload.ini";
+    const std::filesystem::path neighbour = dir / "adrixch_tests_reload.txt";
+    const uint32_t gapAndThickness = CrosshairFieldBit(CrosshairField::GapSize) | CrosshairFieldBit(CrosshairField::Thickness);
+    SettingsStore store;
+    uint32_t fields = 0;
+    WriteTextFile(ini, "[Crosshair]\r\nLength=10\r\nGapSize=4\r\n[Adaptive]\r\nEnabled=1\r\n");
+    store.Load(ini);
+    const bool unchanged = !store.Reload(ini, fields) && fields == 0;
+    WriteTextFile(ini, "[Crosshair]\r\nLength=10\r\nGapSize=6\r\nThickness=3\r\n[Adaptive]\r\nEnabled=0\r\n");
+    const bool changed = store.Reload(ini, fields) && fields == gapAndThickness && store.Crosshair().gap == 6 &&
+        !store.GetFlag("Adaptive", "Enabled", true);
+    store.Set("Adaptive", "Enabled", "1");
+    const bool ownSave = store.Save(ini) && !store.Reload(ini, fields) && fields == 0;
+    if (!unchanged || !changed || !ownSave) {
+        std::printf("settings reload: unchanged %d, changed %d, own save ignored %d\n", unchanged, changed, ownSave);
+        return false;
+    }
+
+    // Only the fields the file changed are applied; a field edited locally in the meantime is kept
+    CrosshairSettings live = store.Crosshair();
+    live.len = 30;
+    CrosshairSettings fromFile = store.Crosshair();
+    fromFile.gap = 9;
+    CopyCrosshairFields(live, fromFile, DiffCrosshairSettings(store.Crosshair(), fromFile));
+    if (live.len != 30 || live.gap != 9 || DiffCrosshairSettings(CounterSettings(1), CounterSettings(2)) != kAllCrosshairFields ||
+        DiffCrosshairSettings(Range()[7], Range()[7]) != 0) {
+        std::printf("settings field diff is wrong\n");
+        return false;
+    }
+
+#ifdef __linux__
+    std::atomic<int> notifications{ 0 };
+    InotifyFileWatcher watcher;
+    if (!watcher.Start(ini, [](void* count) { static_cast<std::atomic<int>*>(count)->fetch_add(1); }, &notifications)) {
+        std::printf("cannot watch %s\n", dir.string().c_str());
+        return false;
+    }
+    auto waitFor = [&](int count) {
+        for (int i = 0; i < 400 && notifications.load() < count; i++) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        return notifications.load();
+    };
+    WriteTextFile(neighbour, "not the settings");
+    const int afterNeighbour = (std::this_thread::sleep_for(std::chrono::milliseconds(50)), notifications.load());
+    WriteTextFile(ini, "[Crosshair]\r\nLength=12\r\n");
+    const int afterWrite = waitFor(1);
+    store.Set("Crosshair", "Length", "14");
+    store.Save(ini); // Temporary file renamed over the settings
+    const int afterRename = waitFor(afterWrite + 1);
+    watcher.Stop();
+    if (afterNeighbour != 0 || afterWrite < 1 || afterRename <= afterWrite) {
+        std::printf("settings watcher: %d notifications for a neighbour, %d after a write, %d after a rename\n", afterNeighbour, afterWrite,
+            afterRename);
+        return false;
+    }
+#endif
+
+    std::filesystem::remove(ini);
+    std::filesystem::remove(neighbour);
+    return true;
+}
+
+// Control channel: commands arrive in order with their sequence, bad values leave the settings alone, a full
+// ring refuses further sends, and a server sleeping on the doorbell acknowledges every command sent to it
+static bool TestControlChannel() {
+    const std::vector<CrosshairSettings>& range = Range();
+    const size_t n = range.size();
+    ControlChannelServer server;
+    ControlChannelClient client;
+    const bool noServer = server.Create("AdrixCH.Tests") && (server.Close(), !client.Open("AdrixCH.Tests"));
+    if (!noServer || !server.Create("AdrixCH.Tests") || !client.Open("AdrixCH.Tests")) {
+        std::printf("control channel: no server %d, created %d, opened %d\n", noServer, server.IsOpen(), client.IsOpen());
+        return false;
+    }
+
+    CrosshairSettings controlled;
+    const std::string code = NarrowCode(range[n / 2]);
+    const uint64_t sequences[] = {
+        client.SetField(CrosshairField::GapSize, 9), client.SetField(CrosshairField::Length, kLengthMax + 1),
+        client.LoadCode(code), client.LoadCode("NOT-A-CODE"), client.StepProfile(-1),
+    };
+    const ControlStatus expected[] = {
+        ControlStatus::Applied, ControlStatus::Rejected, ControlStatus::Applied, ControlStatus::Rejected, ControlStatus::Rejected,
+    };
+    ControlCommand command;
+    for (size_t i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++) {
+        const CrosshairSettings before = controlled;
+        if (sequences[i] != i + 1 || !server.Poll(command) || command.sequence != sequences[i]) {
+            std::printf("control channel: command %zu sent as %llu, received as %llu\n", i, (unsigned long long)sequences[i],
+                (unsigned long long)command.sequence);
+            return false;
+        }
+        const ControlStatus status = ApplyControlCommand(command, controlled);
+        server.Acknowledge(command.sequence, status);
+        if (client.WaitForAck(sequences[i], 1000) != expected[i] || (status != ControlStatus::Applied && !(controlled == before))) {
+            std::printf("control channel: command %zu was not %s\n", i, expected[i] == ControlStatus::Applied ? "applied" : "rejected");
+            return false;
+        }
+        if (i == 0 && controlled.gap != 9) { std::printf("control channel: gap not set\n"); return false; }
+    }
+    if (!(controlled == range[n / 2]) || server.Poll(command)) {
+        std::printf("control channel: code not loaded, or a command arrived twice\n");
+        return false;
+    }
+
+    // Settings loaded from the INI may be wider than the sliders; that must not block setting another field
+    CrosshairSettings wide = range[n / 2];
+    wide.len = kLengthMax + 20;
+    ControlCommand setGap;
+    setGap.type = ControlCommandType::SetField;
+    setGap.field = CrosshairField::GapSize;
+    setGap.value = 4;
+    ControlCommand setLength = setGap;
+    setLength.field = CrosshairField::Length;
+    setLength.value = kLengthMax + 1;
+    if (ApplyControlCommand(setGap, wide) != ControlStatus::Applied || wide.gap != 4 || wide.len != kLengthMax + 20 ||
+        ApplyControlCommand(setLength, wide) != ControlStatus::Rejected || wide.len != kLengthMax + 20) {
+        std::printf("control channel: a field was judged by the range of another\n");
+        return false;
+    }
+
+    uint64_t last = 0;
+    for (uint32_t i = 0; i < ControlChannelLayout::kCapacity; i++) last = client.ToggleVisible();
+    const uint64_t overflow = client.ToggleVisible();
+    uint32_t drained = 0;
+    while (server.Poll(command)) {
+        drained++;
+        server.Acknowledge(command.sequence, ControlStatus::Applied);
+    }
+    if (last == 0 || overflow != 0 || drained != ControlChannelLayout::kCapacity || client.Acknowledged() != last || server.Malformed() != 0) {
+        std::printf("control channel: full ring sent %llu, overflow %llu, drained %u\n", (unsigned long long)last, (unsigned long long)overflow, drained);
+        return false;
+    }
+
+    // The server sleeps on the doorbell between commands, the way the overlay sleeps in its message loop
+    std::atomic<bool> done{ false };
+    std::thread serverThread([&] {
+        CrosshairSettings settings;
+        ControlCommand received;
+        while (!done.load(std::memory_order_relaxed)) {
+            if (!server.Wait(1000)) continue;
+            while (server.Poll(received)) server.Acknowledge(received.sequence, ApplyControlCommand(received, settings));
+        }
+    });
+    uint64_t timeouts = 0;
+    for (int i = 0; i < 2000; i++) {
+        const uint64_t sequence = client.SetField(CrosshairField::GapSize, i % 8);
+        if (client.WaitForAck(sequence, 1000000) != ControlStatus::Applied) timeouts++;
+    }
+    done = true;
+    serverThread.join();
+    if (timeouts != 0) {
+        std::printf("control channel: %llu round trips were not acknowledged\n", (unsigned long long)timeouts);
+        return false;
+    }
+    return true;
+}
+
+// Animation: every frame of the atlas is the rasterized frame, pixel for pixel, in cells sharing one center;
+// rebuilding does not allocate; the fixed-step clock counts skipped steps as dropped and slow ones as late
+static bool TestAnimation() {
+    const std::vector<CrosshairSettings>& range = Range();
+    const size_t n = range.size();
+    AnimationMode mode = AnimationMode::None;
+    if (!ParseAnimationMode(" Color-Cycle", mode) || mode != AnimationMode::ColorCycle || ParseAnimationMode("spin", mode)) {
+        std::printf("animation mode parsing failed\n");
+        return false;
+    }
+
+    AnimationSettings animation;
+    std::vector<CrosshairSettings> frames;
+    AnimationAtlas atlas;
+    for (AnimationMode m : { AnimationMode::ExpandGap, AnimationMode::Pulse, AnimationMode::ColorCycle }) {
+        animation.mode = m;
+        const CrosshairSettings base = range[(size_t)m * 977 % n];
+        BuildAnimationFrames(base, animation, frames);
+        const size_t expectedFrames = m == AnimationMode::ColorCycle ? kColorCycleFrames : (size_t)animation.amount + 1;
+        if (frames.size() != expectedFrames || !(frames[0] == base) || frames[1] == frames[0]) {
+            std::printf("animation mode %d built %zu frames\n", (int)m, frames.size());
+            return false;
+        }
+        atlas.Build(frames);
+        CrosshairSprite sprite;
+        for (size_t f = 0; f < frames.size(); f++) {
+            RasterizeCrosshair(frames[f], sprite);
+            const uint32_t* cell = atlas.FramePixels(f);
+            uint64_t painted = 0, cellPainted = 0;
+            for (int y = 0; y < atlas.CellHeight(); y++) {
+                for (int x = 0; x < atlas.CellWidth(); x++) cellPainted += cell[(size_t)y * atlas.CellWidth() + x] != 0;
+            }
+            for (int y = 0; y < sprite.height; y++) {
+                for (int x = 0; x < sprite.width; x++) {
+                    const uint32_t pixel = sprite.pixels[(size_t)y * sprite.width + x];
+                    const int cx = x - sprite.originX + atlas.OriginX(), cy = y - sprite.originY + atlas.OriginY();
+                    painted += pixel != 0;
+                    if (pixel != 0 && cell[(size_t)cy * atlas.CellWidth() + cx] != pixel) painted = UINT64_MAX;
+                }
+            }
+            if (painted != cellPainted) {
+                std::printf("animation atlas frame %zu of mode %d does not match its sprite\n", f, (int)m);
+                return false;
+            }
+        }
+    }
+    animation.mode = AnimationMode::Pulse;
+    BuildAnimationFrames(range[n / 3], animation, frames);
+    atlas.Build(frames);
+    const uint64_t allocsBefore = HeapAllocationCount();
+    atlas.Build(frames);
+    if (HeapAllocationCount() != allocsBefore) {
+        std::printf("rebuilding the animation atlas allocated\n");
+        return false;
+    }
+
+    // 60 Hz pulse: on-time steps, then three steps at once (two dropped), then one step presented late
+    AnimationTimeline timeline;
+    timeline.Configure(animation, frames.size(), 1000000);
+    const uint64_t step = timeline.StepUs();
+    uint64_t now = 1000000;
+    for (int i = 1; i <= 30; i++) timeline.Advance(now = 1000000 + i * step + 100);
+    const AnimationStats onTime = timeline.Stats();
+    timeline.Advance(now += 3 * step);
+    const AnimationStats skipped = timeline.Stats();
+    timeline.Advance(now + step + step * 7 / 10);
+    const AnimationStats late = timeline.Stats();
+    if (onTime.steps != 30 || onTime.frames != 30 || onTime.dropped != 0 || onTime.late != 0 || skipped.dropped != 2 ||
+        skipped.steps != 33 || late.steps != 34 || late.late != 1 || late.dropped != 2) {
+        std::printf("animation clock: %llu steps, %llu dropped, %llu late\n", (unsigned long long)late.steps,
+            (unsigned long long)late.dropped, (unsigned long long)late.late);
+        return false;
+    }
+
+    // Expanding gap: opens fully while held, stops, and closes after release; the idle time in between drops nothing
+    AnimationSettings expand;
+    expand.mode = AnimationMode::ExpandGap;
+    BuildAnimationFrames(range[n / 3], expand, frames);
+    AnimationTimeline gap;
+    gap.Configure(expand, frames.size(), 0);
+    gap.SetHeld(true, 5000000);
+    for (now = 5000000; gap.Running(); now += gap.StepUs()) gap.Advance(now);
+    const size_t open = gap.Frame();
+    gap.SetHeld(false, now + 10000000);
+    for (now += 10000000; gap.Running(); now += gap.StepUs()) gap.Advance(now);
+    if (open != frames.size() - 1 || gap.Frame() != 0 || gap.Stats().dropped != 0 || gap.Stats().late != 0) {
+        std::printf("expanding gap: opened to frame %zu, closed to %zu, %llu dropped\n", open, gap.Frame(), (unsigned long long)gap.Stats().dropped);
+        return false;
+    }
+    return true;
+}
+
+// Steady state: once warm, the overlay thread takes a slider move, a code load or a paint from the edited settings
+// to the drawn sprites and the settings window text without a single heap allocation
+static bool TestSteadyState() {
+    const std::vector<CrosshairSettings>& range = Range();
+    SteadyStateOverlay overlay(range);
+    CrosshairSettings& edited = overlay.edited;
+
+    // Change detection: the moved slider's label and the code box, nothing for a repeat, everything after a reset
+    overlay.Update(kAllCrosshairFields);
+    edited.gap = 5;
+    overlay.Update(CrosshairFieldBit(CrosshairField::GapSize));
+    const uint32_t sliderControls = overlay.changedControls;
+    overlay.Update(CrosshairFieldBit(CrosshairField::GapSize));
+    const uint32_t repeatControls = overlay.changedControls;
+    edited.tStyle = true;
+    overlay.Update(CrosshairFieldBit(CrosshairField::TStyle));
+    const uint32_t toggleControls = overlay.changedControls;
+    overlay.panel.Reset();
+    overlay.Update(kAllCrosshairFields);
+    wchar_t code[kCrosshairCodeBufferSize];
+    EncodeCrosshairCode(edited, code, kCrosshairCodeBufferSize);
+    if (sliderControls != (SettingsControlBit(SettingsControl::GapLabel) | SettingsControlBit(SettingsControl::CodeBox)) ||
+        repeatControls != 0 ||
+        toggleControls != (SettingsControlBit(SettingsControl::TStyleButton) | SettingsControlBit(SettingsControl::CodeBox)) ||
+        overlay.changedControls != (1u << kSettingsControlCount) - 1 || std::wcscmp(overlay.panel.Text(SettingsControl::GapLabel), L"Gap: 5") != 0 ||
+        std::wcscmp(overlay.panel.Text(SettingsControl::TStyleButton), L"T-Style: ON") != 0 ||
+        std::wcscmp(overlay.panel.Text(SettingsControl::CodeBox), code) != 0) {
+        std::printf("settings panel change detection failed\n");
+        return false;
+    }
+
+    // Warm up with each path once, then go through all of them again counting allocations
+    struct { const char* name; uint64_t allocations; } paths[] = { { "slider move", 0 }, { "code load", 0 }, { "paint", 0 } };
+    for (int pass = 0; pass < 2; pass++) {
+        edited = range[range.size() / 2]; // The same crosshair under the slider every pass
+        uint64_t before = ThreadHeapAllocationCount();
+        for (int round = 0; round < 2; round++) {
+            for (int gap = kGapMin; gap <= 20; gap++) overlay.Slide(gap);
+        }
+        paths[0].allocations = ThreadHeapAllocationCount() - before;
+        before = ThreadHeapAllocationCount();
+        for (size_t i = 0; i < 32; i++) overlay.LoadCode(i);
+        paths[1].allocations = ThreadHeapAllocationCount() - before;
+        before = ThreadHeapAllocationCount();
+        for (int i = 0; i < 1000; i++) overlay.Paint();
+        paths[2].allocations = ThreadHeapAllocationCount() - before;
+    }
+    for (const auto& path : paths) {
+        if (path.allocations != 0) {
+            std::printf("steady-state %s made %llu heap allocations\n", path.name, (unsigned long long)path.allocations);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Startup: each phase is marked once, relative to the process start given, and the dump checks the budgets
+static bool TestStartupTrace() {
+    TraceStartupBegin(TraceNow() - 1000);
+    TraceStartupMark(StartupPhase::Paths);
+    TraceStartupMark(StartupPhase::FirstFrame);
+    const uint64_t paths = TraceStartupNs(StartupPhase::Paths), firstFrame = TraceStartupNs(StartupPhase::FirstFrame);
+    TraceStartupMark(StartupPhase::FirstFrame);
+    if (paths < 1000 || firstFrame < paths || TraceStartupNs(StartupPhase::FirstFrame) != firstFrame ||
+        TraceStartupNs(StartupPhase::Settings) != 0) {
+        std::printf("startup marks: paths %llu ns, first frame %llu ns\n", (unsigned long long)paths, (unsigned long long)firstFrame);
+        return false;
+    }
+
+    const std::filesystem::path dumpPath = std::filesystem::temp_directory_path() / "adrixch_tests_trace.txt";
+    std::string dump;
+    if (TraceDump(dumpPath)) {
+        if (FILE* file = std::fopen(dumpPath.string().c_str(), "rb")) {
+            char block[4096];
+            for (size_t read; (read = std::fread(block, 1, sizeof(block), file)) > 0;) dump.append(block, read);
+            std::fclose(file);
+        }
+    }
+    std::filesystem::remove(dumpPath);
+    char expected[128];
+    std::snprintf(expected, sizeof(expected), "\nfirst-frame,%llu,%llu,yes\n", (unsigned long long)firstFrame, (unsigned long long)kFirstFrameBudgetNs);
+    if (dump.find("\nphase,end,duration\npaths,") == std::string::npos || dump.find(expected) == std::string::npos ||
+        dump.find("\nsettings-show-p99,,16000000,unmeasured\n") == std::string::npos || dump.find("\nsettings,") != std::string::npos) {
+        std::printf("trace dump lacks the startup phases and budgets\n");
+        return false;
+    }
+    return true;
+}
+
+// Hotkeys: a scripted source on its own thread drives the dispatcher. Bindings match with their exact modifiers,
+// auto-repeat and presses inside the debounce window are dropped, and presses and releases come out in order.
+static bool TestHotkeys() {
+    const HotkeyBinding bindings[] = {
+        { kKeyF12, 0, HotkeyAction::OpenSettings },
+        { kKeyF1 + 10, kModCtrl, HotkeyAction::NextProfile },
+        { kKeyF1 + 6, kModCtrl, HotkeyAction::AnimationHold },
+    };
+    HotkeyDispatcher dispatcher;
+    dispatcher.SetBindings(bindings, 3);
+    std::atomic<uint64_t> wakes{ 0 };
+    dispatcher.SetWakeCallback([](void* context) { static_cast<std::atomic<uint64_t>*>(context)->fetch_add(1); }, &wakes);
+
+    FakeInputSource source;
+    source.SetScript({
+        { kKeyF12, 0, true, 1000 },
+        { kKeyF12, 0, true, 1100 },        // Auto-repeat
+        { kKeyF12, 0, true, 1200 },
+        { kKeyF12, 0, false, 1300 },
+        { kKeyF12, 0, true, 50000 },       // Inside the 200 ms debounce window of the press at 1000
+        { kKeyF12, 0, false, 60000 },      // Release of a press that was dropped
+        { kKeyF12, 0, true, 201000 },      // First press after the window
+        { kKeyF12, 0, false, 201100 },
+        { kKeyF1 + 10, 0, true, 400000 },  // NextProfile without Ctrl
+        { kKeyF1 + 10, kModCtrl | kModShift, true, 400050 },
+        { kKeyF1 + 10, kModCtrl, true, 400100 },
+        { kKeyF1 + 10, 0, false, 400200 }, // Ctrl let go first: the release still counts
+        { kKeyF1 + 6, kModCtrl, true, 500000 },
+        { kKeyF1 + 6, kModCtrl, true, 530000 },
+        { kKeyF1 + 6, 0, false, 700000 },
+    });
+    source.Start(dispatcher, bindings, 3);
+    source.Stop();
+    const HotkeyEvent expected[] = {
+        { HotkeyAction::OpenSettings, true, 1000 },
+        { HotkeyAction::OpenSettings, false, 1300 },
+        { HotkeyAction::OpenSettings, true, 201000 },
+        { HotkeyAction::OpenSettings, false, 201100 },
+        { HotkeyAction::NextProfile, true, 400100 },
+        { HotkeyAction::NextProfile, false, 400200 },
+        { HotkeyAction::AnimationHold, true, 500000 },
+        { HotkeyAction::AnimationHold, false, 700000 },
+    };
+    size_t received = 0;
+    HotkeyEvent event;
+    bool matches = source.Finished();
+    while (dispatcher.Poll(event)) {
+        const HotkeyEvent& want = expected[received < 8 ? received : 7];
+        matches = matches && received < 8 && event.action == want.action && event.pressed == want.pressed && event.timeUs == want.timeUs;
+        received++;
+    }
+    if (!matches || received != 8 || wakes.load() != 8 || dispatcher.DroppedEvents() != 0) {
+        std::printf("hotkey dispatch: %zu events, %llu wakes\n", received, (unsigned long long)wakes.load());
+        return false;
+    }
+
+    // A long run of presses and releases, polled while the source is still replaying: everything delivered comes
+    // out in order, and what did not fit in the queue is counted rather than lost silently
+    std::vector<KeyEvent> script;
+    constexpr uint64_t kPresses = 5000;
+    for (uint64_t k = 0; k < kPresses; k++) {
+        script.push_back({ kKeyF12, 0, true, 1000000 + k * 250000 });
+        script.push_back({ kKeyF12, 0, false, 1000000 + k * 250000 + 1000 });
+    }
+    source.SetScript(script);
+    uint64_t delivered = 0, lastTime = 0;
+    bool ordered = true;
+    source.Start(dispatcher, bindings, 3);
+    for (bool done = false; !done;) {
+        done = source.Finished();
+        while (dispatcher.Poll(event)) {
+            ordered = ordered && event.timeUs > lastTime && event.pressed == ((event.timeUs - 1000000) % 250000 == 0);
+            lastTime = event.timeUs;
+            delivered++;
+        }
+        if (!done) std::this_thread::yield();
+    }
+    source.Stop();
+    if (!ordered || delivered + dispatcher.DroppedEvents() != 2 * kPresses) {
+        std::printf("hotkey queue: %llu delivered, %llu dropped, ordered %d\n", (unsigned long long)delivered,
+            (unsigned long long)dispatcher.DroppedEvents(), (int)ordered);
+        return false;
+    }
+    return true;
+}
+
+// Sprite cache: the least recently used look is the one evicted, the byte cap holds, the counters add up, and
+// nothing survives Invalidate
+static bool TestSpriteCache() {
+    const std::vector<CrosshairSettings>& range = Range();
+    const size_t n = range.size();
+    SpriteCache lru(64u << 20, 4);
+    const CrosshairSettings& a = range[0];
+    const CrosshairSettings& b = range[8];
+    const CrosshairSettings& c = range[16];
+    const CrosshairSettings& d = range[24];
+    const CrosshairSettings& e = range[32];
+    auto counters = [&](uint64_t hits, uint64_t misses, uint64_t evictions, size_t entries) {
+        const SpriteCache::Stats& stats = lru.GetStats();
+        return stats.hits == hits && stats.misses == misses && stats.evictions == evictions && stats.entries == entries;
+    };
+    lru.Get(a); lru.Get(b); lru.Get(c); lru.Get(d);
+    lru.Get(a);                                   // b is now the least recently used
+    const bool filled = counters(1, 4, 0, 4);
+    lru.Get(e);                                   // Past the cap: evicts b
+    const bool evicted = counters(1, 5, 1, 4);
+    lru.Get(a); lru.Get(c); lru.Get(d); lru.Get(e);
+    const bool kept = counters(5, 5, 1, 4);
+    lru.Get(b);                                   // Back in, evicting a, now the oldest
+    lru.Get(c);
+    const bool readded = counters(6, 6, 2, 4);
+    lru.Get(a);
+    const bool victim = counters(6, 7, 3, 4);
+    lru.Invalidate();
+    const bool emptied = lru.GetStats().entries == 0 && lru.GetStats().bytes == 0;
+    lru.Get(a);
+    const bool refetched = counters(6, 8, 3, 1);
+    if (!filled || !evicted || !kept || !readded || !victim || !emptied || !refetched) {
+        std::printf("sprite cache LRU: filled %d evicted %d kept %d readded %d victim %d emptied %d refetched %d\n",
+            (int)filled, (int)evicted, (int)kept, (int)readded, (int)victim, (int)emptied, (int)refetched);
+        return false;
+    }
+
+    // Under a byte cap only a few sprites fit; every look beyond them evicts, and the held bytes never exceed it
+    CrosshairSprite probe;
+    RasterizeCrosshair(range[n / 2], probe);
+    const size_t cap = probe.pixels.capacity() * sizeof(uint32_t) * 3;
+    SpriteCache bounded(cap, 1024);
+    size_t worst = 0;
+    for (size_t i = n / 2; i < n / 2 + 256; i++) {
+        const CrosshairSprite& sprite = bounded.Get(range[i]);
+        const SpriteCache::Stats& stats = bounded.GetStats();
+        if (stats.entries > 1 || sprite.pixels.capacity() * sizeof(uint32_t) <= cap) worst = stats.bytes > worst ? stats.bytes : worst;
+    }
+    const SpriteCache::Stats& stats = bounded.GetStats();
+    if (worst > cap || stats.misses != 256 || stats.hits != 0 || stats.evictions != 256 - stats.entries) {
+        std::printf("sprite cache bytes: worst %zu of %zu, %llu misses, %llu evictions, %zu entries\n", worst, cap,
+            (unsigned long long)stats.misses, (unsigned long long)stats.evictions, stats.entries);
+        return false;
+    }
+    return true;
+}
+
+// Golden images: small fixed looks must come out of the rect rasterizer pixel for pixel as drawn here
+// ('#' fill, 'o' outline, '.' transparent), with the origin at the crosshair center
+static bool TestGoldenImages() {
+    struct Golden { const char* name; int len, gap, thickness, outline; bool dot, tStyle; int originX, originY; const char* rows[16]; };
+    const Golden goldens[] = {
+        { "no dot, no outline", 3, 1, 1, 0, false, false, 4, 4, {
+            "...##...",
+            "...##...",
+            "...##...",
+            "###..###",
+            "###..###",
+            "...##...",
+            "...##...",
+            "...##...", } },
+        { "dot, no outline", 3, 1, 1, 0, true, false, 4, 4, {
+            "...##...",
+            "...##...",
+            "...##...",
+            "########",
+            "########",
+            "...##...",
+            "...##...",
+            "...##...", } },
+        { "dot, outline 1", 3, 1, 1, 1, true, false, 5, 5, {
+            "...oooo...",
+            "...o##o...",
+            "...o##o...",
+            "oooo##oooo",
+            "o########o",
+            "o########o",
+            "oooo##oooo",
+            "...o##o...",
+            "...o##o...",
+            "...oooo...", } },
+        { "no dot, outline 1", 3, 1, 1, 1, false, false, 5, 5, {
+            "...oooo...",
+            "...o##o...",
+            "...o##o...",
+            "oooo##oooo",
+            "o###oo###o",
+            "o###oo###o",
+            "oooo##oooo",
+            "...o##o...",
+            "...o##o...",
+            "...oooo...", } },
+        { "thickness 3, outline 2", 4, 2, 3, 2, false, false, 8, 8, {
+            "...oooooooooo...",
+            "...oooooooooo...",
+            "...oo######oo...",
+            "ooooo######ooooo",
+            "ooooo######ooooo",
+            "oo############oo",
+            "oo####oooo####oo",
+            "oo####oooo####oo",
+            "oo####oooo####oo",
+            "oo####oooo####oo",
+            "oo############oo",
+            "ooooo######ooooo",
+            "ooooo######ooooo",
+            "...oo######oo...",
+            "...oooooooooo...",
+            "...oooooooooo...", } },
+        { "thickness 3, outline 2, dot, T-style", 4, 2, 3, 2, true, true, 8, 5, {
+            "oooooooooooooooo",
+            "oooooooooooooooo",
+            "oo############oo",
+            "oo############oo",
+            "oo############oo",
+            "oo############oo",
+            "oo############oo",
+            "oo############oo",
+            "ooooo######ooooo",
+            "ooooo######ooooo",
+            "...oo######oo...",
+            "...oooooooooo...",
+            "...oooooooooo...", } },
+    };
+    CrosshairSprite sprite;
+    for (const Golden& golden : goldens) {
+        CrosshairSettings look;
+        look.len = golden.len;
+        look.gap = golden.gap;
+        look.thickness = golden.thickness;
+        look.outlineThickness = golden.outline;
+        look.centerDot = golden.dot;
+        look.tStyle = golden.tStyle;
+        RasterizeCrosshair(look, sprite);
+
+        int height = 0;
+        while (height < 16 && golden.rows[height]) height++;
+        const int width = (int)std::strlen(golden.rows[0]);
+        bool same = sprite.width == width && sprite.height == height && sprite.originX == golden.originX && sprite.originY == golden.originY;
+        for (int y = 0; same && y < height; y++) {
+            for (int x = 0; same && x < width; x++) {
+                const char c = golden.rows[y][x];
+                const uint32_t want = c == '#' ? ColorRefToPixel(look.fillColor) : c == 'o' ? ColorRefToPixel(look.outlineColor) : 0;
+                same = sprite.pixels[(size_t)y * width + x] == want;
+            }
+        }
+        if (!same) {
+            std::printf("golden image '%s' differs (%dx%d, origin %d,%d):\n", golden.name, sprite.width, sprite.height, sprite.originX, sprite.originY);
+            for (int y = 0; y < sprite.height; y++) {
+                for (int x = 0; x < sprite.width; x++) {
+                    const uint32_t pixel = sprite.pixels[(size_t)y * sprite.width + x];
+                    std::putchar(pixel == 0 ? '.' : pixel == ColorRefToPixel(look.fillColor) ? '#' : pixel == ColorRefToPixel(look.outlineColor) ? 'o' : '?');
+                }
+                std::putchar('\n');
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+// Settings parser edge cases: every file below loads without throwing, and what it cannot use falls back to
+// the defaults and is counted as malformed
+static bool TestSettingsParser() {
+    SettingsStore parsed;
+    const CrosshairSettings defaults;
+    std::vector<std::string> failures;
+    auto expect = [&](const char* what, bool ok) { if (!ok) failures.push_back(what); };
+
+    // UTF-8 with a BOM and CRLF line breaks: the BOM is not part of the first line and no value keeps its '\r'
+    parsed.LoadFromString("\xEF\xBB\xBF[Crosshair]\r\nLength=12\r\nGapSize=3\r\n");
+    expect("utf-8 bom", parsed.Crosshair().len == 12 && parsed.Crosshair().gap == 3 && parsed.MalformedCount() == 0 &&
+        parsed.Get("Crosshair", "Length") == "12");
+
+    // UTF-16LE with CRLF, as written by the Win32 profile APIs; non-ASCII text comes back as UTF-8
+    std::string utf16 = "\xFF\xFE";
+    for (char16_t unit : std::u16string(u"[Crosshair]\r\nLength=14\r\n[Profile]\r\nName=Vis\u00E9e \U0001F3AF\r\n")) {
+        utf16 += (char)(unit & 0xFF);
+        utf16 += (char)(unit >> 8);
+    }
+    parsed.LoadFromString(utf16);
+    expect("utf-16le", parsed.Crosshair().len == 14 && parsed.MalformedCount() == 0 &&
+        parsed.Get("Profile", "Name") == "Vis\xC3\xA9" "e \xF0\x9F\x8E\xAF");
+
+    // A section header without ']' is skipped: the keys after it stay in the section before
+    parsed.LoadFromString("[Crosshair]\nLength=12\n[Hotkeys\nGapSize=4\n");
+    expect("missing ]", parsed.MalformedCount() == 1 && parsed.Crosshair().len == 12 && parsed.Crosshair().gap == 4 &&
+        parsed.Get("Hotkeys", "GapSize", "none") == "none");
+
+    // Keys before any section belong to the unnamed section, not to the crosshair
+    parsed.LoadFromString("Length=30\n[Crosshair]\nGapSize=5\n");
+    expect("keys before a section", parsed.MalformedCount() == 0 && parsed.Crosshair().len == defaults.len &&
+        parsed.Crosshair().gap == 5 && parsed.Get("", "Length") == "30");
+
+    // Values that are not numbers, or do not fit, keep the defaults
+    parsed.LoadFromString("[Crosshair]\nLength=abc\nGapSize=12px\nThickness=\nFillColor=99999999999\n"
+        "OutlineColor=16777216\nRotation=-1\nCircleRadius=+8\n[Overlay]\nSize=99999999999\nScale=2147483648\n");
+    expect("bad integers", parsed.MalformedCount() == 6 && parsed.Crosshair().len == defaults.len &&
+        parsed.Crosshair().gap == defaults.gap && parsed.Crosshair().thickness == defaults.thickness &&
+        parsed.Crosshair().fillColor == defaults.fillColor && parsed.Crosshair().outlineColor == defaults.outlineColor &&
+        parsed.Crosshair().rotation == defaults.rotation && parsed.Crosshair().circleRadius == 8 &&
+        parsed.GetInt("Overlay", "Size", 5, 0, 10) == 5 && parsed.GetInt("Overlay", "Scale", 5, 0, 10) == 10);
+
+    // A key given twice, in any case and in a reopened section, keeps its last value and is written once
+    parsed.LoadFromString("[Crosshair]\nLength=10\nlength=20\n[crosshair]\nLENGTH=25\n");
+    expect("duplicate keys", parsed.MalformedCount() == 0 && parsed.Crosshair().len == 25 &&
+        parsed.Serialize() == "[Crosshair]\r\nLength=25\r\n");
+
+    if (!failures.empty()) {
+        for (const std::string& failure : failures) std::printf("settings parser: %s\n", failure.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Code decoder fuzzing: random lengths and bytes, random strings over the code alphabet, and valid current,
+// extended and legacy codes with several characters replaced, inserted or deleted. Decoding must never crash;
+// whatever it accepts must be inside the slider ranges, and whatever it rejects must leave the settings alone.
+static bool TestCodeFuzz() {
+    const std::vector<CrosshairSettings>& range = Range();
+    const size_t n = range.size();
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    const char alphabet[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZabcdefghjkmnpqrstvwxyzOILoil -";
+    CrosshairSettings invalid; // Out of range everywhere, so a partial write shows up either way
+    invalid.len = 999; invalid.gap = -1; invalid.thickness = 0; invalid.outlineThickness = 99;
+    invalid.fillColor = 0xFFFFFFFF; invalid.rotation = -5; invalid.circleRadius = 999;
+
+    std::vector<std::string> seeds;
+    for (size_t i = 0; i < 64; i++) {
+        CrosshairSettings extended = range[i * 997 % n];
+        extended.rotation = (int)(i * 13 % 360);
+        extended.tStyle = (i & 1) != 0;
+        extended.circleRadius = (int)(i % 51);
+        char code[kCrosshairCodeBufferSize];
+        seeds.emplace_back(code, EncodeCrosshairCode(extended, code, sizeof(code)));
+        seeds.push_back(NarrowCode(range[i * 997 % n]));
+        std::snprintf(code, sizeof(code), "%02d%02d%02d%02d%d-%06X-%06X", extended.len, extended.gap, extended.thickness,
+            extended.outlineThickness, extended.centerDot ? 1 : 0, extended.fillColor, extended.outlineColor);
+        seeds.emplace_back(code);
+    }
+
+    uint64_t inputs = 0, accepted = 0, failures = 0;
+    auto check = [&](std::string_view text) {
+        CrosshairSettings s = invalid;
+        const CrosshairCodeStatus status = DecodeCrosshairCode(text, s);
+        wchar_t wide[64];
+        for (size_t i = 0; i < text.size(); i++) wide[i] = (wchar_t)(uint8_t)text[i];
+        CrosshairSettings w = invalid;
+        const CrosshairCodeStatus wideStatus = DecodeCrosshairCode(std::wstring_view(wide, text.size()), w);
+        const bool ok = status == CrosshairCodeStatus::Ok ? IsCrosshairSettingsInRange(s) : s == invalid;
+        if (!ok || wideStatus != status || !(w == s)) {
+            if (failures++ < 5) std::printf("code fuzz: '%.*s' decoded with status %d\n", (int)text.size(), text.data(), (int)status);
+        }
+        accepted += status == CrosshairCodeStatus::Ok;
+        inputs++;
+    };
+
+    char text[64];
+    for (int round = 0; round < 300000; round++) {
+        // Any bytes at all, of any length up to a little past the longest code
+        size_t length = next() % 32;
+        for (size_t i = 0; i < length; i++) text[i] = (char)next();
+        check(std::string_view(text, length));
+
+        // Plausible characters, biased towards the real code lengths
+        const size_t lengths[] = { kCrosshairCodeLength, kExtendedCrosshairCodeLength, kLegacyCrosshairCodeLength };
+        length = (next() & 3) ? lengths[next() % 3] : next() % 32;
+        for (size_t i = 0; i < length; i++) text[i] = alphabet[next() % (sizeof(alphabet) - 1)];
+        check(std::string_view(text, length));
+
+        // A valid code with two to six edits
+        const std::string& seed = seeds[next() % seeds.size()];
+        std::memcpy(text, seed.data(), seed.size());
+        length = seed.size();
+        for (int edits = 2 + (int)(next() % 5); edits > 0; edits--) {
+            const size_t at = length ? next() % length : 0;
+            const char c = (next() & 1) ? alphabet[next() % (sizeof(alphabet) - 1)] : (char)next();
+            switch (next() % 4) {
+            case 0: if (length < 40) { std::memmove(text + at + 1, text + at, length - at); text[at] = c; length++; } break;
+            case 1: if (length) { std::memmove(text + at, text + at + 1, length - at - 1); length--; } break;
+            default: if (length) text[at] = c; break;
+            }
+        }
+        check(std::string_view(text, length));
+    }
+    if (failures) return false;
+    std::printf("code fuzz: %llu inputs, %llu accepted\n", (unsigned long long)inputs, (unsigned long long)accepted);
+    return true;
+}
+
+// Extended crosshairs must survive a version 2 code and a profile record, and the shape engine must match a 16x16
+// supersampled reference and give the same image with every kernel
+static bool TestShapes() {
+    const std::vector<CrosshairSettings> shapeRange = ShapeRange();
+    int worstDifference = 0;
+    double worstMeanAlpha = 0;
+    for (const CrosshairSettings& settings : shapeRange) {
+        CrosshairSettings decoded;
+        const std::wstring code = GetCrosshairCode(settings);
+        if (code.size() != kExtendedCrosshairCodeLength || DecodeCrosshairCode(code, decoded) != CrosshairCodeStatus::Ok || !(decoded == settings)) {
+            std::printf("extended code round-trip failed for %ls\n", code.c_str());
+            return false;
+        }
+        if (!ProfileLibrary::ToSettings(ProfileLibrary::MakeRecord("shape", settings), decoded) || !(decoded == settings)) {
+            std::printf("profile record round-trip failed at rotation %d\n", settings.rotation);
+            return false;
+        }
+
+        CrosshairSprite engine, reference;
+        RasterizeCrosshair(settings, engine);
+        RasterizeCrosshairReference(settings, reference, 16);
+        const CrosshairRect bounds = ComputeCrosshairBounds(settings);
+        double meanAlpha = 0;
+        const int difference = SpriteDifference(engine, reference, &meanAlpha);
+        if (engine.width != bounds.right - bounds.left || engine.originY != -bounds.top) {
+            std::printf("shape sprite layout mismatch at rotation %d\n", settings.rotation);
+            return false;
+        }
+        worstDifference = std::max(worstDifference, difference);
+        worstMeanAlpha = std::max(worstMeanAlpha, meanAlpha);
+
+        for (ShapeKernel kernel : { ShapeKernel::Scalar, ShapeKernel::Sse2, ShapeKernel::Avx }) {
+            if (!IsShapeKernelSupported(kernel)) continue;
+            const ShapeKernel active = ActiveShapeKernel();
+            CrosshairSprite other;
+            SetShapeKernel(kernel);
+            RasterizeCrosshair(settings, other);
+            SetShapeKernel(active);
+            if (SpriteDifference(engine, other) > 1) {
+                std::printf("%s kernel disagrees at rotation %d\n", ShapeKernelName(kernel), settings.rotation);
+                return false;
+            }
+        }
+    }
+    std::printf("shape engine vs reference: max channel error %d/255, worst mean alpha error %.4f\n", worstDifference, worstMeanAlpha);
+    if (worstDifference > 32 || worstMeanAlpha > 0.005) {
+        std::printf("shape engine is too far from the reference\n");
+        return false;
+    }
+
+    // Unrotated crosshairs with a ring go through the engine too; their arms must stay pixel-exact
+    CrosshairSettings ringed;
+    ringed.circleRadius = 12;
+    CrosshairSprite withRing;
+    RasterizeCrosshair(ringed, withRing);
+    if (withRing.pixels[(size_t)withRing.originY * withRing.width + withRing.originX + ringed.gap] != ColorRefToPixel(ringed.fillColor)) {
+        std::printf("unrotated arm is not pixel-exact\n");
+        return false;
+    }
+    return true;
+}
+
+struct TestCase {
+    const char* name;
+    bool (*run)();
+};
+
+static const TestCase kTests[] = {
+    { "codes", TestCodes },
+    { "code-fuzz", TestCodeFuzz },
+    { "code-library", TestCodeLibrary },
+    { "shapes", TestShapes },
+    { "golden-images", TestGoldenImages },
+    { "sprite-cache", TestSpriteCache },
+    { "display-layout", TestDisplayLayout },
+    { "repaint-scheduler", TestRepaintScheduler },
+    { "seqlock", TestSeqlock },
+    { "steady-state", TestSteadyState },
+    { "adaptive-contrast", TestAdaptiveContrast },
+    { "animation", TestAnimation },
+    { "gdi-cache", TestGdiCache },
+    { "settings-parser", TestSettingsParser },
+    { "settings-reload", TestSettingsReload },
+    { "control-channel", TestControlChannel },
+    { "hotkeys", TestHotkeys },
+    { "histogram", TestHistogram },
+    { "startup-trace", TestStartupTrace },
+};
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int ran = 0, failed = 0;
+    for (const TestCase& test : kTests) {
+        if (filter && !std::strstr(test.name, filter)) continue;
+        const auto start = std::chrono::steady_clock::now();
+        const bool passed = test.run();
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-4s %-24s %8.1f ms\n", passed ? "ok" : "FAIL", test.name, ms);
+        ran++;
+        failed += !passed;
+    }
+    std::printf("%d of %d tests passed\n", ran - failed, ran);
+    return failed || ran == 0 ? 1 : 0;
+}
@@ -0,0 +1,259 @@
+// AdrixCH - Hot-path latency tracing: per-thread lock-free span rings and log-linear latency histograms.
+
+#include "Trace.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+
+std::atomic<bool> g_traceEnabled{ false };
+
+static const char* const kSpanNames[kTraceSpanCount] = {
+    "draw-crosshair",
+    "settings-load",
+    "slider-to-frame",
+    "hotkey-to-frame",
+    "background-sample",
+    "animation-frame",
+    "settings-show",
+};
+
+static const char* const kStartupPhaseNames[kStartupPhaseCount] = {
+    "paths",
+    "settings",
+    "overlay",
+    "first-frame",
+    "services",
+    "settings-window",
+};
+
+// Each ring has exactly one writer (its thread); readers copy it and then discard what the writer lapped.
+// A record is two words: the start time, and the duration (low 56 bits) with the span in the top byte.
+struct TraceRing {
+    alignas(64) std::atomic<uint64_t> head{ 0 };
+    std::atomic<uint64_t> start[kTraceRingCapacity] = {};
+    std::atomic<uint64_t> packed[kTraceRingCapacity] = {};
+};
+
+constexpr uint64_t kDurationMask = (uint64_t(1) << 56) - 1;
+
+static TraceRing g_rings[kMaxTraceThreads];
+static std::atomic<uint32_t> g_ringCount{ 0 };
+static LatencyHistogram g_histograms[kTraceSpanCount];
+static std::atomic<uint64_t> g_startupBegin{ 0 };
+static std::atomic<uint64_t> g_startupMarks[kStartupPhaseCount] = {};
+
+// Claimed on the thread's first traced span; null once the pool is exhausted
+static thread_local TraceRing* t_ring = nullptr;
+static thread_local bool t_ringClaimed = false;
+
+const char* TraceSpanName(TraceSpan span) {
+    const size_t index = static_cast<size_t>(span);
+    return index < kTraceSpanCount ? kSpanNames[index] : "unknown";
+}
+
+const char* StartupPhaseName(StartupPhase phase) {
+    const size_t index = static_cast<size_t>(phase);
+    return index < kStartupPhaseCount ? kStartupPhaseNames[index] : "unknown";
+}
+
+void SetTraceEnabled(bool enabled) {
+    g_traceEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t TraceNow() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceEnd(TraceSpan span, uint64_t startNs) {
+    if (startNs == 0 || !TraceEnabled() || span >= TraceSpan::Count) return;
+    const uint64_t now = TraceNow();
+    const uint64_t duration = now > startNs ? now - startNs : 0;
+    g_histograms[static_cast<size_t>(span)].Record(duration);
+
+    if (!t_ringClaimed) {
+        t_ringClaimed = true;
+        const uint32_t index = g_ringCount.fetch_add(1, std::memory_order_relaxed);
+        if (index < kMaxTraceThreads) t_ring = &g_rings[index];
+    }
+    TraceRing* ring = t_ring;
+    if (!ring) return;
+
+    const uint64_t head = ring->head.load(std::memory_order_relaxed);
+    const size_t slot = head & (kTraceRingCapacity - 1);
+    ring->start[slot].store(startNs, std::memory_order_relaxed);
+    ring->packed[slot].store((std::min(duration, kDurationMask)) | (uint64_t(span) << 56), std::memory_order_relaxed);
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+size_t LatencyHistogram::BucketIndex(uint64_t ns) {
+    if (ns < kSubBucketCount) return (size_t)ns;
+    const int magnitude = (int)std::bit_width(ns) - 1; // >= kSubBucketBits
+    if (magnitude >= kMaxValueBits) return kBucketCount - 1;
+    const size_t sub = (size_t)(ns >> (magnitude - kSubBucketBits)) & (kSubBucketCount - 1);
+    return (size_t)(magnitude - kSubBucketBits + 1) * kSubBucketCount + sub;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+    if (index < kSubBucketCount) return index;
+    const int shift = (int)(index / kSubBucketCount) - 1;
+    const uint64_t lower = (uint64_t)(kSubBucketCount + index % kSubBucketCount) << shift;
+    return lower + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t ns) {
+    buckets_[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t seen = min_.load(std::memory_order_relaxed);
+    while (ns < seen && !min_.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {}
+    seen = max_.load(std::memory_order_relaxed);
+    while (ns > seen && !max_.compare_exchange_weak(seen, ns, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::Reset() {
+    for (auto& bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(UINT64_MAX, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::Min() const {
+    const uint64_t min = min_.load(std::memory_order_relaxed);
+    return min == UINT64_MAX ? 0 : min;
+}
+
+uint64_t LatencyHistogram::Mean() const {
+    const uint64_t count = Count();
+    return count ? sum_.load(std::memory_order_relaxed) / count : 0;
+}
+
+uint64_t LatencyHistogram::Percentile(double percentile) const {
+    const uint64_t count = Count();
+    if (count == 0) return 0;
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    const uint64_t rank = std::max<uint64_t>(1, (uint64_t)(percentile / 100.0 * (double)count + 0.5));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; i++) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(BucketUpperBound(i), Max());
+    }
+    return Max();
+}
+
+const LatencyHistogram& TraceHistogram(TraceSpan span) {
+    const size_t index = static_cast<size_t>(span);
+    return g_histograms[index < kTraceSpanCount ? index : 0];
+}
+
+void TraceSnapshot(std::vector<TraceRecord>& records) {
+    records.clear();
+    const uint32_t rings = std::min<uint32_t>(g_ringCount.load(std::memory_order_relaxed), kMaxTraceThreads);
+    for (uint32_t r = 0; r < rings; r++) {
+        TraceRing& ring = g_rings[r];
+        const size_t first = records.size();
+        const uint64_t head = ring.head.load(std::memory_order_acquire);
+        const uint64_t from = head > kTraceRingCapacity ? head - kTraceRingCapacity : 0;
+        for (uint64_t i = from; i < head; i++) {
+            const size_t slot = i & (kTraceRingCapacity - 1);
+            const uint64_t packed = ring.packed[slot].load(std::memory_order_relaxed);
+            records.push_back({ ring.start[slot].load(std::memory_order_relaxed), packed & kDurationMask, (TraceSpan)(packed >> 56), r });
+        }
+
+        // The writer may have lapped the copy: anything at or below the slot it is writing now is suspect
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t after = ring.head.load(std::memory_order_relaxed);
+        const uint64_t valid = after >= kTraceRingCapacity ? after - kTraceRingCapacity + 1 : 0;
+        if (valid > from) records.erase(records.begin() + first, records.begin() + first + (size_t)std::min(valid - from, head - from));
+    }
+    std::stable_sort(records.begin(), records.end(), [](const TraceRecord& a, const TraceRecord& b) { return a.startNs < b.startNs; });
+}
+
+void TraceStartupBegin(uint64_t startNs) {
+    for (auto& mark : g_startupMarks) mark.store(0, std::memory_order_relaxed);
+    g_startupBegin.store(startNs, std::memory_order_relaxed);
+}
+
+void TraceStartupMark(StartupPhase phase) {
+    if (phase >= StartupPhase::Count) return;
+    uint64_t unmarked = 0;
+    g_startupMarks[static_cast<size_t>(phase)].compare_exchange_strong(unmarked, TraceNow(), std::memory_order_relaxed);
+}
+
+uint64_t TraceStartupNs(StartupPhase phase) {
+    if (phase >= StartupPhase::Count) return 0;
+    const uint64_t mark = g_startupMarks[static_cast<size_t>(phase)].load(std::memory_order_relaxed);
+    const uint64_t begin = g_startupBegin.load(std::memory_order_relaxed);
+    return mark == 0 ? 0 : mark > begin ? mark - begin : 1;
+}
+
+void TraceReset() {
+    for (auto& histogram : g_histograms) histogram.Reset();
+    for (auto& ring : g_rings) ring.head.store(0, std::memory_order_release);
+}
+
+bool TraceDump(const std::filesystem::path& path, std::string_view appendix) {
+    std::string text;
+    char line[256];
+    text += "# AdrixCH trace, latencies in nanoseconds\n";
+    text += "span,count,min,mean,p50,p90,p99,p99.9,max\n";
+    for (size_t i = 0; i < kTraceSpanCount; i++) {
+        const LatencyHistogram& h = g_histograms[i];
+        std::snprintf(line, sizeof(line), "%s,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+            kSpanNames[i], h.Count(), h.Min(), h.Mean(), h.Percentile(50), h.Percentile(90), h.Percentile(99), h.Percentile(99.9), h.Max());
+        text += line;
+    }
+
+    // Each phase's duration runs from the previous marked phase
+    text += "\n# startup, nanoseconds since process start\nphase,end,duration\n";
+    uint64_t previous = 0;
+    for (size_t i = 0; i < kStartupPhaseCount; i++) {
+        const uint64_t end = TraceStartupNs((StartupPhase)i);
+        if (end == 0) continue;
+        std::snprintf(line, sizeof(line), "%s,%" PRIu64 ",%" PRIu64 "\n", kStartupPhaseNames[i], end, end > previous ? end - previous : 0);
+        text += line;
+        previous = end;
+    }
+    const uint64_t firstFrame = TraceStartupNs(StartupPhase::FirstFrame);
+    const LatencyHistogram& settingsShow = g_histograms[static_cast<size_t>(TraceSpan::SettingsShow)];
+    struct { const char* name; bool measured; uint64_t value; uint64_t budget; } const budgets[] = {
+        { "first-frame", firstFrame != 0, firstFrame, kFirstFrameBudgetNs },
+        { "settings-show-p99", settingsShow.Count() != 0, settingsShow.Percentile(99), kSettingsShowBudgetNs },
+    };
+    text += "\n# budgets, nanoseconds\ntarget,measured,budget,within\n";
+    for (const auto& budget : budgets) {
+        if (!budget.measured) {
+            std::snprintf(line, sizeof(line), "%s,,%" PRIu64 ",unmeasured\n", budget.name, budget.budget);
+        }
+        else {
+            std::snprintf(line, sizeof(line), "%s,%" PRIu64 ",%" PRIu64 ",%s\n", budget.name, budget.value, budget.budget,
+                budget.value <= budget.budget ? "yes" : "no");
+        }
+        text += line;
+    }
+
+    std::vector<TraceRecord> records;
+    TraceSnapshot(records);
+    text += "\n# recent spans\nthread,span,start,duration\n";
+    for (const TraceRecord& record : records) {
+        std::snprintf(line, sizeof(line), "%u,%s,%" PRIu64 ",%" PRIu64 "\n", record.thread, TraceSpanName(record.span), record.startNs, record.durationNs);
+        text += line;
+    }
+    text += appendix;
+
+    FILE* file = nullptr;
+#ifdef _WIN32
+    if (_wfopen_s(&file, path.c_str(), L"wb") != 0) file = nullptr;
+#else
+    file = std::fopen(path.c_str(), "wb");
+#endif
+    if (!file) return false;
+    const bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    return std::fclose(file) == 0 && written;
+}
@@ -0,0 +1,135 @@
+// AdrixCH - Hot-path latency tracing: per-thread lock-free span rings and log-linear latency histograms.
+//
+// Tracing is off by default. While it is off, a span costs one relaxed atomic load and no clock read.
+// While it is on, finishing a span appends a record to the calling thread's ring (single writer, no
+// locks) and adds its duration to the span's histogram (relaxed atomic increments).
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+enum class TraceSpan : uint8_t {
+    DrawCrosshair,  // One sprite blit in WndProc
+    SettingsLoad,   // Reading and parsing the INI file at startup
+    SliderToFrame,  // First unpainted slider move in SettingsProc until the overlay frame is painted
+    HotkeyToFrame,  // Key press seen by the hook until the resulting frame is painted
+    BackgroundSample, // Adaptive contrast: capturing and analyzing the screen behind the crosshair
+    AnimationFrame, // Animation step due until its frame is blitted
+    SettingsShow,   // Settings hotkey press until the settings window is visible and painted
+    Count
+};
+
+constexpr size_t kTraceSpanCount = static_cast<size_t>(TraceSpan::Count);
+constexpr size_t kTraceRingCapacity = 1024; // Records kept per thread; must be a power of two
+constexpr size_t kMaxTraceThreads = 8;      // Further threads still feed the histograms, but get no ring
+
+static_assert((kTraceRingCapacity & (kTraceRingCapacity - 1)) == 0, "kTraceRingCapacity must be a power of two");
+
+const char* TraceSpanName(TraceSpan span);
+
+extern std::atomic<bool> g_traceEnabled;
+
+inline bool TraceEnabled() { return g_traceEnabled.load(std::memory_order_relaxed); }
+void SetTraceEnabled(bool enabled);
+
+// Monotonic nanoseconds (steady_clock, which is QueryPerformanceCounter on Windows)
+uint64_t TraceNow();
+
+// Start of a span, or 0 while tracing is off
+inline uint64_t TraceBegin() { return TraceEnabled() ? TraceNow() : 0; }
+
+// Finish a span started at startNs; does nothing for startNs == 0 or while tracing is off
+void TraceEnd(TraceSpan span, uint64_t startNs);
+
+// Times the enclosing scope
+class ScopedTrace {
+public:
+    explicit ScopedTrace(TraceSpan span) : span_(span), start_(TraceBegin()) {}
+    ~ScopedTrace() { if (start_) TraceEnd(span_, start_); }
+    ScopedTrace(const ScopedTrace&) = delete;
+    ScopedTrace& operator=(const ScopedTrace&) = delete;
+
+private:
+    TraceSpan span_;
+    uint64_t start_;
+};
+
+// HDR-style histogram: exact below 32 ns, then 32 linear sub-buckets per power of two (at most ~3% error),
+// up to 2^40 ns (about 18 minutes). Safe to record from any number of threads.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kMaxValueBits = 40;
+    static constexpr size_t kSubBucketCount = size_t(1) << kSubBucketBits;
+    static constexpr size_t kBucketCount = (kMaxValueBits - kSubBucketBits + 1) * kSubBucketCount;
+
+    void Record(uint64_t ns);
+    void Reset();
+
+    uint64_t Count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t Min() const;
+    uint64_t Max() const { return max_.load(std::memory_order_relaxed); }
+    uint64_t Mean() const;
+    // Upper bound of the bucket holding the given percentile (0-100), capped at Max()
+    uint64_t Percentile(double percentile) const;
+
+    static size_t BucketIndex(uint64_t ns);
+    static uint64_t BucketUpperBound(size_t index);
+
+private:
+    std::atomic<uint64_t> buckets_[kBucketCount] = {};
+    std::atomic<uint64_t> count_{ 0 };
+    std::atomic<uint64_t> sum_{ 0 };
+    std::atomic<uint64_t> min_{ UINT64_MAX };
+    std::atomic<uint64_t> max_{ 0 };
+};
+
+struct TraceRecord {
+    uint64_t startNs;
+    uint64_t durationNs;
+    TraceSpan span;
+    uint32_t thread; // Ring index, in order of each thread's first span
+};
+
+const LatencyHistogram& TraceHistogram(TraceSpan span);
+
+// Copy the records still held in every thread's ring, oldest first. Safe while other threads are tracing;
+// records overwritten during the copy are left out.
+void TraceSnapshot(std::vector<TraceRecord>& records);
+
+// Clear all histograms and rings; only call while no other thread is tracing
+void TraceReset();
+
+// Cold start, as a sequence of phases each marked once when it completes. Marks are taken whether or not
+// tracing is on, since the INI that turns it on is only read during startup.
+enum class StartupPhase : uint8_t {
+    Paths,          // AppData folder resolved and created
+    Settings,       // INI read and parsed
+    Overlay,        // Overlay class registered and the first window created
+    FirstFrame,     // First crosshair placed and presented: the end of the critical path
+    Services,       // Hotkeys, file watcher, control channel, adaptive sampling and profile library started
+    SettingsWindow, // Settings window built hidden, so the hotkey only has to show it
+    Count
+};
+
+constexpr size_t kStartupPhaseCount = static_cast<size_t>(StartupPhase::Count);
+constexpr uint64_t kFirstFrameBudgetNs = 100000000;  // Process start to the first crosshair on screen
+constexpr uint64_t kSettingsShowBudgetNs = 16000000; // Settings hotkey to visible window (p99), about one 60 Hz frame
+
+const char* StartupPhaseName(StartupPhase phase);
+
+// Start the startup clock at startNs (on the TraceNow clock, e.g. when the process was created) and clear every mark
+void TraceStartupBegin(uint64_t startNs);
+// Mark a phase complete now; later marks of the same phase are ignored
+void TraceStartupMark(StartupPhase phase);
+// Nanoseconds from the start of the startup clock to the phase's mark, or 0 if it has not been marked
+uint64_t TraceStartupNs(StartupPhase phase);
+
+// Write a histogram summary per span, the startup phases checked against their budgets and the recent records
+// as text; appendix (counters kept outside the trace) goes at the end verbatim
+bool TraceDump(const std::filesystem::path& path, std::string_view appendix = {});
@@ -0,0 +1,32 @@
+// AdrixCH - Windows display topology source.
+
+#include "Win32DisplaySource.h"
+
+#include <shellscalingapi.h>
+
+#pragma comment(lib, "Shcore.lib")
+
+void Win32DisplaySource::Enumerate(std::vector<MonitorInfo>& monitors) {
+    EnumDisplayMonitors(NULL, NULL, MonitorProc, reinterpret_cast<LPARAM>(&monitors));
+}
+
+BOOL CALLBACK Win32DisplaySource::MonitorProc(HMONITOR monitor, HDC, LPRECT, LPARAM param) {
+    auto& monitors = *reinterpret_cast<std::vector<MonitorInfo>*>(param);
+
+    MONITORINFOEX mi = {};
+    mi.cbSize = sizeof(mi);
+    if (!GetMonitorInfo(monitor, &mi)) return TRUE;
+
+    MonitorInfo& info = monitors.emplace_back();
+    info.bounds = { mi.rcMonitor.left, mi.rcMonitor.top, mi.rcMonitor.right, mi.rcMonitor.bottom };
+    info.primary = (mi.dwFlags & MONITORINFOF_PRIMARY) != 0;
+
+    UINT dpiX = kDefaultDpi, dpiY = kDefaultDpi;
+    if (SUCCEEDED(GetDpiForMonitor(monitor, MDT_EFFECTIVE_DPI, &dpiX, &dpiY))) info.dpi = (int)dpiX;
+
+    // 0 and 1 mean "hardware default"; keep the 60 Hz assumption for those
+    DEVMODE mode = {};
+    mode.dmSize = sizeof(mode);
+    if (EnumDisplaySettings(mi.szDevice, ENUM_CURRENT_SETTINGS, &mode) && mode.dmDisplayFrequency > 1) info.refreshHz = (int)mode.dmDisplayFrequency;
+    return TRUE;
+}
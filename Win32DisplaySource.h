@@ -0,0 +1,17 @@
+// AdrixCH - Windows display topology source.
+
+#pragma once
+
+#include <windows.h>
+
+#include "DisplayLayout.h"
+
+// Enumerates the attached monitors with their effective per-monitor DPI. The process must be per-monitor
+// DPI aware for the rectangles to be physical pixels; otherwise Windows reports virtualized values.
+class Win32DisplaySource final : public DisplayTopologySource {
+public:
+    void Enumerate(std::vector<MonitorInfo>& monitors) override;
+
+private:
+    static BOOL CALLBACK MonitorProc(HMONITOR monitor, HDC hdc, LPRECT rect, LPARAM param);
+};
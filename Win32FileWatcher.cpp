@@ -0,0 +1,69 @@
+// AdrixCH - Windows file watcher backed by ReadDirectoryChangesW.
+
+#include "Win32FileWatcher.h"
+
+bool Win32FileWatcher::Start(const std::filesystem::path& path, ChangeCallback callback, void* context) {
+    if (thread_.joinable() || !callback) return false;
+
+    std::filesystem::path directory = path.parent_path();
+    if (directory.empty()) directory = L".";
+    directory_ = CreateFileW(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+    stop_ = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (directory_ == INVALID_HANDLE_VALUE || !stop_) {
+        Stop();
+        return false;
+    }
+
+    name_ = path.filename().wstring();
+    callback_ = callback;
+    context_ = context;
+    thread_ = std::thread(&Win32FileWatcher::Run, this);
+    return true;
+}
+
+void Win32FileWatcher::Stop() {
+    if (thread_.joinable()) {
+        SetEvent(stop_);
+        thread_.join();
+    }
+    if (directory_ != INVALID_HANDLE_VALUE) CloseHandle(directory_);
+    if (stop_) CloseHandle(stop_);
+    directory_ = INVALID_HANDLE_VALUE;
+    stop_ = NULL;
+}
+
+void Win32FileWatcher::Run() {
+    OVERLAPPED overlapped = {};
+    overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (!overlapped.hEvent) return;
+
+    alignas(DWORD) BYTE buffer[16384];
+    const DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+    while (ReadDirectoryChangesW(directory_, buffer, sizeof(buffer), FALSE, filter, NULL, &overlapped, NULL)) {
+        HANDLE handles[] = { stop_, overlapped.hEvent };
+        DWORD bytes = 0;
+        if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1) {
+            CancelIo(directory_);
+            GetOverlappedResult(directory_, &overlapped, &bytes, TRUE);
+            break;
+        }
+        if (!GetOverlappedResult(directory_, &overlapped, &bytes, FALSE)) break;
+        ResetEvent(overlapped.hEvent);
+
+        // No bytes means the buffer overflowed and the changes were dropped; ours may have been among them
+        bool changed = bytes == 0;
+        for (DWORD offset = 0; bytes != 0;) {
+            const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+            const int length = (int)(info->FileNameLength / sizeof(wchar_t));
+            if (info->Action != FILE_ACTION_REMOVED && info->Action != FILE_ACTION_RENAMED_OLD_NAME &&
+                CompareStringOrdinal(info->FileName, length, name_.c_str(), (int)name_.size(), TRUE) == CSTR_EQUAL) {
+                changed = true;
+            }
+            if (!info->NextEntryOffset) break;
+            offset += info->NextEntryOffset;
+        }
+        if (changed) callback_(context_);
+    }
+    CloseHandle(overlapped.hEvent);
+}
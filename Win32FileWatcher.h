@@ -0,0 +1,32 @@
+// AdrixCH - Windows file watcher backed by ReadDirectoryChangesW.
+
+#pragma once
+
+#include <windows.h>
+#include <string>
+#include <thread>
+
+#include "FileWatcher.h"
+
+// Keeps one overlapped ReadDirectoryChangesW outstanding on the file's directory; the thread waits on it
+// and on a stop event, so it costs nothing while the file is left alone.
+class Win32FileWatcher final : public FileWatcher {
+public:
+    Win32FileWatcher() = default;
+    ~Win32FileWatcher() override { Stop(); }
+    Win32FileWatcher(const Win32FileWatcher&) = delete;
+    Win32FileWatcher& operator=(const Win32FileWatcher&) = delete;
+
+    bool Start(const std::filesystem::path& path, ChangeCallback callback, void* context) override;
+    void Stop() override;
+
+private:
+    void Run();
+
+    HANDLE directory_ = INVALID_HANDLE_VALUE;
+    HANDLE stop_ = NULL;
+    std::wstring name_;
+    ChangeCallback callback_ = nullptr;
+    void* context_ = nullptr;
+    std::thread thread_;
+};
@@ -0,0 +1,24 @@
+// AdrixCH - Windows GDI object allocator for the shared resource cache.
+
+#include "Win32GdiAllocator.h"
+
+GdiHandle Win32GdiAllocator::Create(const GdiResourceKey& key) {
+    switch (key.kind) {
+    case GdiResourceKind::Brush:
+        return (GdiHandle)CreateSolidBrush((COLORREF)key.color);
+    case GdiResourceKind::Pen:
+        return (GdiHandle)CreatePen(PS_SOLID, key.width, (COLORREF)key.color);
+    case GdiResourceKind::Font: {
+        wchar_t face[LF_FACESIZE] = {};
+        MultiByteToWideChar(CP_UTF8, 0, key.face, -1, face, LF_FACESIZE - 1);
+        return (GdiHandle)CreateFont(key.width, 0, 0, 0, key.weight, FALSE, FALSE, FALSE,
+            ANSI_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
+            CLEARTYPE_QUALITY, VARIABLE_PITCH, face);
+    }
+    }
+    return 0;
+}
+
+void Win32GdiAllocator::Destroy(GdiHandle handle) {
+    if (handle) DeleteObject((HGDIOBJ)handle);
+}
@@ -0,0 +1,18 @@
+// AdrixCH - Windows GDI object allocator for the shared resource cache.
+
+#pragma once
+
+#include <windows.h>
+
+#include "GdiResourceCache.h"
+
+// Creates solid brushes, solid pens and ClearType fonts; the handles are HGDIOBJs
+class Win32GdiAllocator final : public GdiAllocator {
+public:
+    GdiHandle Create(const GdiResourceKey& key) override;
+    void Destroy(GdiHandle handle) override;
+};
+
+inline HBRUSH ToBrush(GdiHandle handle) { return (HBRUSH)handle; }
+inline HPEN ToPen(GdiHandle handle) { return (HPEN)handle; }
+inline HFONT ToFont(GdiHandle handle) { return (HFONT)handle; }
@@ -0,0 +1,77 @@
+// AdrixCH - Windows input source backed by a low-level keyboard hook.
+
+#include "Win32InputSource.h"
+
+#include "Trace.h"
+
+// The hook callback has no context parameter, so the running instance's sink and bound keys are kept here
+static Win32InputSource* g_activeSource = nullptr;
+static InputSink* g_activeSink = nullptr;
+static uint16_t g_boundKeys[HotkeyDispatcher::kMaxBindings];
+static size_t g_boundKeyCount = 0;
+
+bool Win32InputSource::Start(InputSink& sink, const HotkeyBinding* bindings, size_t count) {
+    if (thread_.joinable() || g_activeSource) return false;
+    g_boundKeyCount = 0;
+    for (size_t i = 0; i < count && g_boundKeyCount < HotkeyDispatcher::kMaxBindings; i++) g_boundKeys[g_boundKeyCount++] = bindings[i].key;
+    g_activeSource = this;
+    g_activeSink = &sink;
+
+    // Wait until the hook is installed so Start can report failure
+    HANDLE ready = CreateEvent(NULL, TRUE, FALSE, NULL);
+    thread_ = std::thread(&Win32InputSource::Run, this, ready);
+    WaitForSingleObject(ready, INFINITE);
+    CloseHandle(ready);
+
+    if (!hooked_) { Stop(); return false; }
+    return true;
+}
+
+void Win32InputSource::Stop() {
+    if (thread_.joinable()) {
+        PostThreadMessage(threadId_, WM_QUIT, 0, 0);
+        thread_.join();
+    }
+    if (g_activeSource == this) { g_activeSource = nullptr; g_activeSink = nullptr; }
+}
+
+void Win32InputSource::Run(HANDLE ready) {
+    threadId_ = GetCurrentThreadId();
+
+    // Make sure the thread has a message queue before anyone posts WM_QUIT to it
+    MSG msg;
+    PeekMessage(&msg, NULL, WM_USER, WM_USER, PM_NOREMOVE);
+
+    HHOOK hook = SetWindowsHookEx(WH_KEYBOARD_LL, KeyboardProc, GetModuleHandle(NULL), 0);
+    hooked_ = hook != NULL;
+    SetEvent(ready);
+    if (!hook) return;
+
+    // Low-level hooks are called through this thread's message loop; it is idle between key presses
+    while (GetMessage(&msg, NULL, 0, 0) > 0) { TranslateMessage(&msg); DispatchMessage(&msg); }
+    UnhookWindowsHookEx(hook);
+}
+
+LRESULT CALLBACK Win32InputSource::KeyboardProc(int code, WPARAM wParam, LPARAM lParam) {
+    if (code == HC_ACTION && g_activeSink) {
+        const KBDLLHOOKSTRUCT* kbd = reinterpret_cast<const KBDLLHOOKSTRUCT*>(lParam);
+
+        // Every key on the system passes through here; only bound keys read the modifier state
+        bool bound = false;
+        for (size_t i = 0; i < g_boundKeyCount && !bound; i++) bound = g_boundKeys[i] == kbd->vkCode;
+        if (bound) {
+            uint8_t modifiers = 0;
+            if (GetAsyncKeyState(VK_CONTROL) & 0x8000) modifiers |= kModCtrl;
+            if (GetAsyncKeyState(VK_SHIFT) & 0x8000) modifiers |= kModShift;
+            if (GetAsyncKeyState(VK_MENU) & 0x8000) modifiers |= kModAlt;
+
+            KeyEvent event;
+            event.key = static_cast<uint16_t>(kbd->vkCode);
+            event.modifiers = modifiers;
+            event.down = (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN);
+            event.timeUs = TraceNow() / 1000; // Same clock as the trace spans, so key-to-frame latency can be measured
+            g_activeSink->OnKeyEvent(event);
+        }
+    }
+    return CallNextHookEx(NULL, code, wParam, lParam); // Never swallowed
+}
@@ -0,0 +1,29 @@
+// AdrixCH - Windows input source backed by a low-level keyboard hook.
+
+#pragma once
+
+#include <windows.h>
+#include <thread>
+
+#include "HotkeyDispatcher.h"
+
+// Installs a WH_KEYBOARD_LL hook on a dedicated thread. The thread sleeps in GetMessage and is only woken
+// by real key transitions; those on a bound key are forwarded to the sink, everything else is passed on
+// untouched after one comparison. Keys are never swallowed: the hook always calls the next one, so the
+// foreground program still sees every press (RegisterHotKey would consume the combination system-wide,
+// taking F12 away from browsers and games).
+class Win32InputSource final : public InputSource {
+public:
+    ~Win32InputSource() override { Stop(); }
+
+    bool Start(InputSink& sink, const HotkeyBinding* bindings, size_t count) override;
+    void Stop() override;
+
+private:
+    static LRESULT CALLBACK KeyboardProc(int code, WPARAM wParam, LPARAM lParam);
+    void Run(HANDLE ready);
+
+    std::thread thread_;
+    DWORD threadId_ = 0;
+    bool hooked_ = false;
+};
@@ -0,0 +1,51 @@
+// AdrixCH - Windows screen capture for the adaptive-contrast background samples.
+
+#include "Win32ScreenSource.h"
+
+Win32ScreenSource::~Win32ScreenSource() {
+    Release();
+}
+
+void Win32ScreenSource::Release() {
+    if (memoryDc_) {
+        if (previousBitmap_) SelectObject(memoryDc_, previousBitmap_);
+        DeleteDC(memoryDc_);
+    }
+    if (bitmap_) DeleteObject(bitmap_);
+    memoryDc_ = NULL;
+    bitmap_ = NULL;
+    previousBitmap_ = NULL;
+    bits_ = nullptr;
+    size_ = 0;
+}
+
+const uint32_t* Win32ScreenSource::Capture(int centerX, int centerY, int size) {
+    if (size <= 0) return nullptr;
+    HDC screen = GetDC(NULL);
+    if (!screen) return nullptr;
+
+    // The DIB section is only recreated when the sample size changes
+    if (size != size_) {
+        Release();
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+        bmi.bmiHeader.biWidth = size;
+        bmi.bmiHeader.biHeight = -size; // Top-down
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+        void* bits = nullptr;
+        memoryDc_ = CreateCompatibleDC(screen);
+        bitmap_ = memoryDc_ ? CreateDIBSection(screen, &bmi, DIB_RGB_COLORS, &bits, NULL, 0) : NULL;
+        if (!bitmap_) { Release(); ReleaseDC(NULL, screen); return nullptr; }
+        previousBitmap_ = SelectObject(memoryDc_, bitmap_);
+        bits_ = static_cast<uint32_t*>(bits);
+        size_ = size;
+    }
+
+    const BOOL copied = BitBlt(memoryDc_, 0, 0, size, size, screen, centerX - size / 2, centerY - size / 2, SRCCOPY);
+    ReleaseDC(NULL, screen);
+    if (!copied) return nullptr;
+    GdiFlush(); // The DIB bits are only up to date once GDI has finished the blit
+    return bits_;
+}
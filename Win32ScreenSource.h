@@ -0,0 +1,28 @@
+// AdrixCH - Windows screen capture for the adaptive-contrast background samples.
+
+#pragma once
+
+#include <windows.h>
+
+#include "AdaptiveContrast.h"
+
+// Copies a square of the desktop into a DIB section that is kept between captures. A plain SRCCOPY
+// BitBlt leaves out layered windows, so the overlay's own crosshair never shows up in the sample.
+class Win32ScreenSource final : public BackgroundSource {
+public:
+    Win32ScreenSource() = default;
+    ~Win32ScreenSource() override;
+    Win32ScreenSource(const Win32ScreenSource&) = delete;
+    Win32ScreenSource& operator=(const Win32ScreenSource&) = delete;
+
+    const uint32_t* Capture(int centerX, int centerY, int size) override;
+
+private:
+    void Release();
+
+    HDC memoryDc_ = NULL;
+    HBITMAP bitmap_ = NULL;
+    HGDIOBJ previousBitmap_ = NULL;
+    uint32_t* bits_ = nullptr;
+    int size_ = 0;
+};